@@ -0,0 +1,76 @@
+// vector4<float>/vector4<double>のスループットを計測します。
+// 汎用テンプレートと比較する場合は、ARCH_NO_SIMDを定義してビルドした結果と並べてください。
+
+#include <vector>
+#include <arch/vector.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 4096;
+	const size_t iterations = 2000;
+	std::vector<vector4<type>> a(count), b(count), result(count);
+	std::vector<type> scalars(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		a[i] = vector4<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+		b[i] = vector4<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+	}
+
+	std::string prefix = std::string(_type_name) + ".";
+
+	bench::run(prefix + "add", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i] + b[i];
+		}
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "multiply_scalar", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i] * static_cast<type>(0.5);
+		}
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "dot", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			scalars[i] = a[i].dot(b[i]);
+		}
+		bench::do_not_optimize(scalars);
+	});
+
+	bench::run(prefix + "length", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			scalars[i] = a[i].length();
+		}
+		bench::do_not_optimize(scalars);
+	});
+
+	bench::run(prefix + "normalized", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i].normalized();
+		}
+		bench::do_not_optimize(result);
+	});
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float4");
+	run<double>("double4");
+	return 0;
+}
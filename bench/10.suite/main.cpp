@@ -0,0 +1,290 @@
+// 各ヘッダーの主な演算をfloatとdoubleで計測し、ns/opとGB/sを表示します。
+// 引数にJSONファイルのパスを渡すと、結果をリリース間の比較用に書き出します。
+//   suite [--json <path>]
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <arch/functions.h>
+#include <arch/hsv.h>
+#include <arch/matrix3x3.h>
+#include <arch/matrix4x4.h>
+#include <arch/philox.h>
+#include <arch/polar.h>
+#include <arch/quaternion.h>
+#include <arch/random_fill.h>
+#include <arch/soa_vector.h>
+#include <arch/trigonometric.h>
+#include <arch/vector.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+const size_t count = 4096;
+const size_t iterations = 500;
+
+/*!
+*	@brief _inputの各要素に_functionを適用して_outputに格納する処理を計測します。
+*/
+template<class input_type, class output_type, class function_type> void measure(const std::string& _name, const std::vector<input_type>& _input, std::vector<output_type>& _output, function_type _function)
+{
+	bench::run(_name, iterations, _input.size(), sizeof(input_type) + sizeof(output_type), [&]()
+	{
+		for (size_t i = 0; i < _input.size(); i++)
+		{
+			_output[i] = _function(_input[i]);
+		}
+		bench::do_not_optimize(_output);
+	});
+}
+
+template<class type> void run_functions(const std::string& _prefix)
+{
+	std::vector<type> x(count), y(count);
+	random_fill(x.data(), count, static_cast<type>(0.5), static_cast<type>(2.0));
+
+	measure(_prefix + "functions/sqrt", x, y, [](type _x) { return arch::sqrt(_x); });
+	measure(_prefix + "functions/pow(x,int)", x, y, [](type _x) { return arch::pow(_x, 7); });
+	measure(_prefix + "functions/ipow<7>", x, y, [](type _x) { return ipow<7>(_x); });
+	measure(_prefix + "functions/pow(x,y)", x, y, [](type _x) { return arch::pow(_x, static_cast<type>(2.5)); });
+
+	std::vector<type> s(count), c(count);
+	bench::run(_prefix + "trigonometric/sincos[]", iterations, count, sizeof(type) * 3, [&]()
+	{
+		sincos(x.data(), s.data(), c.data(), count);
+		bench::do_not_optimize(s);
+		bench::do_not_optimize(c);
+	});
+}
+
+template<class type> void run_vector(const std::string& _prefix)
+{
+	std::vector<vector3<type>> a3(count), b3(count), r3(count);
+	std::vector<vector4<type>> a4(count), b4(count), r4(count);
+	std::vector<type> scalars(count);
+	random_fill(a3.data(), count, static_cast<type>(-1.0), static_cast<type>(1.0));
+	random_fill(b3.data(), count, static_cast<type>(-1.0), static_cast<type>(1.0));
+	random_fill(a4.data(), count, static_cast<type>(-1.0), static_cast<type>(1.0));
+	random_fill(b4.data(), count, static_cast<type>(-1.0), static_cast<type>(1.0));
+
+	bench::run(_prefix + "vector3/add", iterations, count, sizeof(vector3<type>) * 3, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			r3[i] = a3[i] + b3[i];
+		}
+		bench::do_not_optimize(r3);
+	});
+	bench::run(_prefix + "vector3/cross", iterations, count, sizeof(vector3<type>) * 3, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			r3[i] = a3[i].cross(b3[i]);
+		}
+		bench::do_not_optimize(r3);
+	});
+	bench::run(_prefix + "vector3/dot", iterations, count, sizeof(vector3<type>) * 2 + sizeof(type), [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			scalars[i] = a3[i].dot(b3[i]);
+		}
+		bench::do_not_optimize(scalars);
+	});
+	measure(_prefix + "vector3/normalized", a3, r3, [](const vector3<type>& _v) { return _v.normalized(); });
+
+	bench::run(_prefix + "vector4/add", iterations, count, sizeof(vector4<type>) * 3, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			r4[i] = a4[i] + b4[i];
+		}
+		bench::do_not_optimize(r4);
+	});
+	bench::run(_prefix + "vector4/dot", iterations, count, sizeof(vector4<type>) * 2 + sizeof(type), [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			scalars[i] = a4[i].dot(b4[i]);
+		}
+		bench::do_not_optimize(scalars);
+	});
+	measure(_prefix + "vector4/normalized", a4, r4, [](const vector4<type>& _v) { return _v.normalized(); });
+
+	soa_vector3<type> soa_a(a3), soa_b(b3), soa_r(a3);
+	bench::run(_prefix + "soa_vector3/add", iterations, count, sizeof(vector3<type>) * 2, [&]()
+	{
+		soa_r += soa_b;
+		bench::do_not_optimize(soa_r);
+	});
+	bench::run(_prefix + "soa_vector3/dot", iterations, count, sizeof(vector3<type>) * 2 + sizeof(type), [&]()
+	{
+		soa_a.dot(soa_b, scalars.data());
+		bench::do_not_optimize(scalars);
+	});
+	bench::run(_prefix + "soa_vector3/normalize", iterations, count, sizeof(vector3<type>) * 2, [&]()
+	{
+		soa_r.normalize();
+		bench::do_not_optimize(soa_r);
+	});
+}
+
+template<class matrix_type, class vector_type> void run_matrix(const std::string& _prefix, const std::string& _name)
+{
+	typedef typename matrix_type::value_type type;
+	std::vector<matrix_type> a(count), b(count), r(count);
+	std::vector<vector_type> points(count), transformed(count);
+	std::vector<type> determinants(count);
+	std::vector<type> roll(count), pitch(count), yaw(count);
+	random_fill(roll.data(), count, static_cast<type>(-3.0), static_cast<type>(3.0));
+	random_fill(pitch.data(), count, static_cast<type>(-3.0), static_cast<type>(3.0));
+	random_fill(yaw.data(), count, static_cast<type>(-3.0), static_cast<type>(3.0));
+	random_fill(points.data(), count, static_cast<type>(-1.0), static_cast<type>(1.0));
+	for (size_t i = 0; i < count; i++)
+	{
+		a[i] = matrix_type::rotation(roll[i], pitch[i], yaw[i]);
+		b[i] = matrix_type::rotation(yaw[i], roll[i], pitch[i]);
+	}
+	const std::string prefix = _prefix + _name + "/";
+
+	bench::run(prefix + "multiply", iterations, count, sizeof(matrix_type) * 3, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			r[i] = a[i] * b[i];
+		}
+		bench::do_not_optimize(r);
+	});
+	measure(prefix + "transpose", a, r, [](const matrix_type& _m) { return _m.transpose(); });
+	measure(prefix + "determinant", a, determinants, [](const matrix_type& _m) { return _m.determinant(); });
+	measure(prefix + "inverse", a, r, [](const matrix_type& _m) { return _m.inverse(); });
+	bench::run(prefix + "rotation[]", iterations, count, sizeof(type) * 3 + sizeof(matrix_type), [&]()
+	{
+		matrix_type::rotation(roll.data(), pitch.data(), yaw.data(), r.data(), count);
+		bench::do_not_optimize(r);
+	});
+	bench::run(prefix + "transform_point[]", iterations, count, sizeof(vector_type) * 2, [&]()
+	{
+		a[0].transform_point(points.data(), transformed.data(), count);
+		bench::do_not_optimize(transformed);
+	});
+}
+
+template<class type> void run_quaternion(const std::string& _prefix)
+{
+	std::vector<quaternion<type>> a(count), b(count), r(count);
+	std::vector<vector3<type>> angles(count), points(count), rotated(count);
+	random_fill(angles.data(), count, static_cast<type>(-3.0), static_cast<type>(3.0));
+	random_fill(points.data(), count, static_cast<type>(-1.0), static_cast<type>(1.0));
+	quaternion<type>::rotation(angles.data(), a.data(), count);
+	std::reverse_copy(a.begin(), a.end(), b.begin());
+
+	bench::run(_prefix + "quaternion/multiply", iterations, count, sizeof(quaternion<type>) * 3, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			r[i] = a[i] * b[i];
+		}
+		bench::do_not_optimize(r);
+	});
+	bench::run(_prefix + "quaternion/rotate", iterations, count, sizeof(quaternion<type>) + sizeof(vector3<type>) * 2, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			rotated[i] = a[i].rotate(points[i]);
+		}
+		bench::do_not_optimize(rotated);
+	});
+	measure(_prefix + "quaternion/angles", angles, r, [](const vector3<type>& _angles) { return quaternion<type>(_angles); });
+	bench::run(_prefix + "quaternion/rotation[]", iterations, count, sizeof(vector3<type>) + sizeof(quaternion<type>), [&]()
+	{
+		quaternion<type>::rotation(angles.data(), r.data(), count);
+		bench::do_not_optimize(r);
+	});
+	std::vector<polar3<type>> polars(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		polars[i] = polar3<type>(static_cast<type>(1.0), angles[i].x, angles[i].y);
+	}
+	measure(_prefix + "polar3/vector3", polars, rotated, [](const polar3<type>& _p) { return static_cast<vector3<type>>(_p); });
+}
+
+template<class type> void run_hsv(const std::string& _prefix)
+{
+	std::vector<vector4<type>> colors(count);
+	std::vector<hsv<type>> hsvs(count);
+	random_fill(colors.data(), count, static_cast<type>(0.0), static_cast<type>(1.0));
+
+	measure(_prefix + "hsv/from_vector4", colors, hsvs, [](const vector4<type>& _c) { return hsv<type>(_c); });
+	measure(_prefix + "hsv/to_vector4", hsvs, colors, [](const hsv<type>& _c) { return _c.template to_vector4<type>(); });
+}
+
+template<class type> void run_random(const std::string& _prefix)
+{
+	std::vector<type> values(count);
+	std::vector<vector3<type>> points(count);
+	random_engine engine;
+	philox4x32 philox;
+
+	bench::run(_prefix + "random/random(min,max)", iterations, count, sizeof(type), [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			values[i] = random(engine, static_cast<type>(-1.0), static_cast<type>(1.0));
+		}
+		bench::do_not_optimize(values);
+	});
+	bench::run(_prefix + "random/vector3::random", iterations, count, sizeof(vector3<type>), [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			points[i] = vector3<type>::random(engine, static_cast<type>(-1.0), static_cast<type>(1.0));
+		}
+		bench::do_not_optimize(points);
+	});
+	bench::run(_prefix + "random/random_fill(mt19937_64)", iterations, count, sizeof(type), [&]()
+	{
+		random_fill(engine, values.data(), count, static_cast<type>(-1.0), static_cast<type>(1.0));
+		bench::do_not_optimize(values);
+	});
+	bench::run(_prefix + "random/random_fill(philox4x32)", iterations, count, sizeof(type), [&]()
+	{
+		random_fill(philox, values.data(), count, static_cast<type>(-1.0), static_cast<type>(1.0));
+		bench::do_not_optimize(values);
+	});
+}
+
+template<class type> void run(const std::string& _type_name)
+{
+	const std::string prefix = _type_name + "/";
+	run_functions<type>(prefix);
+	run_vector<type>(prefix);
+	run_matrix<matrix3x3<type>, vector2<type>>(prefix, "matrix3x3");
+	run_matrix<matrix4x4<type>, vector3<type>>(prefix, "matrix4x4");
+	run_quaternion<type>(prefix);
+	run_hsv<type>(prefix);
+	run_random<type>(prefix);
+}
+
+int main(int _argc, char** _argv)
+{
+	const char* json = nullptr;
+	for (int i = 1; i + 1 < _argc; i++)
+	{
+		if (std::strcmp(_argv[i], "--json") == 0)
+		{
+			json = _argv[i + 1];
+		}
+	}
+
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float");
+	run<double>("double");
+
+	if (json != nullptr && !bench::write_json(json, std::string("simd=") + ARCH_SIMD_NAME))
+	{
+		std::cerr << "failed to write " << json << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,155 @@
+// matrix4x4の乗算、転置、逆行列を以前の実装(3重ループ、2重ループ、余因子と行列式を別々に求める逆行列)と比較します。
+
+#include <vector>
+#include <arch/matrix4x4.h>
+#include <arch/random_fill.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> matrix4x4<type> reference_multiply(const matrix4x4<type>& _a, const matrix4x4<type>& _b)
+{
+	matrix4x4<type> result = matrix4x4<type>::zero();
+	for (size_t y = 0; y < 4; y++)
+	{
+		for (size_t x = 0; x < 4; x++)
+		{
+			for (size_t i = 0; i < 4; i++)
+			{
+				result.data[y][x] += _a.data[y][i] * _b.data[i][x];
+			}
+		}
+	}
+	return result;
+}
+
+template<class type> matrix4x4<type> reference_transpose(const matrix4x4<type>& _matrix)
+{
+	matrix4x4<type> result;
+	for (size_t y = 0; y < 4; y++)
+	{
+		for (size_t x = 0; x < 4; x++)
+		{
+			result.data[x][y] = _matrix.data[y][x];
+		}
+	}
+	return result;
+}
+
+template<class type> type minor3x3(const matrix4x4<type>& _matrix, size_t _row, size_t _column)
+{
+	static const size_t others[4][3] = { { 1, 2, 3 }, { 0, 2, 3 }, { 0, 1, 3 }, { 0, 1, 2 } };
+	const size_t* r = others[_row];
+	const size_t* c = others[_column];
+	return
+		_matrix.data[r[0]][c[0]] * (_matrix.data[r[1]][c[1]] * _matrix.data[r[2]][c[2]] - _matrix.data[r[1]][c[2]] * _matrix.data[r[2]][c[1]]) -
+		_matrix.data[r[0]][c[1]] * (_matrix.data[r[1]][c[0]] * _matrix.data[r[2]][c[2]] - _matrix.data[r[1]][c[2]] * _matrix.data[r[2]][c[0]]) +
+		_matrix.data[r[0]][c[2]] * (_matrix.data[r[1]][c[0]] * _matrix.data[r[2]][c[1]] - _matrix.data[r[1]][c[1]] * _matrix.data[r[2]][c[0]]);
+}
+
+/*!
+*	@brief 余因子を16個の3x3行列式で求め、行列式を別に求めてから割る以前の方式です。
+*/
+template<class type> matrix4x4<type> reference_inverse(const matrix4x4<type>& _matrix)
+{
+	matrix4x4<type> adjugate;
+	for (size_t y = 0; y < 4; y++)
+	{
+		for (size_t x = 0; x < 4; x++)
+		{
+			adjugate.data[x][y] = ((x + y) % 2 == 0 ? 1 : -1) * minor3x3(_matrix, y, x);
+		}
+	}
+	type determinant = 0;
+	for (size_t x = 0; x < 4; x++)
+	{
+		determinant += _matrix.data[0][x] * ((x % 2 == 0) ? 1 : -1) * minor3x3(_matrix, 0, x);
+	}
+	return determinant != 0 ? adjugate / determinant : matrix4x4<type>::identity();
+}
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 4096;
+	const size_t iterations = 500;
+	const size_t bytes = sizeof(matrix4x4<type>);
+	std::vector<matrix4x4<type>> a(count), b(count), result(count);
+	std::vector<type> determinants(count);
+	philox4x32 engine(11);
+	random_fill(engine, &a[0]._11, count * 16, static_cast<type>(-1.0), static_cast<type>(1.0));
+	random_fill(engine, &b[0]._11, count * 16, static_cast<type>(-1.0), static_cast<type>(1.0));
+
+	std::string prefix = std::string(_type_name) + "/matrix4x4/";
+	double reference, current;
+
+	reference = bench::run(prefix + "multiply(reference)", iterations, count, bytes * 3, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = reference_multiply(a[i], b[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+	current = bench::run(prefix + "multiply", iterations, count, bytes * 3, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i] * b[i];
+		}
+		bench::do_not_optimize(result);
+	});
+	std::cout << "  speedup x" << reference / current << std::endl;
+
+	reference = bench::run(prefix + "transpose(reference)", iterations, count, bytes * 2, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = reference_transpose(a[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+	current = bench::run(prefix + "transpose", iterations, count, bytes * 2, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i].transpose();
+		}
+		bench::do_not_optimize(result);
+	});
+	std::cout << "  speedup x" << reference / current << std::endl;
+
+	reference = bench::run(prefix + "inverse(reference)", iterations, count, bytes * 2, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = reference_inverse(a[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+	current = bench::run(prefix + "inverse", iterations, count, bytes * 2, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i].inverse();
+		}
+		bench::do_not_optimize(result);
+	});
+	std::cout << "  speedup x" << reference / current << std::endl;
+	bench::run(prefix + "inverse(determinant)", iterations, count, bytes * 2 + sizeof(type), [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i].inverse(determinants[i]);
+		}
+		bench::do_not_optimize(result);
+		bench::do_not_optimize(determinants);
+	});
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
@@ -0,0 +1,59 @@
+// matrix4x4の一般逆行列inverse()と、アフィン変換向けのinverse_affine()、剛体変換向けのinverse_rigid()を比較します。
+// 入力は回転と平行移動を合成した剛体変換です。NDEBUGを定義しないとinverse_rigid()の確認処理も計測に含まれます。
+
+#include <vector>
+#include <arch/matrix4x4.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 4096;
+	const size_t iterations = 500;
+	std::vector<matrix4x4<type>> input(count), result(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		vector3<type> angles = vector3<type>::random(static_cast<type>(-3.0), static_cast<type>(3.0));
+		vector3<type> offset = vector3<type>::random(static_cast<type>(-10.0), static_cast<type>(10.0));
+		input[i] = matrix4x4<type>::translation(offset) * matrix4x4<type>::rotation(angles.x, angles.y, angles.z);
+	}
+
+	std::string prefix = std::string(_type_name) + ".";
+	const size_t bytes = sizeof(matrix4x4<type>) * 2;
+
+	bench::run(prefix + "inverse", iterations, count, bytes, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = input[i].inverse();
+		}
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "inverse_affine", iterations, count, bytes, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = input[i].inverse_affine();
+		}
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "inverse_rigid", iterations, count, bytes, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = input[i].inverse_rigid();
+		}
+		bench::do_not_optimize(result);
+	});
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float4x4");
+	run<double>("double4x4");
+	return 0;
+}
@@ -0,0 +1,72 @@
+// matrix3x3/matrix4x4の逆行列と行列式を、1つずつ求める場合とpack幅ずつまとめて求める場合で比較します。
+// 一括版は行列式と特異かどうかのフラグも書き出します。
+
+#include <vector>
+#include <arch/matrix3x3.h>
+#include <arch/matrix4x4.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class matrix_type> void run(const std::string& _name)
+{
+	typedef typename matrix_type::value_type value_type;
+	const size_t count = 4096;
+	const size_t iterations = 500;
+	std::vector<matrix_type> input(count), result(count);
+	std::vector<value_type> determinants(count);
+	std::vector<char> singular(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		for (size_t r = 0; r < input[i].rows(); r++)
+		{
+			for (size_t c = 0; c < input[i].columns(); c++)
+			{
+				input[i].data[r][c] = arch::random(static_cast<value_type>(-1.0), static_cast<value_type>(1.0));
+			}
+		}
+	}
+
+	std::string prefix = _name + ".";
+	const size_t bytes = sizeof(matrix_type) * 2 + sizeof(value_type) + sizeof(bool);
+
+	bench::run(prefix + "inverse", iterations, count, bytes, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = input[i].inverse(determinants[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "inverse_batch", iterations, count, bytes, [&]()
+	{
+		matrix_type::inverse(input.data(), result.data(), determinants.data(), reinterpret_cast<bool*>(singular.data()), count);
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "determinant", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			determinants[i] = input[i].determinant();
+		}
+		bench::do_not_optimize(determinants);
+	});
+
+	bench::run(prefix + "determinant_batch", iterations, count, [&]()
+	{
+		matrix_type::determinant(input.data(), determinants.data(), count);
+		bench::do_not_optimize(determinants);
+	});
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<matrix3x3<float>>("float3x3");
+	run<matrix3x3<double>>("double3x3");
+	run<matrix4x4<float>>("float4x4");
+	run<matrix4x4<double>>("double4x4");
+	return 0;
+}
@@ -0,0 +1,135 @@
+// matrix<T, N, N>の式テンプレートによる評価と、演算ごとに一時行列を確保する素朴な評価を64x64から512x512で比較します。
+// 素朴な積はi-j-kの3重ループ、式テンプレート側はブロック化したカーネルで求めます。
+
+#include <cmath>
+#include <memory>
+#include <arch/matrix.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type, size_t size> using square = matrix<type, size, size>;
+
+template<class type, size_t size> std::unique_ptr<square<type, size>> add(const square<type, size>& _a, const square<type, size>& _b)
+{
+	std::unique_ptr<square<type, size>> result(new square<type, size>);
+	for (size_t i = 0; i < size * size; i++)
+	{
+		result->data()[i] = _a.data()[i] + _b.data()[i];
+	}
+	return result;
+}
+
+template<class type, size_t size> std::unique_ptr<square<type, size>> subtract(const square<type, size>& _a, const square<type, size>& _b)
+{
+	std::unique_ptr<square<type, size>> result(new square<type, size>);
+	for (size_t i = 0; i < size * size; i++)
+	{
+		result->data()[i] = _a.data()[i] - _b.data()[i];
+	}
+	return result;
+}
+
+template<class type, size_t size> std::unique_ptr<square<type, size>> scale(const square<type, size>& _a, type _scale)
+{
+	std::unique_ptr<square<type, size>> result(new square<type, size>);
+	for (size_t i = 0; i < size * size; i++)
+	{
+		result->data()[i] = _a.data()[i] * _scale;
+	}
+	return result;
+}
+
+template<class type, size_t size> std::unique_ptr<square<type, size>> multiply(const square<type, size>& _a, const square<type, size>& _b)
+{
+	std::unique_ptr<square<type, size>> result(new square<type, size>);
+	for (size_t i = 0; i < size; i++)
+	{
+		for (size_t j = 0; j < size; j++)
+		{
+			type sum = static_cast<type>(0);
+			for (size_t k = 0; k < size; k++)
+			{
+				sum += _a[i][k] * _b[k][j];
+			}
+			(*result)[i][j] = sum;
+		}
+	}
+	return result;
+}
+
+template<class type, size_t size> void run(const char* _type_name)
+{
+	typedef square<type, size> matrix_type;
+	std::unique_ptr<matrix_type> a(new matrix_type), b(new matrix_type), c(new matrix_type), x(new matrix_type), y(new matrix_type), result(new matrix_type);
+	for (size_t i = 0; i < size * size; i++)
+	{
+		a->data()[i] = static_cast<type>(std::sin(static_cast<double>(i)));
+		b->data()[i] = static_cast<type>(std::cos(static_cast<double>(i)));
+		c->data()[i] = static_cast<type>(std::sin(static_cast<double>(i) * 0.5));
+		x->data()[i] = static_cast<type>(std::cos(static_cast<double>(i) * 0.25));
+		y->data()[i] = static_cast<type>(std::sin(static_cast<double>(i) * 0.125));
+	}
+
+	std::string prefix = std::string(_type_name) + "." + std::to_string(size) + ".";
+	const size_t elements = size * size;
+	const size_t element_iterations = max<size_t>(1, (static_cast<size_t>(1) << 26) / elements);
+	const size_t product_iterations = max<size_t>(1, (static_cast<size_t>(1) << 26) / (elements * size));
+
+	bench::run(prefix + "a+b*s-c.fused", element_iterations, elements, sizeof(type) * 4, [&]()
+	{
+		*result = *a + *b * static_cast<type>(0.5) - *c;
+		bench::do_not_optimize(*result);
+	});
+
+	bench::run(prefix + "a+b*s-c.naive", element_iterations, elements, sizeof(type) * 4, [&]()
+	{
+		auto scaled = scale(*b, static_cast<type>(0.5));
+		auto sum = add(*a, *scaled);
+		result = subtract(*sum, *c);
+		bench::do_not_optimize(*result);
+	});
+
+	bench::run(prefix + "a*b.blocked", product_iterations, elements, [&]()
+	{
+		*result = *a * *b;
+		bench::do_not_optimize(*result);
+	});
+
+	bench::run(prefix + "a*b.naive", product_iterations, elements, [&]()
+	{
+		result = multiply(*a, *b);
+		bench::do_not_optimize(*result);
+	});
+
+	bench::run(prefix + "a*x+b*y-c.fused", product_iterations, elements, [&]()
+	{
+		*result = *a * *x + *b * *y - *c;
+		bench::do_not_optimize(*result);
+	});
+
+	bench::run(prefix + "a*x+b*y-c.naive", product_iterations, elements, [&]()
+	{
+		auto ax = multiply(*a, *x);
+		auto by = multiply(*b, *y);
+		auto sum = add(*ax, *by);
+		result = subtract(*sum, *c);
+		bench::do_not_optimize(*result);
+	});
+}
+
+template<class type> void run_sizes(const char* _type_name)
+{
+	run<type, 64>(_type_name);
+	run<type, 128>(_type_name);
+	run<type, 256>(_type_name);
+	run<type, 512>(_type_name);
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run_sizes<float>("float");
+	run_sizes<double>("double");
+	return 0;
+}
@@ -0,0 +1,75 @@
+// matrix<T, N, N>::operator*(64x64から1024x1024ではgemm)のGFLOP/sを計測します。
+// 比較としてi-k-jの3重ループも計測します。スレッド数の影響を見る場合は、ARCH_NO_PARALLELを定義してビルドした結果と並べてください。
+
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <arch/matrix.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type, size_t size> void reference_multiply(const matrix<type, size, size>& _a, const matrix<type, size, size>& _b, matrix<type, size, size>& _result)
+{
+	_result.fill(static_cast<type>(0));
+	for (size_t i = 0; i < size; i++)
+	{
+		for (size_t k = 0; k < size; k++)
+		{
+			const type a = _a[i][k];
+			for (size_t j = 0; j < size; j++)
+			{
+				_result[i][j] += a * _b[k][j];
+			}
+		}
+	}
+}
+
+void print_gflops(double _nanoseconds, size_t _size)
+{
+	const double flops = 2.0 * static_cast<double>(_size) * static_cast<double>(_size) * static_cast<double>(_size);
+	std::cout << std::setw(52) << std::fixed << std::setprecision(2) << flops / _nanoseconds << " GFLOP/s" << std::endl;
+}
+
+template<class type, size_t size> void run(const char* _type_name)
+{
+	typedef matrix<type, size, size> matrix_type;
+	std::unique_ptr<matrix_type> a(new matrix_type), b(new matrix_type), result(new matrix_type);
+	for (size_t i = 0; i < size * size; i++)
+	{
+		a->data()[i] = static_cast<type>(std::sin(static_cast<double>(i)));
+		b->data()[i] = static_cast<type>(std::cos(static_cast<double>(i)));
+	}
+
+	std::string prefix = std::string(_type_name) + "." + std::to_string(size) + ".";
+	const size_t iterations = max<size_t>(1, (static_cast<size_t>(1) << 29) / (size * size * size));
+
+	print_gflops(bench::run(prefix + "operator*", iterations, 1, [&]()
+	{
+		*result = *a * *b;
+		bench::do_not_optimize(*result);
+	}), size);
+
+	print_gflops(bench::run(prefix + "reference", iterations, 1, [&]()
+	{
+		reference_multiply(*a, *b, *result);
+		bench::do_not_optimize(*result);
+	}), size);
+}
+
+template<class type> void run_sizes(const char* _type_name)
+{
+	run<type, 64>(_type_name);
+	run<type, 128>(_type_name);
+	run<type, 256>(_type_name);
+	run<type, 512>(_type_name);
+	run<type, 1024>(_type_name);
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << ", threads: " << thread_pool::shared().size() + 1 << std::endl;
+	run_sizes<float>("float");
+	run_sizes<double>("double");
+	return 0;
+}
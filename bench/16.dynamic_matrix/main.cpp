@@ -0,0 +1,138 @@
+// dynamic_vector/dynamic_matrixのaxpy、dot、nrm2、gemv、gerのスループットを計測します。
+// 比較として同じ演算を単純なループで書いたものも計測します。
+
+#include <cmath>
+#include <arch/dynamic_matrix.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> void run_vector(const char* _type_name)
+{
+	const size_t size = 4096;
+	const size_t iterations = 20000;
+	dynamic_vector<type> x(size), y(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		x[i] = static_cast<type>(std::sin(static_cast<double>(i)));
+		y[i] = static_cast<type>(std::cos(static_cast<double>(i)));
+	}
+
+	std::string prefix = std::string(_type_name) + ".";
+
+	bench::run(prefix + "axpy", iterations, size, sizeof(type) * 3, [&]()
+	{
+		axpy(static_cast<type>(1e-3), x, y);
+		bench::do_not_optimize(y);
+	});
+
+	bench::run(prefix + "axpy.loop", iterations, size, sizeof(type) * 3, [&]()
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			y[i] += static_cast<type>(1e-3) * x[i];
+		}
+		bench::do_not_optimize(y);
+	});
+
+	bench::run(prefix + "dot", iterations, size, sizeof(type) * 2, [&]()
+	{
+		type result = dot(x, y);
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "dot.loop", iterations, size, sizeof(type) * 2, [&]()
+	{
+		type result = static_cast<type>(0);
+		for (size_t i = 0; i < size; i++)
+		{
+			result += x[i] * y[i];
+		}
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "nrm2", iterations, size, sizeof(type), [&]()
+	{
+		type result = nrm2(x);
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "dot.stride2", iterations, size / 2, sizeof(type) * 2, [&]()
+	{
+		type result = dot(x.slice(0, size / 2, 2), y.slice(0, size / 2, 2));
+		bench::do_not_optimize(result);
+	});
+}
+
+template<class type> void run_matrix(const char* _type_name)
+{
+	const size_t size = 1024;
+	const size_t iterations = 200;
+	dynamic_matrix<type> a(size, size);
+	dynamic_vector<type> x(size), y(size);
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		a.data()[i] = static_cast<type>(std::sin(static_cast<double>(i)));
+	}
+	for (size_t i = 0; i < size; i++)
+	{
+		x[i] = static_cast<type>(std::cos(static_cast<double>(i)));
+	}
+
+	std::string prefix = std::string(_type_name) + "." + std::to_string(size) + ".";
+	const size_t elements = size * size;
+
+	bench::run(prefix + "gemv", iterations, elements, sizeof(type), [&]()
+	{
+		gemv(static_cast<type>(1), a, x, static_cast<type>(0), y);
+		bench::do_not_optimize(y);
+	});
+
+	bench::run(prefix + "gemv.transposed", iterations, elements, sizeof(type), [&]()
+	{
+		gemv(static_cast<type>(1), a.transposed(), x, static_cast<type>(0), y);
+		bench::do_not_optimize(y);
+	});
+
+	bench::run(prefix + "gemv.loop", iterations, elements, sizeof(type), [&]()
+	{
+		for (size_t row = 0; row < size; row++)
+		{
+			type sum = static_cast<type>(0);
+			for (size_t column = 0; column < size; column++)
+			{
+				sum += a(row, column) * x[column];
+			}
+			y[row] = sum;
+		}
+		bench::do_not_optimize(y);
+	});
+
+	bench::run(prefix + "ger", iterations, elements, sizeof(type) * 2, [&]()
+	{
+		ger(static_cast<type>(1e-6), x, y, a);
+		bench::do_not_optimize(a);
+	});
+
+	bench::run(prefix + "ger.loop", iterations, elements, sizeof(type) * 2, [&]()
+	{
+		for (size_t row = 0; row < size; row++)
+		{
+			for (size_t column = 0; column < size; column++)
+			{
+				a(row, column) += static_cast<type>(1e-6) * x[row] * y[column];
+			}
+		}
+		bench::do_not_optimize(a);
+	});
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run_vector<float>("float");
+	run_vector<double>("double");
+	run_matrix<float>("float");
+	run_matrix<double>("double");
+	return 0;
+}
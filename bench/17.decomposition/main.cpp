@@ -0,0 +1,106 @@
+// LU、コレスキー、QR分解のGFLOP/sを、ブロック化した版としない版で計測します。
+// 各反復で元の行列をコピーしてから分解するため、小さい行列ではコピーの時間も含まれます。
+
+#include <cmath>
+#include <iomanip>
+#include <vector>
+#include <arch/decomposition.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+void print_gflops(double _nanoseconds, double _flops)
+{
+	std::cout << std::setw(52) << std::fixed << std::setprecision(2) << _flops / _nanoseconds << " GFLOP/s" << std::endl;
+}
+
+template<class type> void run(const char* _type_name, size_t _size)
+{
+	typedef decomposition_kernel<type> kernel;
+	dynamic_matrix<type> a(_size, _size), spd(_size, _size), work(_size, _size);
+	for (size_t row = 0; row < _size; row++)
+	{
+		for (size_t column = 0; column < _size; column++)
+		{
+			a(row, column) = static_cast<type>(std::sin(row * 12.9898 + column * 78.233));
+		}
+		a(row, row) += static_cast<type>(2);
+	}
+	gemm(static_cast<type>(1), a.transposed(), a, static_cast<type>(0), spd);
+	for (size_t row = 0; row < _size; row++)
+	{
+		for (size_t column = 0; column < row; column++)
+		{
+			spd(column, row) = spd(row, column);
+		}
+	}
+
+	std::vector<size_t> pivots(_size);
+	std::vector<type> tau(_size);
+	dynamic_matrix<type> rhs(_size, 16, static_cast<type>(1));
+	dynamic_matrix<type> solution(_size, 16);
+
+	std::string prefix = std::string(_type_name) + "." + std::to_string(_size) + ".";
+	const double n = static_cast<double>(_size);
+	const size_t iterations = max(static_cast<size_t>(1), (static_cast<size_t>(1) << 28) / (_size * _size * _size));
+
+	print_gflops(bench::run(prefix + "lu", iterations, 1, [&]()
+	{
+		work.view().assign(a);
+		kernel::lu(work.view(), pivots.data());
+		bench::do_not_optimize(work);
+	}), 2.0 / 3.0 * n * n * n);
+
+	print_gflops(bench::run(prefix + "lu.unblocked", iterations, 1, [&]()
+	{
+		work.view().assign(a);
+		kernel::lu_unblocked(work.view(), pivots.data());
+		bench::do_not_optimize(work);
+	}), 2.0 / 3.0 * n * n * n);
+
+	print_gflops(bench::run(prefix + "lu_solve.16", iterations, 1, [&]()
+	{
+		solution.view().assign(rhs);
+		lu_solve(work, pivots.data(), solution);
+		bench::do_not_optimize(solution);
+	}), 2.0 * n * n * 16);
+
+	print_gflops(bench::run(prefix + "cholesky", iterations, 1, [&]()
+	{
+		work.view().assign(spd);
+		kernel::cholesky(work.view());
+		bench::do_not_optimize(work);
+	}), n * n * n / 3.0);
+
+	print_gflops(bench::run(prefix + "cholesky.unblocked", iterations, 1, [&]()
+	{
+		work.view().assign(spd);
+		kernel::cholesky_unblocked(work.view());
+		bench::do_not_optimize(work);
+	}), n * n * n / 3.0);
+
+	print_gflops(bench::run(prefix + "qr", iterations, 1, [&]()
+	{
+		work.view().assign(a);
+		kernel::qr(work.view(), tau.data());
+		bench::do_not_optimize(work);
+	}), 4.0 / 3.0 * n * n * n);
+
+	print_gflops(bench::run(prefix + "qr.unblocked", iterations, 1, [&]()
+	{
+		work.view().assign(a);
+		kernel::qr_unblocked(work.view(), tau.data());
+		bench::do_not_optimize(work);
+	}), 4.0 / 3.0 * n * n * n);
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	for (size_t size : { 16, 64, 256, 512 })
+	{
+		run<float>("float", size);
+		run<double>("double", size);
+	}
+	return 0;
+}
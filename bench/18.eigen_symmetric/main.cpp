@@ -0,0 +1,134 @@
+// matrix3x3::eigen_symmetricのスループットと精度を計測します。
+// 固有値がばらばらな行列、2つが等しい行列、3つがほぼ等しい行列のそれぞれで、
+// 残差max|Av - λv| / max|A|と固有ベクトルの直交性の誤差max|V^T V - I|を表示します。
+
+#include <cmath>
+#include <iomanip>
+#include <vector>
+#include <arch/matrix3x3.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+///	<summary>ランダムな回転Rと指定した固有値からRΛR^Tを作ります。</summary>
+template<class value_type> matrix3x3<value_type> make_symmetric(const double (&_values)[3])
+{
+	double q[4];
+	double length = 0.0;
+	for (double& value : q)
+	{
+		value = arch::random(-1.0, 1.0);
+		length += value * value;
+	}
+	length = std::sqrt(length);
+	const double w = q[0] / length, x = q[1] / length, y = q[2] / length, z = q[3] / length;
+	const double rotation[3][3] =
+	{
+		{ 1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y) },
+		{ 2 * (x * y + w * z), 1 - 2 * (x * x + z * z), 2 * (y * z - w * x) },
+		{ 2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y) }
+	};
+
+	matrix3x3<value_type> result;
+	for (size_t r = 0; r < 3; r++)
+	{
+		for (size_t c = 0; c < 3; c++)
+		{
+			double sum = 0.0;
+			for (size_t k = 0; k < 3; k++)
+			{
+				sum += rotation[r][k] * _values[k] * rotation[c][k];
+			}
+			result.data[r][c] = static_cast<value_type>(sum);
+		}
+	}
+	return result;
+}
+
+template<class value_type> void report_accuracy(const std::string& _name, const std::vector<matrix3x3<value_type>>& _input, const std::vector<vector3<value_type>>& _values, const std::vector<vector3<value_type>>& _vectors)
+{
+	double residual = 0.0, orthogonality = 0.0;
+	for (size_t i = 0; i < _input.size(); i++)
+	{
+		double norm = 0.0;
+		for (size_t r = 0; r < 3; r++)
+		{
+			for (size_t c = 0; c < 3; c++)
+			{
+				norm = max(norm, std::abs(static_cast<double>(_input[i].data[r][c])));
+			}
+		}
+		for (size_t k = 0; k < 3; k++)
+		{
+			const vector3<value_type>& v = _vectors[i * 3 + k];
+			for (size_t r = 0; r < 3; r++)
+			{
+				double sum = -static_cast<double>(_values[i].data[k]) * v.data[r];
+				for (size_t c = 0; c < 3; c++)
+				{
+					sum += static_cast<double>(_input[i].data[r][c]) * v.data[c];
+				}
+				residual = max(residual, std::abs(sum) / norm);
+			}
+			for (size_t l = 0; l < 3; l++)
+			{
+				const vector3<value_type>& u = _vectors[i * 3 + l];
+				const double dot = static_cast<double>(v.x) * u.x + static_cast<double>(v.y) * u.y + static_cast<double>(v.z) * u.z;
+				orthogonality = max(orthogonality, std::abs(dot - (k == l ? 1.0 : 0.0)));
+			}
+		}
+	}
+	std::cout << std::left << std::setw(40) << (_name + ".accuracy") << std::right << std::scientific << std::setprecision(2)
+		<< "residual " << residual << "  orthogonality " << orthogonality << std::fixed << std::endl;
+}
+
+template<class value_type> void run(const char* _type_name, const char* _case_name, double _spread)
+{
+	const size_t count = 4096;
+	const size_t iterations = 200;
+	std::vector<matrix3x3<value_type>> input(count);
+	for (auto& matrix : input)
+	{
+		const double base = arch::random(-1.0, 1.0);
+		const double values[3] = { base, base + _spread * arch::random(-1.0, 1.0), base + _spread * arch::random(-1.0, 1.0) };
+		matrix = make_symmetric<value_type>(values);
+	}
+	std::vector<vector3<value_type>> values(count), vectors(count * 3);
+
+	std::string prefix = std::string(_type_name) + "." + _case_name + ".";
+	const size_t bytes = sizeof(matrix3x3<value_type>) + sizeof(vector3<value_type>) * 4;
+
+	bench::run(prefix + "eigen_symmetric", iterations, count, bytes, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			input[i].eigen_symmetric(values[i], &vectors[i * 3]);
+		}
+		bench::do_not_optimize(values);
+		bench::do_not_optimize(vectors);
+	});
+	report_accuracy(prefix + "single", input, values, vectors);
+
+	bench::run(prefix + "eigen_symmetric.batch", iterations, count, bytes, [&]()
+	{
+		matrix3x3<value_type>::eigen_symmetric(input.data(), values.data(), vectors.data(), count);
+		bench::do_not_optimize(values);
+		bench::do_not_optimize(vectors);
+	});
+	report_accuracy(prefix + "batch", input, values, vectors);
+}
+
+template<class value_type> void run_cases(const char* _type_name)
+{
+	run<value_type>(_type_name, "distinct", 1.0);
+	run<value_type>(_type_name, "close", 1e-4);
+	run<value_type>(_type_name, "degenerate", 0.0);
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run_cases<float>("float");
+	run_cases<double>("double");
+	return 0;
+}
@@ -0,0 +1,109 @@
+// matrix3x3::svdとpolarを、1つずつ求める場合とpack幅ずつまとめて求める場合で比較します。
+// 入力は変形勾配を想定した回転 * (I + 小さな変形)の行列100万個で、分解の残差max|A - UΣV^T| / max|A|も表示します。
+
+#include <cmath>
+#include <iomanip>
+#include <vector>
+#include <arch/matrix3x3.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class value_type> double residual(const std::vector<matrix3x3<value_type>>& _input, const std::vector<matrix3x3<value_type>>& _u, const std::vector<vector3<value_type>>& _sigma, const std::vector<matrix3x3<value_type>>& _v)
+{
+	double result = 0.0;
+	for (size_t i = 0; i < _input.size(); i++)
+	{
+		double norm = 0.0;
+		for (size_t k = 0; k < 9; k++)
+		{
+			norm = max(norm, std::abs(static_cast<double>(_input[i].data[k / 3][k % 3])));
+		}
+		for (size_t r = 0; r < 3; r++)
+		{
+			for (size_t c = 0; c < 3; c++)
+			{
+				double sum = -static_cast<double>(_input[i].data[r][c]);
+				for (size_t k = 0; k < 3; k++)
+				{
+					sum += static_cast<double>(_u[i].data[r][k]) * _sigma[i].data[k] * _v[i].data[c][k];
+				}
+				result = max(result, std::abs(sum) / norm);
+			}
+		}
+	}
+	return result;
+}
+
+template<class value_type> void run(const std::string& _name)
+{
+	const size_t count = 1 << 20;
+	const size_t iterations = 5;
+	std::vector<matrix3x3<value_type>> input(count), u(count), v(count), stretch(count);
+	std::vector<vector3<value_type>> sigma(count);
+	std::vector<quaternion<value_type>> rotation(count);
+	for (auto& matrix : input)
+	{
+		const matrix3x3<value_type> deformation = matrix3x3<value_type>::rotation(arch::random(static_cast<value_type>(-3.0), static_cast<value_type>(3.0)), arch::random(static_cast<value_type>(-3.0), static_cast<value_type>(3.0)), arch::random(static_cast<value_type>(-3.0), static_cast<value_type>(3.0)));
+		for (size_t r = 0; r < 3; r++)
+		{
+			for (size_t c = 0; c < 3; c++)
+			{
+				value_type sum = 0;
+				for (size_t k = 0; k < 3; k++)
+				{
+					sum += deformation.data[r][k] * ((k == c ? static_cast<value_type>(1) : static_cast<value_type>(0)) + arch::random(static_cast<value_type>(-0.3), static_cast<value_type>(0.3)));
+				}
+				matrix.data[r][c] = sum;
+			}
+		}
+	}
+
+	std::string prefix = _name + ".";
+	bench::run(prefix + "svd", iterations, count, sizeof(matrix3x3<value_type>) * 3 + sizeof(vector3<value_type>), [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			input[i].svd(u[i], sigma[i], v[i]);
+		}
+		bench::do_not_optimize(u);
+	});
+	std::cout << std::left << std::setw(40) << (prefix + "svd.residual") << std::right << std::scientific << std::setprecision(2) << residual(input, u, sigma, v) << std::fixed << std::endl;
+
+	bench::run(prefix + "svd_batch", iterations, count, sizeof(matrix3x3<value_type>) * 3 + sizeof(vector3<value_type>), [&]()
+	{
+		matrix3x3<value_type>::svd(input.data(), u.data(), sigma.data(), v.data(), count);
+		bench::do_not_optimize(u);
+	});
+	std::cout << std::left << std::setw(40) << (prefix + "svd_batch.residual") << std::right << std::scientific << std::setprecision(2) << residual(input, u, sigma, v) << std::fixed << std::endl;
+
+	bench::run(prefix + "polar", iterations, count, sizeof(matrix3x3<value_type>) + sizeof(quaternion<value_type>), [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			rotation[i] = input[i].polar();
+		}
+		bench::do_not_optimize(rotation);
+	});
+
+	bench::run(prefix + "polar_batch", iterations, count, sizeof(matrix3x3<value_type>) + sizeof(quaternion<value_type>), [&]()
+	{
+		matrix3x3<value_type>::polar(input.data(), rotation.data(), nullptr, count);
+		bench::do_not_optimize(rotation);
+	});
+
+	bench::run(prefix + "polar_batch.stretch", iterations, count, sizeof(matrix3x3<value_type>) * 2 + sizeof(quaternion<value_type>), [&]()
+	{
+		matrix3x3<value_type>::polar(input.data(), rotation.data(), stretch.data(), count);
+		bench::do_not_optimize(rotation);
+		bench::do_not_optimize(stretch);
+	});
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float3x3");
+	run<double>("double3x3");
+	return 0;
+}
@@ -0,0 +1,108 @@
+// std::vector<vector3>(AoS)に対する一括演算とsoa_vector3(SoA)の一括演算を比較します。
+
+#include <vector>
+#include <arch/soa_vector.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 1 << 20;
+	const size_t iterations = 20;
+	std::vector<vector3<type>> a(count), b(count), result(count);
+	std::vector<type> scalars(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		a[i] = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+		b[i] = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+	}
+	soa_vector3<type> soa_a(a), soa_b(b), soa_result(a);
+
+	std::string prefix = std::string(_type_name) + ".";
+	double aos, soa;
+
+	aos = bench::run(prefix + "aos.dot", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			scalars[i] = a[i].dot(b[i]);
+		}
+		bench::do_not_optimize(scalars);
+	});
+	soa = bench::run(prefix + "soa.dot", iterations, count, [&]()
+	{
+		soa_a.dot(soa_b, scalars.data());
+		bench::do_not_optimize(scalars);
+	});
+	std::cout << "  speedup x" << aos / soa << std::endl;
+
+	aos = bench::run(prefix + "aos.length", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			scalars[i] = a[i].length();
+		}
+		bench::do_not_optimize(scalars);
+	});
+	soa = bench::run(prefix + "soa.length", iterations, count, [&]()
+	{
+		soa_a.length(scalars.data());
+		bench::do_not_optimize(scalars);
+	});
+	std::cout << "  speedup x" << aos / soa << std::endl;
+
+	aos = bench::run(prefix + "aos.cross", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i].cross(b[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+	soa = bench::run(prefix + "soa.cross", iterations, count, [&]()
+	{
+		soa_a.cross(soa_b, soa_result);
+		bench::do_not_optimize(soa_result);
+	});
+	std::cout << "  speedup x" << aos / soa << std::endl;
+
+	aos = bench::run(prefix + "aos.normalize", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i].normalized();
+		}
+		bench::do_not_optimize(result);
+	});
+	soa = bench::run(prefix + "soa.normalize", iterations, count, [&]()
+	{
+		soa_result.normalize();
+		bench::do_not_optimize(soa_result);
+	});
+	std::cout << "  speedup x" << aos / soa << std::endl;
+
+	aos = bench::run(prefix + "aos.add_scale", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = (a[i] + b[i]) * static_cast<type>(0.5);
+		}
+		bench::do_not_optimize(result);
+	});
+	soa = bench::run(prefix + "soa.add_scale", iterations, count, [&]()
+	{
+		soa_result += soa_b;
+		soa_result *= static_cast<type>(0.5);
+		bench::do_not_optimize(soa_result);
+	});
+	std::cout << "  speedup x" << aos / soa << std::endl;
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float3");
+	run<double>("double3");
+	return 0;
+}
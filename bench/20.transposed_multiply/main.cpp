@@ -0,0 +1,111 @@
+// 転置を含む積と法線行列を、転置や逆行列を作ってから掛ける場合と、
+// multiply_transposed/transposed_multiply/normal_matrixで直接求める場合で比較します。
+
+#include <vector>
+#include <arch/matrix3x3.h>
+#include <arch/matrix4x4.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class matrix_type> void randomize(std::vector<matrix_type>& _matrices)
+{
+	typedef typename matrix_type::value_type value_type;
+	for (auto& matrix : _matrices)
+	{
+		for (size_t r = 0; r < matrix.rows(); r++)
+		{
+			for (size_t c = 0; c < matrix.columns(); c++)
+			{
+				matrix.data[r][c] = arch::random(static_cast<value_type>(-1.0), static_cast<value_type>(1.0));
+			}
+		}
+	}
+}
+
+template<class matrix_type, class normal_type> void run(const std::string& _name, normal_type (*_reference_normal)(const matrix_type&))
+{
+	const size_t count = 4096;
+	const size_t iterations = 500;
+	std::vector<matrix_type> a(count), b(count), result(count);
+	std::vector<normal_type> normals(count);
+	randomize(a);
+	randomize(b);
+
+	std::string prefix = _name + ".";
+	bench::run(prefix + "transpose_multiply", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i].transpose() * b[i];
+		}
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "transposed_multiply", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i].transposed_multiply(b[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "multiply_transpose", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i] * b[i].transpose();
+		}
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "multiply_transposed", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = a[i].multiply_transposed(b[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+
+	bench::run(prefix + "inverse_transpose", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			normals[i] = _reference_normal(a[i]);
+		}
+		bench::do_not_optimize(normals);
+	});
+
+	bench::run(prefix + "normal_matrix", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			normals[i] = a[i].normal_matrix();
+		}
+		bench::do_not_optimize(normals);
+	});
+}
+
+template<class value_type> matrix3x3<value_type> inverse_transpose(const matrix3x3<value_type>& _matrix)
+{
+	return _matrix.inverse().transpose();
+}
+
+///	<summary>4x4の逆行列を転置し、左上3x3を取り出します。</summary>
+template<class value_type> matrix3x3<value_type> inverse_transpose(const matrix4x4<value_type>& _matrix)
+{
+	const matrix4x4<value_type> normal = _matrix.inverse().transpose();
+	return matrix3x3<value_type>(normal._11, normal._12, normal._13, normal._21, normal._22, normal._23, normal._31, normal._32, normal._33);
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<matrix3x3<float>, matrix3x3<float>>("float3x3", inverse_transpose<float>);
+	run<matrix3x3<double>, matrix3x3<double>>("double3x3", inverse_transpose<double>);
+	run<matrix4x4<float>, matrix3x3<float>>("float4x4", inverse_transpose<float>);
+	run<matrix4x4<double>, matrix3x3<double>>("double4x4", inverse_transpose<double>);
+	return 0;
+}
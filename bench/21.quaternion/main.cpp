@@ -0,0 +1,90 @@
+// quaternionの積と回転を比較します。
+// 積は成分ごとの式とoperator*を、回転はクォータニオンの積2回による回転、rotate、配列を渡す一括rotateを比べます。
+
+#include <cmath>
+#include <vector>
+#include <arch/quaternion.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> quaternion<type> random_rotation()
+{
+	return quaternion<type>(vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0)), arch::random(static_cast<type>(-3.0), static_cast<type>(3.0)));
+}
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 16384;
+	const size_t iterations = 1000;
+	std::vector<quaternion<type>> a(count), b(count), product(count);
+	std::vector<vector3<type>> input(count), output(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		a[i] = random_rotation<type>();
+		b[i] = random_rotation<type>();
+		input[i] = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+	}
+	const quaternion<type> rotation = random_rotation<type>();
+
+	std::string prefix = std::string(_type_name) + ".";
+	double single, batch;
+
+	single = bench::run(prefix + "multiply.reference", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const quaternion<type>& p = a[i];
+			const quaternion<type>& q = b[i];
+			product[i] = quaternion<type>
+				(
+					p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y,
+					p.w * q.y - p.x * q.z + p.y * q.w + p.z * q.x,
+					p.w * q.z + p.x * q.y - p.y * q.x + p.z * q.w,
+					p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z
+					);
+		}
+		bench::do_not_optimize(product);
+	});
+	batch = bench::run(prefix + "multiply", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			product[i] = a[i] * b[i];
+		}
+		bench::do_not_optimize(product);
+	});
+	std::cout << "  speedup x" << single / batch << std::endl;
+
+	single = bench::run(prefix + "rotate.reference", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const quaternion<type> v(input[i].x, input[i].y, input[i].z, static_cast<type>(0.0));
+			output[i] = ((rotation * v) * rotation.conjugated()).real;
+		}
+		bench::do_not_optimize(output);
+	});
+	bench::run(prefix + "rotate", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			output[i] = rotation.rotate(input[i]);
+		}
+		bench::do_not_optimize(output);
+	});
+	batch = bench::run(prefix + "rotate[]", iterations, count, [&]()
+	{
+		rotation.rotate(input.data(), output.data(), count);
+		bench::do_not_optimize(output);
+	});
+	std::cout << "  speedup x" << single / batch << std::endl;
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
@@ -0,0 +1,152 @@
+// quaternionのslerp/nlerp/fast_slerpを、1組ずつ求める場合とpack幅ずつまとめて求める場合で比較します。
+// アニメーションのブレンドを想定した20万組の関節の回転を補間し、long doubleで求めたslerpとの最大の角度の差(ラジアン)も表示します。
+
+#include <cmath>
+#include <iomanip>
+#include <vector>
+#include <arch/quaternion.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> quaternion<type> random_rotation()
+{
+	return quaternion<type>(vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0)), arch::random(static_cast<type>(-3.0), static_cast<type>(3.0)));
+}
+
+/*!
+*	@brief _resultとlong doubleで求めたslerpとの回転角の差の最大値を求めます。
+*	角度は2つの単位クォータニオンの弦の長さから4asin(|p - q| / 2)で求め、符号の違う同じ回転は同一とみなします。
+*/
+template<class type> double angular_error(const std::vector<quaternion<type>>& _begin, const std::vector<quaternion<type>>& _end, const std::vector<type>& _factors, const std::vector<quaternion<type>>& _result)
+{
+	typedef long double real;
+	double result = 0.0;
+	for (size_t i = 0; i < _result.size(); i++)
+	{
+		real begin[4], end[4], sum = 0.0L, difference = 0.0L, d = 0.0L;
+		for (size_t k = 0; k < 4; k++)
+		{
+			begin[k] = _begin[i].data[k];
+			end[k] = _end[i].data[k];
+			d += begin[k] * end[k];
+		}
+		for (size_t k = 0; k < 4; k++)
+		{
+			end[k] = d < 0.0L ? -end[k] : end[k];
+			sum += (begin[k] + end[k]) * (begin[k] + end[k]);
+			difference += (begin[k] - end[k]) * (begin[k] - end[k]);
+		}
+
+		const real theta = 2.0L * std::atan2(std::sqrt(difference), std::sqrt(sum));
+		const real t = _factors[i];
+		real plus = 0.0L, minus = 0.0L;
+		for (size_t k = 0; k < 4; k++)
+		{
+			const real expected = theta > 0.0L ? (std::sin((1.0L - t) * theta) * begin[k] + std::sin(t * theta) * end[k]) / std::sin(theta) : begin[k];
+			plus += (_result[i].data[k] + expected) * (_result[i].data[k] + expected);
+			minus += (_result[i].data[k] - expected) * (_result[i].data[k] - expected);
+		}
+		result = max(result, static_cast<double>(4.0L * std::asin(std::sqrt(min(plus, minus)) * 0.5L)));
+	}
+	return result;
+}
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 200000;
+	const size_t iterations = 20;
+	std::vector<quaternion<type>> begin(count), end(count), result(count);
+	std::vector<type> factors(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		begin[i] = random_rotation<type>();
+		end[i] = random_rotation<type>();
+		factors[i] = arch::random(static_cast<type>(0.0), static_cast<type>(1.0));
+	}
+
+	std::string prefix = std::string(_type_name) + ".";
+	const auto print_error = [&](const std::string& _name)
+	{
+		std::cout << std::left << std::setw(40) << (prefix + _name + ".error") << std::right << std::scientific << std::setprecision(2) << angular_error(begin, end, factors, result) << std::fixed << std::endl;
+	};
+	double reference, single, batch;
+
+	reference = bench::run(prefix + "slerp.reference", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const quaternion<type>& p = begin[i];
+			const quaternion<type>& q = end[i];
+			const type d = p.x * q.x + p.y * q.y + p.z * q.z + p.w * q.w;
+			const type sign = d < static_cast<type>(0.0) ? static_cast<type>(-1.0) : static_cast<type>(1.0);
+			type s0 = static_cast<type>(1.0) - factors[i], s1 = factors[i];
+			if (d * sign < static_cast<type>(0.9995))
+			{
+				const type theta = std::acos(d * sign);
+				const type sin_theta = std::sin(theta);
+				s0 = std::sin(s0 * theta) / sin_theta;
+				s1 = std::sin(s1 * theta) / sin_theta;
+			}
+			s1 *= sign;
+			result[i] = quaternion<type>(s0 * p.x + s1 * q.x, s0 * p.y + s1 * q.y, s0 * p.z + s1 * q.z, s0 * p.w + s1 * q.w);
+		}
+		bench::do_not_optimize(result);
+	});
+	print_error("slerp.reference");
+	single = bench::run(prefix + "slerp", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = quaternion<type>::slerp(begin[i], end[i], factors[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+	batch = bench::run(prefix + "slerp[]", iterations, count, [&]()
+	{
+		quaternion<type>::slerp(begin.data(), end.data(), factors.data(), result.data(), count);
+		bench::do_not_optimize(result);
+	});
+	print_error("slerp[]");
+	std::cout << "  speedup x" << reference / batch << " (single x" << reference / single << ")" << std::endl;
+
+	single = bench::run(prefix + "nlerp", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = quaternion<type>::nlerp(begin[i], end[i], factors[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+	batch = bench::run(prefix + "nlerp[]", iterations, count, [&]()
+	{
+		quaternion<type>::nlerp(begin.data(), end.data(), factors.data(), result.data(), count);
+		bench::do_not_optimize(result);
+	});
+	print_error("nlerp[]");
+	std::cout << "  speedup x" << single / batch << std::endl;
+
+	single = bench::run(prefix + "fast_slerp", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = quaternion<type>::fast_slerp(begin[i], end[i], factors[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+	batch = bench::run(prefix + "fast_slerp[]", iterations, count, [&]()
+	{
+		quaternion<type>::fast_slerp(begin.data(), end.data(), factors.data(), result.data(), count);
+		bench::do_not_optimize(result);
+	});
+	print_error("fast_slerp[]");
+	std::cout << "  speedup x" << single / batch << std::endl;
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
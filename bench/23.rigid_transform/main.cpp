@@ -0,0 +1,125 @@
+// クォータニオンと行列の変換、およびrigid_transformとmatrix4x4による変換の合成・点の変換を比較します。
+// 合成は親が自分より前にある4096ノードの階層で、ワールド変換 = 親のワールド変換 * ローカル変換を順に求めます。
+
+#include <vector>
+#include <arch/rigid_transform.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> quaternion<type> random_rotation()
+{
+	return quaternion<type>(vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0)), arch::random(static_cast<type>(-3.0), static_cast<type>(3.0)));
+}
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 4096;
+	const size_t iterations = 500;
+	std::vector<type> roll(count), pitch(count), yaw(count);
+	std::vector<quaternion<type>> rotations(count);
+	std::vector<matrix4x4<type>> local_matrices(count), world_matrices(count);
+	std::vector<rigid_transform<type>> local_transforms(count), world_transforms(count);
+	std::vector<size_t> parents(count);
+	std::vector<vector3<type>> points(count), transformed(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		roll[i] = arch::random(static_cast<type>(-3.0), static_cast<type>(3.0));
+		pitch[i] = arch::random(static_cast<type>(-3.0), static_cast<type>(3.0));
+		yaw[i] = arch::random(static_cast<type>(-3.0), static_cast<type>(3.0));
+		rotations[i] = quaternion<type>(pitch[i], yaw[i], roll[i]);
+		local_transforms[i] = rigid_transform<type>(random_rotation<type>(), vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0)));
+		local_matrices[i] = local_transforms[i].to_matrix4x4();
+		parents[i] = i == 0 ? 0 : static_cast<size_t>(arch::random(0.0, static_cast<double>(i)));
+		points[i] = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+	}
+
+	std::string prefix = std::string(_type_name) + ".";
+	double reference, result;
+
+	reference = bench::run(prefix + "matrix4x4::rotation(roll,pitch,yaw)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			world_matrices[i] = matrix4x4<type>::rotation(roll[i], pitch[i], yaw[i]);
+		}
+		bench::do_not_optimize(world_matrices);
+	});
+	result = bench::run(prefix + "quaternion::to_matrix4x4", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			world_matrices[i] = rotations[i].to_matrix4x4();
+		}
+		bench::do_not_optimize(world_matrices);
+	});
+	std::cout << "  speedup x" << reference / result << std::endl;
+	bench::run(prefix + "quaternion::from_matrix", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			rotations[i] = quaternion<type>::from_matrix(world_matrices[i]);
+		}
+		bench::do_not_optimize(rotations);
+	});
+
+	reference = bench::run(prefix + "compose.matrix4x4", iterations, count, [&]()
+	{
+		world_matrices[0] = local_matrices[0];
+		for (size_t i = 1; i < count; i++)
+		{
+			world_matrices[i] = world_matrices[parents[i]] * local_matrices[i];
+		}
+		bench::do_not_optimize(world_matrices);
+	});
+	result = bench::run(prefix + "compose.rigid_transform", iterations, count, [&]()
+	{
+		world_transforms[0] = local_transforms[0];
+		for (size_t i = 1; i < count; i++)
+		{
+			world_transforms[i] = world_transforms[parents[i]] * local_transforms[i];
+		}
+		bench::do_not_optimize(world_transforms);
+	});
+	std::cout << "  speedup x" << reference / result << std::endl;
+	bench::run(prefix + "inverse.matrix4x4", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			world_matrices[i] = local_matrices[i].inverse();
+		}
+		bench::do_not_optimize(world_matrices);
+	});
+	bench::run(prefix + "inverse.rigid_transform", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			world_transforms[i] = local_transforms[i].inverse();
+		}
+		bench::do_not_optimize(world_transforms);
+	});
+
+	const rigid_transform<type>& transform = world_transforms[count - 1];
+	reference = bench::run(prefix + "transform_point", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			transformed[i] = transform.transform_point(points[i]);
+		}
+		bench::do_not_optimize(transformed);
+	});
+	result = bench::run(prefix + "transform_point[]", iterations, count, [&]()
+	{
+		transform.transform_point(points.data(), transformed.data(), count);
+		bench::do_not_optimize(transformed);
+	});
+	std::cout << "  speedup x" << reference / result << std::endl;
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
@@ -0,0 +1,100 @@
+// 1頂点4ボーンのスキニングを、matrix4x4の線形混合(LBS)、dual_quaternion::blendで1頂点ずつ求める場合、
+// 成分ごとの配列に対するdual_quaternion::skinでまとめて求める場合で比較します。頂点は100万個、ボーンは64個です。
+// skinは1頂点あたり72バイト(float)を読み書きするため、1コアではメモリ帯域で決まる時間(同じ量を読み書きするだけのループと同程度)が下限になります。
+
+#include <vector>
+#include <arch/dual_quaternion.h>
+#include <arch/matrix4x4.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> quaternion<type> random_rotation()
+{
+	return quaternion<type>(vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0)), arch::random(static_cast<type>(-3.0), static_cast<type>(3.0)));
+}
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t bone_count = 64;
+	const size_t count = 1000000;
+	const size_t iterations = 10;
+	std::vector<dual_quaternion<type>> bones(bone_count);
+	std::vector<matrix4x4<type>> matrices(bone_count);
+	for (size_t i = 0; i < bone_count; i++)
+	{
+		const quaternion<type> rotation = random_rotation<type>();
+		const vector3<type> translation = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+		bones[i] = dual_quaternion<type>(rotation, translation);
+		matrices[i] = rotation.to_matrix4x4();
+		matrices[i]._14 = translation.x;
+		matrices[i]._24 = translation.y;
+		matrices[i]._34 = translation.z;
+	}
+
+	std::vector<vector4<ushort>> indices(count);
+	std::vector<vector4<type>> weights(count);
+	std::vector<vector3<type>> positions(count), normals(count), skinned_positions(count), skinned_normals(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		ushort index[4];
+		for (size_t k = 0; k < 4; k++)
+		{
+			index[k] = static_cast<ushort>(arch::random(0.0, static_cast<double>(bone_count) - 0.5));
+		}
+		indices[i] = vector4<ushort>(index[0], index[1], index[2], index[3]);
+		const type a = arch::random(static_cast<type>(0.4), static_cast<type>(1.0));
+		const type b = (static_cast<type>(1.0) - a) * arch::random(static_cast<type>(0.0), static_cast<type>(1.0));
+		const type c = (static_cast<type>(1.0) - a - b) * arch::random(static_cast<type>(0.0), static_cast<type>(1.0));
+		weights[i] = vector4<type>(a, b, c, static_cast<type>(1.0) - a - b - c);
+		positions[i] = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+		normals[i] = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0)).normalized();
+	}
+	const soa_vector3<type> soa_positions(positions), soa_normals(normals);
+	soa_vector3<type> soa_skinned_positions(count), soa_skinned_normals(count);
+
+	std::string prefix = std::string(_type_name) + ".";
+	double reference, single, batch;
+
+	reference = bench::run(prefix + "matrix4x4.lbs", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			matrix4x4<type> blended = matrices[indices[i].x] * weights[i].x;
+			for (size_t k = 1; k < 4; k++)
+			{
+				blended += matrices[indices[i].data[k]] * weights[i].data[k];
+			}
+			skinned_positions[i] = blended.transform_point(positions[i]);
+			skinned_normals[i] = blended.transform_direction(normals[i]);
+		}
+		bench::do_not_optimize(skinned_positions);
+		bench::do_not_optimize(skinned_normals);
+	});
+	single = bench::run(prefix + "dual_quaternion.blend", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const dual_quaternion<type> blended = dual_quaternion<type>::blend(bones.data(), indices[i], weights[i]);
+			skinned_positions[i] = blended.transform_point(positions[i]);
+			skinned_normals[i] = blended.transform_direction(normals[i]);
+		}
+		bench::do_not_optimize(skinned_positions);
+		bench::do_not_optimize(skinned_normals);
+	});
+	batch = bench::run(prefix + "dual_quaternion::skin", iterations, count, [&]()
+	{
+		dual_quaternion<type>::skin(bones.data(), indices.data(), weights.data(), soa_positions, soa_normals, soa_skinned_positions, soa_skinned_normals);
+		bench::do_not_optimize(soa_skinned_positions);
+		bench::do_not_optimize(soa_skinned_normals);
+	});
+	std::cout << "  speedup x" << reference / batch << " (blend x" << single / batch << "), " << batch * count * 1e-6 << " ms/frame" << std::endl;
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
@@ -0,0 +1,89 @@
+// 1頂点4ボーンの線形混合スキニング(LBS)を、matrix4x4を1頂点ずつ重み付けして足し合わせる場合と、
+// bone_palette::skinで成分ごとの配列をまとめて変換する場合で比較します。ボーンは64/256個、頂点は1万/10万/200万個です。
+
+#include <vector>
+#include <arch/skinning.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> void run(const char* _type_name, size_t _bone_count, size_t _count)
+{
+	const size_t iterations = max(static_cast<size_t>(20000000) / _count, static_cast<size_t>(1));
+	std::vector<matrix4x4<type>> matrices(_bone_count);
+	for (size_t i = 0; i < _bone_count; i++)
+	{
+		const vector3<type> axis = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+		matrices[i] = matrix4x4<type>::rotation(axis.x, axis.y, axis.z);
+		matrices[i]._14 = arch::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+		matrices[i]._24 = arch::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+		matrices[i]._34 = arch::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+	}
+	const bone_palette<type> palette(matrices);
+
+	std::vector<vector4<ushort>> indices(_count);
+	std::vector<vector4<type>> weights(_count);
+	std::vector<vector3<type>> positions(_count), normals(_count), skinned_positions(_count), skinned_normals(_count);
+	for (size_t i = 0; i < _count; i++)
+	{
+		ushort index[4];
+		for (size_t k = 0; k < 4; k++)
+		{
+			index[k] = static_cast<ushort>(arch::random(0.0, static_cast<double>(_bone_count) - 0.5));
+		}
+		indices[i] = vector4<ushort>(index[0], index[1], index[2], index[3]);
+		const type a = arch::random(static_cast<type>(0.4), static_cast<type>(1.0));
+		const type b = (static_cast<type>(1.0) - a) * arch::random(static_cast<type>(0.0), static_cast<type>(1.0));
+		const type c = (static_cast<type>(1.0) - a - b) * arch::random(static_cast<type>(0.0), static_cast<type>(1.0));
+		weights[i] = vector4<type>(a, b, c, static_cast<type>(1.0) - a - b - c);
+		positions[i] = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+		normals[i] = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0)).normalized();
+	}
+	const soa_vector3<type> soa_positions(positions), soa_normals(normals);
+	soa_vector3<type> soa_skinned_positions(_count), soa_skinned_normals(_count);
+
+	const std::string prefix = std::string(_type_name) + "." + std::to_string(_bone_count) + "x" + std::to_string(_count) + ".";
+	double reference, result;
+
+	reference = bench::run(prefix + "matrix4x4", iterations, _count, [&]()
+	{
+		for (size_t i = 0; i < _count; i++)
+		{
+			matrix4x4<type> blended = matrices[indices[i].x] * weights[i].x;
+			for (size_t k = 1; k < 4; k++)
+			{
+				blended += matrices[indices[i].data[k]] * weights[i].data[k];
+			}
+			skinned_positions[i] = blended.transform_point(positions[i]);
+			skinned_normals[i] = blended.transform_direction(normals[i]);
+		}
+		bench::do_not_optimize(skinned_positions);
+		bench::do_not_optimize(skinned_normals);
+	});
+	result = bench::run(prefix + "bone_palette::skin", iterations, _count, [&]()
+	{
+		palette.skin(indices.data(), weights.data(), soa_positions, soa_normals, soa_skinned_positions, soa_skinned_normals);
+		bench::do_not_optimize(soa_skinned_positions);
+		bench::do_not_optimize(soa_skinned_normals);
+	});
+	std::cout << "  speedup x" << reference / result << ", " << result * _count * 1e-6 << " ms/frame" << std::endl;
+}
+
+template<class type> void run(const char* _type_name)
+{
+	for (size_t bone_count : { 64, 256 })
+	{
+		for (size_t count : { 10000, 100000, 2000000 })
+		{
+			run<type>(_type_name, bone_count, count);
+		}
+	}
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
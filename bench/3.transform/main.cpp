@@ -0,0 +1,95 @@
+// matrix4x4/matrix3x3の1要素ずつのtransformと、配列を渡す一括transformを比較します。
+
+#include <vector>
+#include <arch/matrix3x3.h>
+#include <arch/matrix4x4.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 16384;
+	const size_t iterations = 1000;
+	std::vector<vector3<type>> input(count), output(count);
+	std::vector<vector4<type>> input4(count), output4(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		input[i] = vector3<type>::random(static_cast<type>(-1.0), static_cast<type>(1.0));
+		input4[i] = vector4<type>(input[i], static_cast<type>(1.0));
+	}
+	matrix4x4<type> matrix4 = matrix4x4<type>::rotation(static_cast<type>(0.1), static_cast<type>(0.2), static_cast<type>(0.3));
+	matrix4._14 = static_cast<type>(1.0);
+	matrix3x3<type> matrix3 = matrix3x3<type>::rotation(static_cast<type>(0.1), static_cast<type>(0.2), static_cast<type>(0.3));
+
+	std::string prefix = std::string(_type_name) + ".";
+	double single, batch;
+
+	single = bench::run(prefix + "4x4.transform_point", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			output[i] = matrix4.transform_point(input[i]);
+		}
+		bench::do_not_optimize(output);
+	});
+	batch = bench::run(prefix + "4x4.transform_point[]", iterations, count, [&]()
+	{
+		matrix4.transform_point(input.data(), output.data(), count);
+		bench::do_not_optimize(output);
+	});
+	std::cout << "  speedup x" << single / batch << std::endl;
+
+	single = bench::run(prefix + "4x4.transform_homogeneous", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			output[i] = matrix4.transform_homogeneous(input[i]);
+		}
+		bench::do_not_optimize(output);
+	});
+	batch = bench::run(prefix + "4x4.transform_homogeneous[]", iterations, count, [&]()
+	{
+		matrix4.transform_homogeneous(input.data(), output.data(), count);
+		bench::do_not_optimize(output);
+	});
+	std::cout << "  speedup x" << single / batch << std::endl;
+
+	single = bench::run(prefix + "4x4.transform4", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			output4[i] = matrix4.transform(input4[i]);
+		}
+		bench::do_not_optimize(output4);
+	});
+	batch = bench::run(prefix + "4x4.transform4[]", iterations, count, [&]()
+	{
+		matrix4.transform(input4.data(), output4.data(), count);
+		bench::do_not_optimize(output4);
+	});
+	std::cout << "  speedup x" << single / batch << std::endl;
+
+	single = bench::run(prefix + "3x3.transform", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			output[i] = matrix3.transform(input[i]);
+		}
+		bench::do_not_optimize(output);
+	});
+	batch = bench::run(prefix + "3x3.transform[]", iterations, count, [&]()
+	{
+		matrix3.transform(input.data(), output.data(), count);
+		bench::do_not_optimize(output);
+	});
+	std::cout << "  speedup x" << single / batch << std::endl;
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << ", threads: " << thread_pool::shared().size() + 1 << std::endl;
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
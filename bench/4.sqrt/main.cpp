@@ -0,0 +1,133 @@
+// 定数式向けのnewton_sqrtと、実行時のsqrt(sqrtss/sqrtsd)およびrsqrtによる正規化を比較します。
+
+#include <vector>
+#include <arch/soa_vector.h>
+#include <arch/vector.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 4096;
+	const size_t iterations = 500;
+	std::vector<type> values(count), results(count);
+	std::vector<vector3<type>> a(count), b(count), normals(count);
+	std::vector<vector4<type>> a4(count), normals4(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		values[i] = random<type>(static_cast<type>(0.0), static_cast<type>(1000.0));
+		a[i] = vector3<type>::random(static_cast<type>(-10.0), static_cast<type>(10.0));
+		b[i] = vector3<type>::random(static_cast<type>(-10.0), static_cast<type>(10.0));
+		a4[i] = vector4<type>::random(static_cast<type>(-10.0), static_cast<type>(10.0));
+	}
+	soa_vector3<type> soa(a.data(), count);
+
+	std::string prefix = std::string(_type_name) + ".";
+	double newton, hardware;
+
+	newton = bench::run(prefix + "newton_sqrt", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			results[i] = newton_sqrt(values[i]);
+		}
+		bench::do_not_optimize(results);
+	});
+	hardware = bench::run(prefix + "sqrt", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			results[i] = sqrt(values[i]);
+		}
+		bench::do_not_optimize(results);
+	});
+	std::cout << "  speedup x" << newton / hardware << std::endl;
+
+	newton = bench::run(prefix + "vector3.length(newton)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			results[i] = newton_sqrt(a[i].squared_length());
+		}
+		bench::do_not_optimize(results);
+	});
+	hardware = bench::run(prefix + "vector3.length", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			results[i] = a[i].length();
+		}
+		bench::do_not_optimize(results);
+	});
+	std::cout << "  speedup x" << newton / hardware << std::endl;
+
+	newton = bench::run(prefix + "vector3.distance(newton)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			results[i] = newton_sqrt(a[i].squared_distance(b[i]));
+		}
+		bench::do_not_optimize(results);
+	});
+	hardware = bench::run(prefix + "vector3.distance", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			results[i] = a[i].distance(b[i]);
+		}
+		bench::do_not_optimize(results);
+	});
+	std::cout << "  speedup x" << newton / hardware << std::endl;
+
+	newton = bench::run(prefix + "vector3.normalized(newton)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			normals[i] = a[i] / newton_sqrt(a[i].squared_length());
+		}
+		bench::do_not_optimize(normals);
+	});
+	hardware = bench::run(prefix + "vector3.normalized", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			normals[i] = a[i].normalized();
+		}
+		bench::do_not_optimize(normals);
+	});
+	std::cout << "  speedup x" << newton / hardware << std::endl;
+
+	newton = bench::run(prefix + "vector4.normalized(divide)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			normals4[i] = a4[i] / a4[i].length();
+		}
+		bench::do_not_optimize(normals4);
+	});
+	hardware = bench::run(prefix + "vector4.normalized", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			normals4[i] = a4[i].normalized();
+		}
+		bench::do_not_optimize(normals4);
+	});
+	std::cout << "  speedup x" << newton / hardware << std::endl;
+
+	bench::run(prefix + "soa_vector3.normalize", iterations, count, [&]()
+	{
+		soa.assign(a.data(), count);
+		soa.normalize();
+		bench::do_not_optimize(soa);
+	});
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
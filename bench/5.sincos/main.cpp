@@ -0,0 +1,108 @@
+// std::sin/std::cosとarch::sincos、およびオイラー角から回転行列・クォータニオンを作る処理を比較します。
+
+#include <vector>
+#include <arch/matrix4x4.h>
+#include <arch/quaternion.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 4096;
+	const size_t iterations = 500;
+	std::vector<type> roll(count), pitch(count), yaw(count), sin(count), cos(count);
+	std::vector<vector3<type>> angles(count);
+	std::vector<matrix4x4<type>> matrices(count);
+	std::vector<quaternion<type>> quaternions(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		roll[i] = random<type>(static_cast<type>(-4.0), static_cast<type>(4.0));
+		pitch[i] = random<type>(static_cast<type>(-4.0), static_cast<type>(4.0));
+		yaw[i] = random<type>(static_cast<type>(-4.0), static_cast<type>(4.0));
+		angles[i] = vector3<type>(roll[i], pitch[i], yaw[i]);
+	}
+
+	std::string prefix = std::string(_type_name) + ".";
+	double reference, batch;
+
+	reference = bench::run(prefix + "std::sin+std::cos", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			sin[i] = std::sin(roll[i]);
+			cos[i] = std::cos(roll[i]);
+		}
+		bench::do_not_optimize(sin);
+		bench::do_not_optimize(cos);
+	});
+	bench::run(prefix + "sincos", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			sincos(roll[i], sin[i], cos[i]);
+		}
+		bench::do_not_optimize(sin);
+		bench::do_not_optimize(cos);
+	});
+	batch = bench::run(prefix + "sincos[]", iterations, count, [&]()
+	{
+		sincos(roll.data(), sin.data(), cos.data(), count);
+		bench::do_not_optimize(sin);
+		bench::do_not_optimize(cos);
+	});
+	std::cout << "  speedup x" << reference / batch << std::endl;
+
+	reference = bench::run(prefix + "matrix4x4::rotation(std)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			matrix4x4<type> m = matrix4x4<type>::identity();
+			const type sr = std::sin(roll[i]), cr = std::cos(roll[i]);
+			const type sp = std::sin(pitch[i]), cp = std::cos(pitch[i]);
+			const type sy = std::sin(yaw[i]), cy = std::cos(yaw[i]);
+			m._11 = sy * sp * sr + cy * cr; m._12 = sy * sp * cr - cy * sr; m._13 = sy * cp;
+			m._21 = cp * sr; m._22 = cp * cr; m._23 = -sp;
+			m._31 = cy * sp * sr - sy * cr; m._32 = cy * sp * cr + sy * sr; m._33 = cy * cp;
+			matrices[i] = m;
+		}
+		bench::do_not_optimize(matrices);
+	});
+	bench::run(prefix + "matrix4x4::rotation", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			matrices[i] = matrix4x4<type>::rotation(roll[i], pitch[i], yaw[i]);
+		}
+		bench::do_not_optimize(matrices);
+	});
+	batch = bench::run(prefix + "matrix4x4::rotation[]", iterations, count, [&]()
+	{
+		matrix4x4<type>::rotation(roll.data(), pitch.data(), yaw.data(), matrices.data(), count);
+		bench::do_not_optimize(matrices);
+	});
+	std::cout << "  speedup x" << reference / batch << std::endl;
+
+	reference = bench::run(prefix + "quaternion(angles)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			quaternions[i] = quaternion<type>(angles[i]);
+		}
+		bench::do_not_optimize(quaternions);
+	});
+	batch = bench::run(prefix + "quaternion::rotation[]", iterations, count, [&]()
+	{
+		quaternion<type>::rotation(angles.data(), quaternions.data(), count);
+		bench::do_not_optimize(quaternions);
+	});
+	std::cout << "  speedup x" << reference / batch << std::endl;
+}
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
@@ -0,0 +1,64 @@
+// std::powとarch::pow(x, int)、arch::ipow<N>の整数乗を比較します。
+
+#include <cmath>
+#include <vector>
+#include <arch/functions.h>
+#include <arch/random.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class type> void run(const char* _type_name)
+{
+	const size_t count = 4096;
+	const size_t iterations = 2000;
+	std::vector<type> x(count), result(count);
+	std::vector<int> exponents(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		x[i] = random<type>(static_cast<type>(0.5), static_cast<type>(2.0));
+		exponents[i] = static_cast<int>(i % 25) - 12;
+	}
+
+	std::string prefix = std::string(_type_name) + ".";
+
+	bench::run(prefix + "std::pow(x, y)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = std::pow(x[i], static_cast<type>(exponents[i]));
+		}
+		bench::do_not_optimize(result);
+	});
+	bench::run(prefix + "pow(x, int)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = pow(x[i], exponents[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+	bench::run(prefix + "std::pow(x, 12)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = std::pow(x[i], static_cast<type>(12.0));
+		}
+		bench::do_not_optimize(result);
+	});
+	bench::run(prefix + "ipow<12>(x)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			result[i] = ipow<12>(x[i]);
+		}
+		bench::do_not_optimize(result);
+	});
+}
+
+int main()
+{
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
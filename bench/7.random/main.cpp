@@ -0,0 +1,71 @@
+// スレッド数を増やしながら乱数の生成速度を計測します。
+// shared は1つのエンジンをミューテックスで共有した場合、thread_local はスレッドごとのエンジンを使った場合です。
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <arch/vector.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+template<class function_type> double run_threads(const std::string& _name, size_t _thread_count, size_t _count, function_type _function)
+{
+	return bench::run(_name, 10, _count * _thread_count, [&]()
+	{
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < _thread_count; t++)
+		{
+			threads.emplace_back([&]() { _function(_count); });
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	});
+}
+
+int main()
+{
+	const size_t count = 1 << 18;
+	size_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+	random_engine shared_engine;
+	std::mutex mutex;
+
+	std::cout << "hardware threads: " << hardware << std::endl;
+	for (size_t threads = 1; threads <= hardware * 2; threads *= 2)
+	{
+		std::string suffix = "(" + std::to_string(threads) + ")";
+		double shared = run_threads("shared" + suffix, threads, count, [&](size_t _count)
+		{
+			float sum = 0.0f;
+			for (size_t i = 0; i < _count; i++)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				sum += random(shared_engine, 0.0f, 1.0f);
+			}
+			bench::do_not_optimize(sum);
+		});
+		double local = run_threads("thread_local" + suffix, threads, count, [&](size_t _count)
+		{
+			float sum = 0.0f;
+			for (size_t i = 0; i < _count; i++)
+			{
+				sum += random(0.0f, 1.0f);
+			}
+			bench::do_not_optimize(sum);
+		});
+		run_threads("vector3::random" + suffix, threads, count / 4, [&](size_t _count)
+		{
+			random_engine& engine = get_default_random_engine();
+			float3 sum = float3::zero();
+			for (size_t i = 0; i < _count; i++)
+			{
+				sum += float3::random(engine, 0.0f, 1.0f);
+			}
+			bench::do_not_optimize(sum);
+		});
+		std::cout << "  speedup x" << shared / local << std::endl;
+	}
+	return 0;
+}
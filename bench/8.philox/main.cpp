@@ -0,0 +1,53 @@
+// mt19937_64とphilox4x32の32ビット値の生成速度を比較します。
+// parallel_forは分割数に関係なく、同じ(シード, ストリーム, カウンタ)から同じ値を生成します。
+
+#include <vector>
+#include <arch/parallel.h>
+#include <arch/philox.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	const size_t count = 1 << 16;
+	const size_t iterations = 200;
+	std::vector<uint32_t> values(count);
+
+	random_engine mt;
+	bench::run("mt19937_64()", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			values[i] = static_cast<uint32_t>(mt());
+		}
+		bench::do_not_optimize(values);
+	});
+
+	philox4x32 philox(1);
+	bench::run("philox4x32()", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			values[i] = philox();
+		}
+		bench::do_not_optimize(values);
+	});
+	bench::run("philox4x32::generate", iterations, count, [&]()
+	{
+		philox.generate(values.data(), count);
+		bench::do_not_optimize(values);
+	});
+
+	bench::run("philox4x32::generate(parallel)", iterations, count, [&]()
+	{
+		parallel_for(count / 4, 1024, [&](size_t _begin, size_t _end)
+		{
+			philox4x32 engine(1, 0, _begin);
+			engine.generate(values.data() + _begin * 4, (_end - _begin) * 4);
+		});
+		bench::do_not_optimize(values);
+	});
+	return 0;
+}
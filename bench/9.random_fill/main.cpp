@@ -0,0 +1,45 @@
+// vector3::randomを1個ずつ呼ぶ場合とrandom_fillでまとめて生成する場合を比較します。
+
+#include <vector>
+#include <arch/random_fill.h>
+#include "../benchmark.h"
+
+using namespace arch;
+
+int main()
+{
+	std::cout << "simd: " << ARCH_SIMD_NAME << std::endl;
+	const size_t count = 1 << 16;
+	const size_t iterations = 100;
+	std::vector<float3> points(count);
+	std::vector<float> values(count * 3);
+	random_engine mt;
+	philox4x32 philox(1);
+
+	double reference = bench::run("float3::random(mt19937_64)", iterations, count, [&]()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			points[i] = float3::random(mt, -1.0f, 1.0f);
+		}
+		bench::do_not_optimize(points);
+	});
+	bench::run("random_fill(mt19937_64, float3)", iterations, count, [&]()
+	{
+		random_fill(mt, points.data(), count, -1.0f, 1.0f);
+		bench::do_not_optimize(points);
+	});
+	double batch = bench::run("random_fill(philox4x32, float3)", iterations, count, [&]()
+	{
+		random_fill(philox, points.data(), count, -1.0f, 1.0f);
+		bench::do_not_optimize(points);
+	});
+	std::cout << "  speedup x" << reference / batch << std::endl;
+
+	bench::run("random_fill(philox4x32, float)", iterations, count * 3, [&]()
+	{
+		random_fill(philox, values.data(), values.size(), 0.0f, 1.0f);
+		bench::do_not_optimize(values);
+	});
+	return 0;
+}
@@ -0,0 +1,130 @@
+//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace bench
+{
+
+/*!
+*	@brief 計算結果を使用済みとして扱い、最適化による削除を防ぎます。
+*/
+template<class type> inline void do_not_optimize(const type& _value)
+{
+#if defined(_MSC_VER)
+	static_cast<void>(&_value);
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "g"(&_value) : "memory");
+#endif
+}
+
+/*!
+*	@brief 1件の計測結果です。
+*/
+struct result
+{
+	std::string name;
+	size_t iterations;
+	size_t operations;
+	double nanoseconds;	///< 1演算あたりのナノ秒
+	double gigabytes_per_second;	///< 1演算で読み書きするバイト数を指定しなかった場合は0
+};
+
+/*!
+*	@brief これまでのrunの結果です。write_jsonで書き出します。
+*/
+inline std::vector<result>& results()
+{
+	static std::vector<result> list;
+	return list;
+}
+
+/*!
+*	@brief _functionを_iterations回実行し、1回あたりのナノ秒と転送量を表示します。
+*	@param [in]	_operations	1回の実行に含まれる演算数
+*	@param [in]	_bytes	1演算で読み書きするバイト数
+*/
+template<class function_type> inline double run(const std::string& _name, size_t _iterations, size_t _operations, size_t _bytes, function_type _function)
+{
+	_function();
+
+	auto begin = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < _iterations; i++)
+	{
+		_function();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	double nanoseconds = std::chrono::duration<double, std::nano>(end - begin).count();
+	double per_operation = nanoseconds / static_cast<double>(_iterations * _operations);
+	double gigabytes_per_second = static_cast<double>(_bytes) / per_operation;
+	std::cout << std::left << std::setw(40) << _name << std::right << std::setw(12) << std::fixed << std::setprecision(3) << per_operation << " ns/op";
+	if (_bytes > 0)
+	{
+		std::cout << std::setw(12) << gigabytes_per_second << " GB/s";
+	}
+	std::cout << std::endl;
+
+	results().push_back(result{ _name, _iterations, _operations, per_operation, gigabytes_per_second });
+	return per_operation;
+}
+
+/*!
+*	@brief _functionを_iterations回実行し、1回あたりのナノ秒を表示します。
+*	@param [in]	_operations	1回の実行に含まれる演算数
+*/
+template<class function_type> inline double run(const std::string& _name, size_t _iterations, size_t _operations, function_type _function)
+{
+	return run(_name, _iterations, _operations, 0, _function);
+}
+
+/*!
+*	@brief これまでの結果をJSONで書き出します。
+*/
+inline void write_json(std::ostream& _stream, const std::string& _context)
+{
+	_stream << "{\n\t\"context\": \"" << _context << "\",\n\t\"benchmarks\": [";
+	const char* separator = "\n";
+	for (const auto& r : results())
+	{
+		_stream << separator << "\t\t{ \"name\": \"" << r.name << "\", \"iterations\": " << r.iterations << ", \"operations\": " << r.operations
+			<< std::setprecision(6) << ", \"ns_per_op\": " << r.nanoseconds << ", \"gb_per_s\": " << r.gigabytes_per_second << " }";
+		separator = ",\n";
+	}
+	_stream << "\n\t]\n}\n";
+}
+
+inline bool write_json(const std::string& _path, const std::string& _context)
+{
+	std::ofstream stream(_path);
+	if (!stream)
+	{
+		return false;
+	}
+	write_json(stream, _context);
+	return true;
+}
+
+}
@@ -0,0 +1,85 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace arch
+{
+
+/*!
+*	@brief 先頭アドレスを_alignmentバイト境界に揃えて確保するアロケータです。
+*	既定値の64はキャッシュラインとAVX-512レジスタの幅に合わせています。
+*/
+template<class type, size_t alignment = 64>
+class aligned_allocator
+{
+public:
+	static_assert((alignment & (alignment - 1)) == 0, "alignment must be a power of two.");
+
+	typedef type value_type;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+	typedef type* pointer;
+	typedef const type* const_pointer;
+	typedef type& reference;
+	typedef const type& const_reference;
+
+	template<class other_type> struct rebind
+	{
+		typedef aligned_allocator<other_type, alignment> other;
+	};
+
+public:
+	aligned_allocator() = default;
+
+	template<class other_type> aligned_allocator(const aligned_allocator<other_type, alignment>&) noexcept
+	{
+	}
+
+	pointer allocate(size_type _count)
+	{
+		size_type bytes = _count * sizeof(value_type) + alignment + sizeof(void*);
+		void* block = std::malloc(bytes);
+		if (block == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		uintptr_t address = (reinterpret_cast<uintptr_t>(block) + sizeof(void*) + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+		reinterpret_cast<void**>(address)[-1] = block;
+		return reinterpret_cast<pointer>(address);
+	}
+
+	void deallocate(pointer _pointer, size_type)
+	{
+		if (_pointer != nullptr)
+		{
+			std::free(reinterpret_cast<void**>(_pointer)[-1]);
+		}
+	}
+};
+
+template<class type, class other_type, size_t alignment> inline bool operator==(const aligned_allocator<type, alignment>&, const aligned_allocator<other_type, alignment>&)
+{
+	return true;
+}
+
+template<class type, class other_type, size_t alignment> inline bool operator!=(const aligned_allocator<type, alignment>&, const aligned_allocator<other_type, alignment>&)
+{
+	return false;
+}
+
+}
@@ -0,0 +1,570 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "dynamic_matrix.h"
+#include "functions.h"
+
+namespace arch
+{
+
+/*!
+*	@brief 正方行列のLU分解、コレスキー分解と、長方形行列のハウスホルダーQR分解です。
+*	分解は与えた行列の領域に上書きし、solveは右辺の行列の各列を同時に解きます。
+*	block_sizeより大きい行列はblock_size列ずつ分解し、残りの更新をgemmで行います。
+*/
+template<class type>
+class decomposition_kernel
+{
+public:
+	typedef type value_type;
+	typedef size_t size_type;
+	typedef matrix_view<value_type> view_type;
+	typedef matrix_view<const value_type> const_view_type;
+	typedef vector_view<value_type> vector_type;
+	typedef vector_view<const value_type> const_vector_type;
+
+	static const size_type block_size = 64;	///< 分解をブロック単位に切り替える行数
+
+public:
+	/*!
+	*	@brief 部分ピボット選択付きのLU分解PA = LUを求めます。
+	*	_aの対角より下に単位下三角行列Lの対角以外を、対角以上に上三角行列Uを書き込みます。
+	*	_pivotsには行数分の領域が必要で、i行目を_pivots[i]行目と入れ替えたことを0行目から順に記録します。
+	*	@return ピボットが0になった(Aが特異な)場合はfalse。分解は最後まで行います。
+	*/
+	static bool lu(view_type _a, size_type* _pivots)
+	{
+		assert(_a.rows() == _a.columns());
+		const size_type size = _a.rows();
+		if (size <= block_size)
+		{
+			return lu_unblocked(_a, _pivots);
+		}
+
+		bool regular = true;
+		for (size_type k = 0; k < size; k += block_size)
+		{
+			const size_type width = min(block_size, size - k);
+			const size_type rest = size - k - width;
+			if (!lu_unblocked(_a.block(k, k, size - k, width), _pivots + k))
+			{
+				regular = false;
+			}
+			for (size_type i = k; i < k + width; i++)
+			{
+				_pivots[i] += k;
+				swap_rows(_a.block(0, 0, size, k), i, _pivots[i]);
+				swap_rows(_a.block(0, k + width, size, rest), i, _pivots[i]);
+			}
+			if (rest > 0)
+			{
+				view_type a12 = _a.block(k, k + width, width, rest);
+				solve_lower(_a.block(k, k, width, width), true, a12);
+				multiply_subtract(_a.block(k + width, k, rest, width), a12, _a.block(k + width, k + width, rest, rest));
+			}
+		}
+		return regular;
+	}
+
+	///	<summary>ブロック化しないLU分解です。_aは行数が列数以上の長方形でも構いません。</summary>
+	static bool lu_unblocked(view_type _a, size_type* _pivots)
+	{
+		const size_type rows = _a.rows();
+		const size_type columns = _a.columns();
+		bool regular = true;
+		for (size_type j = 0; j < min(rows, columns); j++)
+		{
+			size_type pivot = j;
+			value_type largest = std::abs(_a(j, j));
+			for (size_type i = j + 1; i < rows; i++)
+			{
+				const value_type value = std::abs(_a(i, j));
+				if (value > largest)
+				{
+					largest = value;
+					pivot = i;
+				}
+			}
+			_pivots[j] = pivot;
+			swap_rows(_a, j, pivot);
+			if (largest == static_cast<value_type>(0))
+			{
+				regular = false;
+				continue;
+			}
+
+			const value_type reciprocal = static_cast<value_type>(1) / _a(j, j);
+			for (size_type i = j + 1; i < rows; i++)
+			{
+				_a(i, j) *= reciprocal;
+			}
+			if (j + 1 < columns)
+			{
+				ger(static_cast<value_type>(-1), _a.column(j).segment(j + 1, rows - j - 1), _a.row(j).segment(j + 1, columns - j - 1), _a.block(j + 1, j + 1, rows - j - 1, columns - j - 1));
+			}
+		}
+		return regular;
+	}
+
+	///	<summary>luの結果でAX = Bを解き、_bをXで上書きします。</summary>
+	static void lu_solve(const_view_type _lu, const size_type* _pivots, view_type _b)
+	{
+		assert(_lu.rows() == _lu.columns() && _lu.rows() == _b.rows());
+		for (size_type i = 0; i < _lu.rows(); i++)
+		{
+			swap_rows(_b, i, _pivots[i]);
+		}
+		solve_lower(_lu, true, _b);
+		solve_upper(_lu, false, _b);
+	}
+
+	///	<summary>luの結果から行列式を求めます。</summary>
+	static value_type lu_determinant(const_view_type _lu, const size_type* _pivots)
+	{
+		value_type result = static_cast<value_type>(1);
+		for (size_type i = 0; i < _lu.rows(); i++)
+		{
+			result *= (_pivots[i] == i) ? _lu(i, i) : -_lu(i, i);
+		}
+		return result;
+	}
+
+	/*!
+	*	@brief 対称正定値行列のコレスキー分解A = LL^Tを求め、_aの対角以下にLを書き込みます。
+	*	対角より上の要素は読まず、分解後の内容は不定です。
+	*	@return 正定値でない場合はfalse。_aは途中まで書き換えられています。
+	*/
+	static bool cholesky(view_type _a)
+	{
+		assert(_a.rows() == _a.columns() && _a.is_symmetric());
+		const size_type size = _a.rows();
+		if (size <= block_size)
+		{
+			return cholesky_unblocked(_a);
+		}
+
+		for (size_type k = 0; k < size; k += block_size)
+		{
+			const size_type width = min(block_size, size - k);
+			const size_type rest = size - k - width;
+			if (!cholesky_unblocked(_a.block(k, k, width, width)))
+			{
+				return false;
+			}
+			if (rest == 0)
+			{
+				continue;
+			}
+
+			// A21 = A21 L11^-T。A21の各行は連続しているので、1行ずつ前進代入します。
+			const_view_type l11 = _a.block(k, k, width, width);
+			view_type a21 = _a.block(k + width, k, rest, width);
+			for (size_type i = 0; i < rest; i++)
+			{
+				solve_lower(l11, false, a21.block(i, 0, 1, width).transposed());
+			}
+			// A22 -= A21 A21^T。下三角に掛かる列ブロックだけを更新します。
+			for (size_type j = 0; j < rest; j += block_size)
+			{
+				const size_type columns = min(block_size, rest - j);
+				multiply_subtract(a21.block(j, 0, rest - j, width), a21.block(j, 0, columns, width).transposed(), _a.block(k + width + j, k + width + j, rest - j, columns));
+			}
+		}
+		return true;
+	}
+
+	///	<summary>ブロック化しないコレスキー分解です。各要素を行の連続した部分の内積で求めます。</summary>
+	static bool cholesky_unblocked(view_type _a)
+	{
+		const size_type size = _a.rows();
+		for (size_type j = 0; j < size; j++)
+		{
+			const vector_type row = _a.row(j).segment(0, j);
+			const value_type diagonal = _a(j, j) - dot(row, row);
+			if (!(diagonal > static_cast<value_type>(0)))
+			{
+				return false;
+			}
+			_a(j, j) = std::sqrt(diagonal);
+
+			const value_type reciprocal = static_cast<value_type>(1) / _a(j, j);
+			for (size_type i = j + 1; i < size; i++)
+			{
+				_a(i, j) = (_a(i, j) - dot(_a.row(i).segment(0, j), row)) * reciprocal;
+			}
+		}
+		return true;
+	}
+
+	///	<summary>choleskyの結果でAX = Bを解き、_bをXで上書きします。</summary>
+	static void cholesky_solve(const_view_type _l, view_type _b)
+	{
+		assert(_l.rows() == _l.columns() && _l.rows() == _b.rows());
+		solve_lower(_l, false, _b);
+		solve_upper(_l.transposed(), false, _b);
+	}
+
+	/*!
+	*	@brief ハウスホルダー変換によるQR分解A = QRを求めます。_aは行数が列数以上でなければなりません。
+	*	_aの対角以上にRを、対角より下にj列目の反射ベクトルv_j(先頭の1を除く)を書き込みます。
+	*	Q = H_0 H_1 ... H_(n-1)、H_j = I - tau_j v_j v_j^Tで、_tauには列数分の領域が必要です。
+	*/
+	static void qr(view_type _a, value_type* _tau)
+	{
+		assert(_a.rows() >= _a.columns());
+		const size_type rows = _a.rows();
+		const size_type columns = _a.columns();
+		if (columns <= block_size)
+		{
+			qr_unblocked(_a, _tau);
+			return;
+		}
+
+		for (size_type k = 0; k < columns; k += block_size)
+		{
+			const size_type width = min(block_size, columns - k);
+			view_type panel = _a.block(k, k, rows - k, width);
+			qr_unblocked(panel, _tau + k);
+			if (k + width < columns)
+			{
+				apply_block_reflector(panel, _tau + k, _a.block(k, k + width, rows - k, columns - k - width));
+			}
+		}
+	}
+
+	///	<summary>ブロック化しないQR分解です。</summary>
+	static void qr_unblocked(view_type _a, value_type* _tau)
+	{
+		const size_type rows = _a.rows();
+		const size_type columns = _a.columns();
+		for (size_type j = 0; j < columns; j++)
+		{
+			vector_type v = _a.column(j).segment(j, rows - j);
+			_tau[j] = householder(v);
+			if (j + 1 < columns)
+			{
+				apply_reflector(v, _tau[j], _a.block(j, j + 1, rows - j, columns - j - 1));
+			}
+		}
+	}
+
+	/*!
+	*	@brief qrの結果で最小二乗解min |AX - B|を求めます。
+	*	_bはAと同じ行数で、先頭のAの列数行をXで、残りの行を残差にQ^Tを掛けたもので上書きします。
+	*	Aは列フルランクでなければなりません。
+	*/
+	static void qr_solve(const_view_type _qr, const value_type* _tau, view_type _b)
+	{
+		assert(_qr.rows() == _b.rows());
+		const size_type rows = _qr.rows();
+		const size_type columns = _qr.columns();
+		if (columns <= block_size)
+		{
+			for (size_type j = 0; j < columns; j++)
+			{
+				apply_reflector(_qr.column(j).segment(j, rows - j), _tau[j], _b.block(j, 0, rows - j, _b.columns()));
+			}
+		}
+		else
+		{
+			for (size_type k = 0; k < columns; k += block_size)
+			{
+				const size_type width = min(block_size, columns - k);
+				apply_block_reflector(_qr.block(k, k, rows - k, width), _tau + k, _b.block(k, 0, rows - k, _b.columns()));
+			}
+		}
+		solve_upper(_qr.block(0, 0, columns, columns), false, _b.block(0, 0, columns, _b.columns()));
+	}
+
+	/*!
+	*	@brief 下三角行列_lでLX = Bを解き、_bをXで上書きします。_unitがtrueの場合は対角を1とみなします。
+	*	対角ブロックを前進代入し、その下の行の更新をgemmで行います。
+	*/
+	static void solve_lower(const_view_type _l, bool _unit, view_type _b)
+	{
+		const size_type size = _l.rows();
+		const size_type columns = _b.columns();
+		for (size_type k = 0; k < size; k += block_size)
+		{
+			const size_type width = min(block_size, size - k);
+			for (size_type i = k; i < k + width; i++)
+			{
+				if (columns == 1)
+				{
+					value_type& x = _b(i, 0);
+					x -= dot(_l.row(i).segment(k, i - k), _b.column(0).segment(k, i - k));
+					if (!_unit)
+					{
+						x /= _l(i, i);
+					}
+					continue;
+				}
+				const vector_type row = _b.row(i);
+				for (size_type j = k; j < i; j++)
+				{
+					axpy(-_l(i, j), _b.row(j), row);
+				}
+				if (!_unit)
+				{
+					scale(row, static_cast<value_type>(1) / _l(i, i));
+				}
+			}
+			if (k + width < size)
+			{
+				multiply_subtract(_l.block(k + width, k, size - k - width, width), _b.block(k, 0, width, columns), _b.block(k + width, 0, size - k - width, columns));
+			}
+		}
+	}
+
+	///	<summary>上三角行列_uでUX = Bを解き、_bをXで上書きします。_unitがtrueの場合は対角を1とみなします。</summary>
+	static void solve_upper(const_view_type _u, bool _unit, view_type _b)
+	{
+		const size_type size = _u.rows();
+		const size_type columns = _b.columns();
+		for (size_type end = size; end > 0;)
+		{
+			const size_type width = min(block_size, end);
+			const size_type k = end - width;
+			for (size_type i = end; i-- > k;)
+			{
+				if (columns == 1)
+				{
+					value_type& x = _b(i, 0);
+					x -= dot(_u.row(i).segment(i + 1, end - i - 1), _b.column(0).segment(i + 1, end - i - 1));
+					if (!_unit)
+					{
+						x /= _u(i, i);
+					}
+					continue;
+				}
+				const vector_type row = _b.row(i);
+				for (size_type j = i + 1; j < end; j++)
+				{
+					axpy(-_u(i, j), _b.row(j), row);
+				}
+				if (!_unit)
+				{
+					scale(row, static_cast<value_type>(1) / _u(i, i));
+				}
+			}
+			if (k > 0)
+			{
+				multiply_subtract(_u.block(0, k, k, width), _b.block(k, 0, width, columns), _b.block(0, 0, k, columns));
+			}
+			end = k;
+		}
+	}
+
+private:
+	typedef dynamic_matrix<value_type> workspace_type;
+
+	///	<summary>分解の途中で使うスレッドごとの作業領域です。</summary>
+	template<size_t index> static workspace_type& workspace()
+	{
+		static thread_local workspace_type data;
+		return data;
+	}
+
+	static void swap_rows(view_type _a, size_type _i, size_type _j)
+	{
+		if (_i == _j)
+		{
+			return;
+		}
+		if (_a.column_stride() == 1)
+		{
+			std::swap_ranges(&_a(_i, 0), &_a(_i, 0) + _a.columns(), &_a(_j, 0));
+			return;
+		}
+		for (size_type column = 0; column < _a.columns(); column++)
+		{
+			std::swap(_a(_i, column), _a(_j, column));
+		}
+	}
+
+	static void scale(const vector_type& _x, value_type _value)
+	{
+		for (size_type i = 0; i < _x.size(); i++)
+		{
+			_x[i] *= _value;
+		}
+	}
+
+	///	<summary>C -= AB。右辺が1列の場合はgemvで求めます。</summary>
+	static void multiply_subtract(const_view_type _a, const_view_type _b, view_type _c)
+	{
+		if (_c.columns() == 1)
+		{
+			gemv(static_cast<value_type>(-1), _a, _b.column(0), static_cast<value_type>(1), _c.column(0));
+			return;
+		}
+		gemm(static_cast<value_type>(-1), _a, _b, static_cast<value_type>(1), _c);
+	}
+
+	/*!
+	*	@brief (I - tau v v^T)x = (beta, 0, ..., 0)^Tとなる反射を求めます。
+	*	_xの先頭をbeta、残りをv(先頭を1とした残り)で上書きし、tauを返します。
+	*/
+	static value_type householder(const vector_type& _x)
+	{
+		const value_type alpha = _x[0];
+		const value_type norm = nrm2(_x.segment(1, _x.size() - 1));
+		if (norm == static_cast<value_type>(0))
+		{
+			return static_cast<value_type>(0);
+		}
+
+		const value_type beta = (alpha >= static_cast<value_type>(0)) ? -std::hypot(alpha, norm) : std::hypot(alpha, norm);
+		scale(_x.segment(1, _x.size() - 1), static_cast<value_type>(1) / (alpha - beta));
+		_x[0] = beta;
+		return (beta - alpha) / beta;
+	}
+
+	///	<summary>C = (I - tau v v^T)C。_vの先頭は1とみなし、読みません。</summary>
+	static void apply_reflector(const_vector_type _v, value_type _tau, view_type _c)
+	{
+		if (_tau == static_cast<value_type>(0))
+		{
+			return;
+		}
+
+		const size_type rows = _c.rows();
+		const size_type columns = _c.columns();
+		const_vector_type tail = _v.segment(1, rows - 1);
+		view_type c_tail = _c.block(1, 0, rows - 1, columns);
+
+		// w = C^T v
+		workspace_type& work = workspace<0>();
+		work.resize(1, columns);
+		vector_type w = work.row(0);
+		w.assign(_c.row(0));
+		gemv(static_cast<value_type>(1), c_tail.transposed(), tail, static_cast<value_type>(1), w);
+
+		axpy(-_tau, w, _c.row(0));
+		ger(-_tau, tail, w, c_tail);
+	}
+
+	/*!
+	*	@brief C = (H_0 H_1 ... H_(b-1))^T Cを、コンパクトWY表現I - V T V^Tを使ってgemmで求めます。
+	*	_panelはqr_unblockedの結果で、対角より下が反射ベクトルです。
+	*/
+	static void apply_block_reflector(const_view_type _panel, const value_type* _tau, view_type _c)
+	{
+		const size_type rows = _panel.rows();
+		const size_type width = _panel.columns();
+
+		// 先頭の1と上側の0を明示したVを作ります。
+		workspace_type& v = workspace<1>();
+		v.resize(rows, width);
+		v.fill(static_cast<value_type>(0));
+		for (size_type j = 0; j < width; j++)
+		{
+			v(j, j) = static_cast<value_type>(1);
+			v.column(j).segment(j + 1, rows - j - 1).assign(_panel.column(j).segment(j + 1, rows - j - 1));
+		}
+
+		// T(0:i, i) = -tau_i T(0:i, 0:i) V(:, 0:i)^T v_i
+		workspace_type& t = workspace<2>();
+		t.resize(width, width);
+		t.fill(static_cast<value_type>(0));
+		for (size_type i = 0; i < width; i++)
+		{
+			t(i, i) = _tau[i];
+			if (i == 0)
+			{
+				continue;
+			}
+			vector_type column = t.column(i).segment(0, i);
+			gemv(static_cast<value_type>(1), v.block(i, 0, rows - i, i).transposed(), v.column(i).segment(i, rows - i), static_cast<value_type>(0), column);
+			for (size_type r = 0; r < i; r++)
+			{
+				value_type sum = static_cast<value_type>(0);
+				for (size_type c = r; c < i; c++)
+				{
+					sum += t(r, c) * column[c];
+				}
+				column[r] = sum;
+			}
+			scale(column, -_tau[i]);
+		}
+
+		// C -= V T^T (V^T C)
+		workspace_type& w = workspace<3>();
+		workspace_type& tw = workspace<4>();
+		w.resize(width, _c.columns());
+		tw.resize(width, _c.columns());
+		gemm(static_cast<value_type>(1), v.transposed(), _c, static_cast<value_type>(0), w);
+		gemm(static_cast<value_type>(1), t.transposed(), w, static_cast<value_type>(0), tw);
+		gemm(static_cast<value_type>(-1), v, tw, static_cast<value_type>(1), _c);
+	}
+};
+
+///< matrix_viewはそのまま、vector_viewは1列の行列として参照します。
+template<class type> inline matrix_view<type> as_matrix_view(const matrix_view<type>& _view)
+{
+	return _view;
+}
+
+template<class type> inline matrix_view<type> as_matrix_view(const vector_view<type>& _view)
+{
+	return matrix_view<type>(_view.data(), _view.size(), 1, _view.stride(), 1);
+}
+
+/*!
+*	@brief _aをその場でLU分解します。
+*	_aにはmatrix、dynamic_matrixとmatrix_viewを渡せます。_pivotsには行数分の領域が必要です。
+*/
+template<class a_type> inline bool lu_factorize(a_type&& _a, size_t* _pivots)
+{
+	return decomposition_kernel<view_value_of<a_type>>::lu(_a.view(), _pivots);
+}
+
+///< lu_factorizeの結果でAX = Bを解きます。_bは行列でもベクトルでも構いません。
+template<class lu_type, class b_type> inline void lu_solve(const lu_type& _lu, const size_t* _pivots, b_type&& _b)
+{
+	decomposition_kernel<view_value_of<lu_type>>::lu_solve(_lu.view(), _pivots, as_matrix_view(_b.view()));
+}
+
+template<class lu_type> inline view_value_of<lu_type> lu_determinant(const lu_type& _lu, const size_t* _pivots)
+{
+	return decomposition_kernel<view_value_of<lu_type>>::lu_determinant(_lu.view(), _pivots);
+}
+
+///< 対称正定値の_aをその場でコレスキー分解します。_aはis_symmetric()を満たさなければなりません。
+template<class a_type> inline bool cholesky_factorize(a_type&& _a)
+{
+	return decomposition_kernel<view_value_of<a_type>>::cholesky(_a.view());
+}
+
+template<class l_type, class b_type> inline void cholesky_solve(const l_type& _l, b_type&& _b)
+{
+	decomposition_kernel<view_value_of<l_type>>::cholesky_solve(_l.view(), as_matrix_view(_b.view()));
+}
+
+///< _aをその場でQR分解します。_tauには列数分の領域が必要です。
+template<class a_type> inline void qr_factorize(a_type&& _a, view_value_of<a_type>* _tau)
+{
+	decomposition_kernel<view_value_of<a_type>>::qr(_a.view(), _tau);
+}
+
+///< qr_factorizeの結果で最小二乗解を求め、_bの先頭の列数行に書き込みます。
+template<class qr_type, class b_type> inline void qr_solve(const qr_type& _qr, const view_value_of<qr_type>* _tau, b_type&& _b)
+{
+	decomposition_kernel<view_value_of<qr_type>>::qr_solve(_qr.view(), _tau, as_matrix_view(_b.view()));
+}
+
+}
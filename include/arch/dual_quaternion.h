@@ -0,0 +1,387 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include "parallel.h"
+#include "quaternion.h"
+#include "simd.h"
+#include "soa_vector.h"
+#include "vector.h"
+
+namespace arch
+{
+
+/*!
+*	@brief デュアルクォータニオンを表します。回転realと平行移動t(dual = 0.5 * t * real)の組で、点pを real p real^-1 + t に移します。
+*	重み付きで混合しても回転が潰れないため、スキニングで線形混合(LBS)のキャンディラッパー現象が起きません。
+*	各関数は単位デュアルクォータニオン(|real| = 1、real・dual = 0)を前提とします。
+*/
+template <typename type>
+class dual_quaternion
+{
+public:
+	typedef type value_type;
+	typedef size_t size_type;
+
+public:
+	dual_quaternion() = default;
+
+	dual_quaternion(const quaternion<value_type>& _real, const quaternion<value_type>& _dual)
+		: real(_real), dual(_dual)
+	{
+	}
+
+	///	<summary>_rotationで回転してから_translationだけ平行移動する変換を作ります。</summary>
+	dual_quaternion(const quaternion<value_type>& _rotation, const vector3<value_type>& _translation)
+		: real(_rotation), dual(scaled(quaternion<value_type>(_translation.x, _translation.y, _translation.z, static_cast<value_type>(0.0)) * _rotation, static_cast<value_type>(0.5)))
+	{
+	}
+
+	static dual_quaternion identity()
+	{
+		const value_type zero = static_cast<value_type>(0.0);
+		return dual_quaternion(quaternion<value_type>(zero, zero, zero, static_cast<value_type>(1.0)), quaternion<value_type>(zero, zero, zero, zero));
+	}
+
+	const quaternion<value_type>& rotation() const
+	{
+		return real;
+	}
+
+	///	<summary>平行移動成分2 * dual * real^*を求めます。</summary>
+	vector3<value_type> translation() const
+	{
+		return (dual * real.conjugated()).real * static_cast<value_type>(2.0);
+	}
+
+	///	<summary>逆変換を求めます。単位デュアルクォータニオンの逆はrealとdualそれぞれの共役です。</summary>
+	dual_quaternion inverse() const
+	{
+		return dual_quaternion(real.conjugated(), dual.conjugated());
+	}
+
+	/*!
+	*	@brief |real| = 1、real・dual = 0になるように正規化します。
+	*	dualからrealの成分を取り除いても変換は変わらないため、混合後の誤差の蓄積を防げます。
+	*/
+	dual_quaternion& normalize()
+	{
+		const value_type inverse_length = static_cast<value_type>(1.0) / std::sqrt(dot(real, real));
+		real = scaled(real, inverse_length);
+		dual = scaled(dual, inverse_length);
+		const value_type projection = dot(real, dual);
+		dual = quaternion<value_type>(dual.x - real.x * projection, dual.y - real.y * projection, dual.z - real.z * projection, dual.w - real.w * projection);
+		return *this;
+	}
+
+	dual_quaternion normalized() const
+	{
+		return dual_quaternion(*this).normalize();
+	}
+
+	///	<summary>点を変換します(平行移動を含みます)。</summary>
+	vector3<value_type> transform_point(const vector3<value_type>& _point) const
+	{
+		return real.rotate(_point) + translation();
+	}
+
+	///	<summary>方向や法線を変換します(平行移動を含みません)。</summary>
+	vector3<value_type> transform_direction(const vector3<value_type>& _direction) const
+	{
+		return real.rotate(_direction);
+	}
+
+	/*!
+	*	@brief 最大4つの_bones[_indices[k]]を_weights[k]で混合して正規化します(Dual quaternion Linear Blending)。
+	*	realの内積が_bones[_indices.x]と負になるボーンは符号を反転して混合するため、同じ回転の2通りの表現が打ち消し合いません。
+	*	使わない影響は重みを0にしてください。重みの和は1でなくても構いません。
+	*/
+	static dual_quaternion blend(const dual_quaternion* _bones, const vector4<ushort>& _indices, const vector4<value_type>& _weights)
+	{
+		const dual_quaternion& first = _bones[_indices.x];
+		value_type result[8] = {};
+		for (size_type k = 0; k < 4; k++)
+		{
+			const dual_quaternion& bone = _bones[_indices.data[k]];
+			const value_type weight = std::copysign(_weights.data[k], dot(first.real, bone.real));
+			for (size_type c = 0; c < 4; c++)
+			{
+				result[c] += weight * bone.real.data[c];
+				result[c + 4] += weight * bone.dual.data[c];
+			}
+		}
+		return dual_quaternion(quaternion<value_type>(result[0], result[1], result[2], result[3]), quaternion<value_type>(result[4], result[5], result[6], result[7])).normalize();
+	}
+
+	/*!
+	*	@brief 頂点ごとにblendしたデュアルクォータニオンで、成分ごとの配列の位置と法線をスキニングします。
+	*	pack幅の頂点ずつボーンを転置して読み、混合、符号の反転、正規化と変換をレーンごとにまとめて求めます。
+	*	結果はblendとtransform_point/transform_directionで1頂点ずつ求めた場合と丸め誤差の範囲で一致します。
+	*	_normalsは_positionsと同じ要素数が必要です。_indicesと_weightsは頂点数の要素が必要です。_skinned_positionsと_skinned_normalsは頂点数にリサイズされます。
+	*	ARCH_PARALLEL_THRESHOLD以上の頂点はスレッドに分割します。
+	*/
+	static void skin(const dual_quaternion* _bones, const vector4<ushort>* _indices, const vector4<value_type>* _weights,
+		const soa_vector3<value_type>& _positions, const soa_vector3<value_type>& _normals,
+		soa_vector3<value_type>& _skinned_positions, soa_vector3<value_type>& _skinned_normals)
+	{
+		assert(_normals.size() == _positions.size());
+		_skinned_positions.resize(_positions.size());
+		_skinned_normals.resize(_positions.size());
+		const value_type* input[6] = { _positions.x(), _positions.y(), _positions.z(), _normals.x(), _normals.y(), _normals.z() };
+		value_type* output[6] = { _skinned_positions.x(), _skinned_positions.y(), _skinned_positions.z(), _skinned_normals.x(), _skinned_normals.y(), _skinned_normals.z() };
+		skin(_bones, _indices, _weights, input, output, _positions.size());
+	}
+
+	///	<summary>法線を持たない頂点の位置だけをスキニングします。</summary>
+	static void skin(const dual_quaternion* _bones, const vector4<ushort>* _indices, const vector4<value_type>* _weights,
+		const soa_vector3<value_type>& _positions, soa_vector3<value_type>& _skinned_positions)
+	{
+		_skinned_positions.resize(_positions.size());
+		const value_type* input[6] = { _positions.x(), _positions.y(), _positions.z(), nullptr, nullptr, nullptr };
+		value_type* output[6] = { _skinned_positions.x(), _skinned_positions.y(), _skinned_positions.z(), nullptr, nullptr, nullptr };
+		skin(_bones, _indices, _weights, input, output, _positions.size());
+	}
+
+public:
+	///	<summary>*thisを_dual_quaternionの後に適用する変換を求めます(行列の積と同じ順序)。</summary>
+	dual_quaternion operator*(const dual_quaternion& _dual_quaternion) const
+	{
+		const quaternion<value_type> a = real * _dual_quaternion.dual;
+		const quaternion<value_type> b = dual * _dual_quaternion.real;
+		return dual_quaternion(real * _dual_quaternion.real, quaternion<value_type>(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w));
+	}
+
+	dual_quaternion& operator*=(const dual_quaternion& _dual_quaternion)
+	{
+		*this = *this * _dual_quaternion;
+		return *this;
+	}
+
+private:
+	///< 一括スキニングで一度に成分ごとの配列へ並べ替える頂点の数
+	static const size_type batch_size = 64;
+
+	static value_type dot(const quaternion<value_type>& _a, const quaternion<value_type>& _b)
+	{
+		return _a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w;
+	}
+
+	static quaternion<value_type> scaled(const quaternion<value_type>& _quaternion, value_type _scale)
+	{
+		return quaternion<value_type>(_quaternion.x * _scale, _quaternion.y * _scale, _quaternion.z * _scale, _quaternion.w * _scale);
+	}
+
+	///	<summary>_input/_outputは位置xyzと法線xyzのストリームで、法線はnullptrでも構いません。</summary>
+	static void skin(const dual_quaternion* _bones, const vector4<ushort>* _indices, const vector4<value_type>* _weights, const value_type* const (&_input)[6], value_type* const (&_output)[6], size_type _count)
+	{
+		static_assert(sizeof(dual_quaternion) == sizeof(value_type) * 8, "dual_quaternion must be tightly packed.");
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			for (size_type i = _begin; i < _end; i += batch_size)
+			{
+				skin_block(_bones, _indices, _weights, _input, _output, i, min(batch_size, _end - i), simd::packed4<value_type>());
+			}
+		});
+	}
+
+#if defined(ARCH_SIMD_SSE)
+	/*!
+	*	@brief batch_size個以下の頂点をスキニングします。
+	*	pack幅の頂点ずつblend_packで混合し、そのまま正規化と変換を求めます。
+	*/
+	static void skin_block(const dual_quaternion* _bones, const vector4<ushort>* _indices, const vector4<value_type>* _weights, const value_type* const (&_input)[6], value_type* const (&_output)[6], size_type _offset, size_type _count, std::true_type)
+	{
+		typedef simd::pack<value_type> pack_type;
+		const size_type width = pack_type::width;
+		const value_type zero = static_cast<value_type>(0.0);
+		const bool normals = _input[3] != nullptr;
+		const size_type streams = normals ? 6 : 3;
+		const size_type full = _count - _count % width;
+		for (size_type i = 0; i < full; i += width)
+		{
+			pack_type real[4], dual[4];
+			blend_pack(_bones, _indices, _weights, _offset + i, width, real, dual);
+			skin_pack(real, dual, _input, _output, _offset + i, normals);
+		}
+		if (full < _count)
+		{
+			// 端数の頂点はストリームの外を読み書きしないように一時領域を経由する
+			pack_type real[4], dual[4];
+			blend_pack(_bones, _indices, _weights, _offset + full, _count - full, real, dual);
+			value_type input[6][width], output[6][width];
+			const value_type* input_streams[6] = {};
+			value_type* output_streams[6] = {};
+			for (size_type s = 0; s < streams; s++)
+			{
+				for (size_type v = 0; v < width; v++)
+				{
+					input[s][v] = full + v < _count ? _input[s][_offset + full + v] : zero;
+				}
+				input_streams[s] = input[s];
+				output_streams[s] = output[s];
+			}
+			skin_pack(real, dual, input_streams, output_streams, 0, normals);
+			for (size_type s = 0; s < streams; s++)
+			{
+				for (size_type v = 0; full + v < _count; v++)
+				{
+					_output[s][_offset + full + v] = output[s][v];
+				}
+			}
+		}
+	}
+
+	/*!
+	*	@brief _index番目から_count個(pack幅以下)の頂点をblendと同じ規則で混合し、real/dualの成分ごとにpack幅の頂点を並べて返します。
+	*	ボーンと重みはsimd::gather4で頂点ごとに4要素を読んで転置し、レーンを頂点として成分ごとのpackに並べます。
+	*	符号の反転は1番目のボーンとの内積をpackで求めてsimd::selectで重みに適用するため、頂点ごとの内積や分岐はありません。
+	*	_count以降のレーンは単位デュアルクォータニオンになります。
+	*/
+	template<class pack_type> static void blend_pack(const dual_quaternion* _bones, const vector4<ushort>* _indices, const vector4<value_type>* _weights, size_type _index, size_type _count, pack_type* _real, pack_type* _dual)
+	{
+		const value_type zero = static_cast<value_type>(0.0);
+		const value_type padding_weight[4] = { static_cast<value_type>(1.0), zero, zero, zero };
+		const dual_quaternion padding = identity();
+
+		pack_type weight[4];
+		simd::gather4([&](size_type _lane) { return _lane < _count ? _weights[_index + _lane].data : padding_weight; }, weight);
+
+		pack_type first[4];
+		for (size_type k = 0; k < 4; k++)
+		{
+			auto bone = [&](size_type _lane) -> const dual_quaternion& { return _lane < _count ? _bones[_indices[_index + _lane].data[k]] : padding; };
+			pack_type real[4], dual[4];
+			simd::gather4([&](size_type _lane) { return bone(_lane).real.data; }, real);
+			simd::gather4([&](size_type _lane) { return bone(_lane).dual.data; }, dual);
+			if (k == 0)
+			{
+				for (size_type c = 0; c < 4; c++)
+				{
+					first[c] = real[c];
+					_real[c] = weight[0] * real[c];
+					_dual[c] = weight[0] * dual[c];
+				}
+				continue;
+			}
+
+			const pack_type dot = simd::fmadd(first[3], real[3], simd::fmadd(first[2], real[2], simd::fmadd(first[1], real[1], first[0] * real[0])));
+			const pack_type signed_weight = simd::select(dot < pack_type(zero), -weight[k], weight[k]);
+			for (size_type c = 0; c < 4; c++)
+			{
+				_real[c] = simd::fmadd(signed_weight, real[c], _real[c]);
+				_dual[c] = simd::fmadd(signed_weight, dual[c], _dual[c]);
+			}
+		}
+	}
+
+	///	<summary>pack幅の頂点の混合結果_real/_dualで、ストリームの_index番目からpack幅の頂点を変換します。</summary>
+	template<class pack_type> static void skin_pack(pack_type* _real, pack_type* _dual, const value_type* const (&_input)[6], value_type* const (&_output)[6], size_type _index, bool _normals)
+	{
+		pack_type input[6], output[6];
+		for (size_type s = 0; s < 3; s++)
+		{
+			input[s] = pack_type::load(_input[s] + _index);
+		}
+		if (_normals)
+		{
+			for (size_type s = 3; s < 6; s++)
+			{
+				input[s] = pack_type::load(_input[s] + _index);
+			}
+		}
+		transform(_real, _dual, input, output, _normals);
+		for (size_type s = 0; s < 3; s++)
+		{
+			output[s].store(_output[s] + _index);
+		}
+		if (_normals)
+		{
+			for (size_type s = 3; s < 6; s++)
+			{
+				output[s].store(_output[s] + _index);
+			}
+		}
+	}
+#endif
+
+	static void skin_block(const dual_quaternion* _bones, const vector4<ushort>* _indices, const vector4<value_type>* _weights, const value_type* const (&_input)[6], value_type* const (&_output)[6], size_type _offset, size_type _count, std::false_type)
+	{
+		for (size_type j = _offset; j < _offset + _count; j++)
+		{
+			const dual_quaternion blended = blend(_bones, _indices[j], _weights[j]);
+			const vector3<value_type> position = blended.transform_point(vector3<value_type>(_input[0][j], _input[1][j], _input[2][j]));
+			for (size_type c = 0; c < 3; c++)
+			{
+				_output[c][j] = position.data[c];
+			}
+			if (_input[3] != nullptr)
+			{
+				const vector3<value_type> normal = blended.transform_direction(vector3<value_type>(_input[3][j], _input[4][j], _input[5][j]));
+				for (size_type c = 0; c < 3; c++)
+				{
+					_output[c + 3][j] = normal.data[c];
+				}
+			}
+		}
+	}
+
+	///	<summary>_vectorを単位クォータニオン_rotationで回転します。quaternion::rotateと同じくt = 2(q × v)としてv + wt + q × tで求めます。</summary>
+	template<class pack_type> static void rotate(const pack_type* _rotation, const pack_type* _vector, pack_type* _result)
+	{
+		const pack_type two(static_cast<value_type>(2.0));
+		const pack_type tx = two * (_rotation[1] * _vector[2] - _rotation[2] * _vector[1]);
+		const pack_type ty = two * (_rotation[2] * _vector[0] - _rotation[0] * _vector[2]);
+		const pack_type tz = two * (_rotation[0] * _vector[1] - _rotation[1] * _vector[0]);
+		_result[0] = simd::fmadd(_rotation[3], tx, _vector[0]) + (_rotation[1] * tz - _rotation[2] * ty);
+		_result[1] = simd::fmadd(_rotation[3], ty, _vector[1]) + (_rotation[2] * tx - _rotation[0] * tz);
+		_result[2] = simd::fmadd(_rotation[3], tz, _vector[2]) + (_rotation[0] * ty - _rotation[1] * tx);
+	}
+
+	/*!
+	*	@brief 混合したデュアルクォータニオンをrealの長さで割り、位置_input[0..2]と法線_input[3..5]を変換します。
+	*	平行移動はdualを直交化せずに2(r_w d_v - d_w r_v + r_v × d_v)で求めます(直交化しても値は変わりません)。
+	*/
+	template<class pack_type> static void transform(pack_type* _real, pack_type* _dual, const pack_type* _input, pack_type* _output, bool _normals)
+	{
+		const pack_type scale = simd::rsqrt(simd::fmadd(_real[3], _real[3], simd::fmadd(_real[2], _real[2], simd::fmadd(_real[1], _real[1], _real[0] * _real[0]))));
+		for (size_type c = 0; c < 4; c++)
+		{
+			_real[c] = _real[c] * scale;
+			_dual[c] = _dual[c] * scale;
+		}
+
+		const pack_type two(static_cast<value_type>(2.0));
+		pack_type translation[3];
+		translation[0] = two * (_real[3] * _dual[0] - _dual[3] * _real[0] + (_real[1] * _dual[2] - _real[2] * _dual[1]));
+		translation[1] = two * (_real[3] * _dual[1] - _dual[3] * _real[1] + (_real[2] * _dual[0] - _real[0] * _dual[2]));
+		translation[2] = two * (_real[3] * _dual[2] - _dual[3] * _real[2] + (_real[0] * _dual[1] - _real[1] * _dual[0]));
+
+		rotate(_real, _input, _output);
+		for (size_type c = 0; c < 3; c++)
+		{
+			_output[c] = _output[c] + translation[c];
+		}
+		if (_normals)
+		{
+			rotate(_real, _input + 3, _output + 3);
+		}
+	}
+
+public:
+	quaternion<value_type> real;
+	quaternion<value_type> dual;
+};
+
+}
@@ -0,0 +1,993 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "aligned_allocator.h"
+#include "functions.h"
+#include "gemm.h"
+#include "parallel.h"
+#include "simd.h"
+
+namespace arch
+{
+
+/*!
+*	@brief 一定間隔で並んだ要素を参照するベクトルです。要素は所有せず、コピーしても同じ領域を指します。
+*	typeをconst修飾すると読み取り専用になります。
+*/
+template<class type>
+class vector_view
+{
+public:
+	typedef typename std::remove_const<type>::type value_type;
+	typedef size_t size_type;
+	typedef type* pointer;
+	typedef type& reference;
+
+public:
+	vector_view()
+		: m_data(nullptr), m_size(0), m_stride(1)
+	{
+	}
+
+	/*!
+	*	@param [in]	_stride	隣り合う要素の間隔(要素数)
+	*/
+	vector_view(pointer _data, size_type _size, size_type _stride = 1)
+		: m_data(_data), m_size(_size), m_stride(_stride)
+	{
+	}
+
+	///	<summary>書き込み可能な参照から読み取り専用の参照を作ります。</summary>
+	template<class other_type, class = typename std::enable_if<!std::is_same<other_type, type>::value && std::is_same<const other_type, type>::value>::type>
+	vector_view(const vector_view<other_type>& _view)
+		: m_data(_view.data()), m_size(_view.size()), m_stride(_view.stride())
+	{
+	}
+
+	pointer data() const
+	{
+		return m_data;
+	}
+
+	size_type size() const
+	{
+		return m_size;
+	}
+
+	size_type stride() const
+	{
+		return m_stride;
+	}
+
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+
+	reference operator[](size_type _index) const
+	{
+		return m_data[_index * m_stride];
+	}
+
+	vector_view view() const
+	{
+		return *this;
+	}
+
+	///	<summary>_beginから_size個の要素を参照します。</summary>
+	vector_view segment(size_type _begin, size_type _size) const
+	{
+		assert(_begin + _size <= m_size);
+		return vector_view(m_data + _begin * m_stride, _size, m_stride);
+	}
+
+	///	<summary>_beginから_step個おきに_size個の要素を参照します。</summary>
+	vector_view slice(size_type _begin, size_type _size, size_type _step) const
+	{
+		assert(_size == 0 || _begin + (_size - 1) * _step < m_size);
+		return vector_view(m_data + _begin * m_stride, _size, m_stride * _step);
+	}
+
+	void fill(value_type _value) const
+	{
+		for (size_type i = 0; i < m_size; i++)
+		{
+			(*this)[i] = _value;
+		}
+	}
+
+	///	<summary>同じ要素数の_sourceの要素を書き込みます。</summary>
+	void assign(const vector_view<const value_type>& _source) const
+	{
+		assert(_source.size() == m_size);
+		for (size_type i = 0; i < m_size; i++)
+		{
+			(*this)[i] = _source[i];
+		}
+	}
+
+private:
+	pointer m_data;
+	size_type m_size;
+	size_type m_stride;
+};
+
+/*!
+*	@brief 行と列の間隔を指定して要素を参照する行列です。要素は所有せず、コピーしても同じ領域を指します。
+*	(row, column)の要素はdata()[row * row_stride() + column * column_stride()]にあります。
+*	transposed()は間隔を入れ替えるだけで、要素はコピーしません。
+*/
+template<class type>
+class matrix_view
+{
+public:
+	typedef typename std::remove_const<type>::type value_type;
+	typedef size_t size_type;
+	typedef type* pointer;
+	typedef type& reference;
+	typedef vector_view<type> vector_type;
+
+public:
+	matrix_view()
+		: m_data(nullptr), m_rows(0), m_columns(0), m_row_stride(0), m_column_stride(1)
+	{
+	}
+
+	///	<summary>行優先で_row_strideおきに行が並ぶ領域を参照します。</summary>
+	matrix_view(pointer _data, size_type _rows, size_type _columns, size_type _row_stride)
+		: m_data(_data), m_rows(_rows), m_columns(_columns), m_row_stride(_row_stride), m_column_stride(1)
+	{
+	}
+
+	matrix_view(pointer _data, size_type _rows, size_type _columns, size_type _row_stride, size_type _column_stride)
+		: m_data(_data), m_rows(_rows), m_columns(_columns), m_row_stride(_row_stride), m_column_stride(_column_stride)
+	{
+	}
+
+	///	<summary>書き込み可能な参照から読み取り専用の参照を作ります。</summary>
+	template<class other_type, class = typename std::enable_if<!std::is_same<other_type, type>::value && std::is_same<const other_type, type>::value>::type>
+	matrix_view(const matrix_view<other_type>& _view)
+		: m_data(_view.data()), m_rows(_view.rows()), m_columns(_view.columns()), m_row_stride(_view.row_stride()), m_column_stride(_view.column_stride())
+	{
+	}
+
+	pointer data() const
+	{
+		return m_data;
+	}
+
+	size_type rows() const
+	{
+		return m_rows;
+	}
+
+	size_type columns() const
+	{
+		return m_columns;
+	}
+
+	size_type row_stride() const
+	{
+		return m_row_stride;
+	}
+
+	size_type column_stride() const
+	{
+		return m_column_stride;
+	}
+
+	bool empty() const
+	{
+		return m_rows == 0 || m_columns == 0;
+	}
+
+	reference operator()(size_type _row, size_type _column) const
+	{
+		return m_data[_row * m_row_stride + _column * m_column_stride];
+	}
+
+	matrix_view view() const
+	{
+		return *this;
+	}
+
+	vector_type row(size_type _row) const
+	{
+		assert(_row < m_rows);
+		return vector_type(m_data + _row * m_row_stride, m_columns, m_column_stride);
+	}
+
+	vector_type column(size_type _column) const
+	{
+		assert(_column < m_columns);
+		return vector_type(m_data + _column * m_column_stride, m_rows, m_row_stride);
+	}
+
+	vector_type diagonal() const
+	{
+		return vector_type(m_data, min(m_rows, m_columns), m_row_stride + m_column_stride);
+	}
+
+	///	<summary>(_row, _column)から_rows x _columnsの部分行列を参照します。</summary>
+	matrix_view block(size_type _row, size_type _column, size_type _rows, size_type _columns) const
+	{
+		assert(_row + _rows <= m_rows && _column + _columns <= m_columns);
+		return matrix_view(m_data + _row * m_row_stride + _column * m_column_stride, _rows, _columns, m_row_stride, m_column_stride);
+	}
+
+	matrix_view transposed() const
+	{
+		return matrix_view(m_data, m_columns, m_rows, m_column_stride, m_row_stride);
+	}
+
+	bool is_symmetric() const
+	{
+		if (m_rows != m_columns)
+		{
+			return false;
+		}
+		for (size_type row = 0; row < m_rows; row++)
+		{
+			for (size_type column = 0; column < row; column++)
+			{
+				if ((*this)(row, column) != (*this)(column, row))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	void fill(value_type _value) const
+	{
+		for (size_type row = 0; row < m_rows; row++)
+		{
+			this->row(row).fill(_value);
+		}
+	}
+
+	///	<summary>同じ大きさの_sourceの要素を書き込みます。</summary>
+	void assign(const matrix_view<const value_type>& _source) const
+	{
+		assert(_source.rows() == m_rows && _source.columns() == m_columns);
+		for (size_type row = 0; row < m_rows; row++)
+		{
+			this->row(row).assign(_source.row(row));
+		}
+	}
+
+private:
+	pointer m_data;
+	size_type m_rows;
+	size_type m_columns;
+	size_type m_row_stride;
+	size_type m_column_stride;
+};
+
+/*!
+*	@brief 要素数を実行時に決める、64バイト境界に揃えたヒープ上のベクトルです。
+*	部分の参照はsegment/sliceでコピーせずに作れます。
+*/
+template<class type>
+class dynamic_vector
+{
+public:
+	typedef type value_type;
+	typedef size_t size_type;
+	typedef type* pointer;
+	typedef const type* const_pointer;
+	typedef type& reference;
+	typedef const type& const_reference;
+	typedef std::vector<value_type, aligned_allocator<value_type>> storage_type;
+
+public:
+	dynamic_vector() = default;
+
+	explicit dynamic_vector(size_type _size)
+		: m_data(_size)
+	{
+	}
+
+	dynamic_vector(size_type _size, value_type _value)
+		: m_data(_size, _value)
+	{
+	}
+
+	dynamic_vector(std::initializer_list<value_type> _list)
+		: m_data(_list)
+	{
+	}
+
+	explicit dynamic_vector(const vector_view<const value_type>& _view)
+		: m_data(_view.size())
+	{
+		view().assign(_view);
+	}
+
+	size_type size() const
+	{
+		return m_data.size();
+	}
+
+	bool empty() const
+	{
+		return m_data.empty();
+	}
+
+	pointer data()
+	{
+		return m_data.data();
+	}
+
+	const_pointer data() const
+	{
+		return m_data.data();
+	}
+
+	reference operator[](size_type _index)
+	{
+		return m_data[_index];
+	}
+
+	const_reference operator[](size_type _index) const
+	{
+		return m_data[_index];
+	}
+
+	void resize(size_type _size)
+	{
+		m_data.resize(_size);
+	}
+
+	void fill(value_type _value)
+	{
+		std::fill(m_data.begin(), m_data.end(), _value);
+	}
+
+	vector_view<type> view()
+	{
+		return vector_view<type>(data(), size());
+	}
+
+	vector_view<const type> view() const
+	{
+		return vector_view<const type>(data(), size());
+	}
+
+	operator vector_view<type>()
+	{
+		return view();
+	}
+
+	operator vector_view<const type>() const
+	{
+		return view();
+	}
+
+	vector_view<type> segment(size_type _begin, size_type _size)
+	{
+		return view().segment(_begin, _size);
+	}
+
+	vector_view<const type> segment(size_type _begin, size_type _size) const
+	{
+		return view().segment(_begin, _size);
+	}
+
+	vector_view<type> slice(size_type _begin, size_type _size, size_type _step)
+	{
+		return view().slice(_begin, _size, _step);
+	}
+
+	vector_view<const type> slice(size_type _begin, size_type _size, size_type _step) const
+	{
+		return view().slice(_begin, _size, _step);
+	}
+
+private:
+	storage_type m_data;
+};
+
+/*!
+*	@brief 行数と列数を実行時に決める、64バイト境界に揃えたヒープ上の行優先の行列です。
+*	row/column/block/transposedはコピーせずにmatrix_viewやvector_viewを返します。
+*/
+template<class type>
+class dynamic_matrix
+{
+public:
+	typedef type value_type;
+	typedef size_t size_type;
+	typedef type* pointer;
+	typedef const type* const_pointer;
+	typedef type& reference;
+	typedef const type& const_reference;
+	typedef std::vector<value_type, aligned_allocator<value_type>> storage_type;
+
+public:
+	dynamic_matrix()
+		: m_rows(0), m_columns(0)
+	{
+	}
+
+	dynamic_matrix(size_type _rows, size_type _columns)
+		: m_rows(_rows), m_columns(_columns), m_data(_rows * _columns)
+	{
+	}
+
+	dynamic_matrix(size_type _rows, size_type _columns, value_type _value)
+		: m_rows(_rows), m_columns(_columns), m_data(_rows * _columns, _value)
+	{
+	}
+
+	///	<summary>行ごとの初期化子リストから作ります。すべての行は同じ要素数でなければなりません。</summary>
+	dynamic_matrix(std::initializer_list<std::initializer_list<value_type>> _list)
+		: m_rows(_list.size()), m_columns((_list.size() > 0) ? _list.begin()->size() : 0)
+	{
+		m_data.reserve(m_rows * m_columns);
+		for (const auto& row : _list)
+		{
+			assert(row.size() == m_columns);
+			m_data.insert(m_data.end(), row.begin(), row.end());
+		}
+	}
+
+	explicit dynamic_matrix(const matrix_view<const value_type>& _view)
+		: m_rows(_view.rows()), m_columns(_view.columns()), m_data(_view.rows() * _view.columns())
+	{
+		view().assign(_view);
+	}
+
+	static dynamic_matrix identity(size_type _size)
+	{
+		dynamic_matrix result(_size, _size);
+		result.diagonal().fill(static_cast<value_type>(1));
+		return result;
+	}
+
+	size_type rows() const
+	{
+		return m_rows;
+	}
+
+	size_type columns() const
+	{
+		return m_columns;
+	}
+
+	size_type size() const
+	{
+		return m_data.size();
+	}
+
+	bool empty() const
+	{
+		return m_data.empty();
+	}
+
+	pointer data()
+	{
+		return m_data.data();
+	}
+
+	const_pointer data() const
+	{
+		return m_data.data();
+	}
+
+	reference operator()(size_type _row, size_type _column)
+	{
+		return m_data[_row * m_columns + _column];
+	}
+
+	const_reference operator()(size_type _row, size_type _column) const
+	{
+		return m_data[_row * m_columns + _column];
+	}
+
+	///	<summary>_row行目の先頭を取得します。[row][column]で要素にアクセスできます。</summary>
+	pointer operator[](size_type _row)
+	{
+		return data() + _row * m_columns;
+	}
+
+	const_pointer operator[](size_type _row) const
+	{
+		return data() + _row * m_columns;
+	}
+
+	///	<summary>大きさを変更します。要素の位置は保持されません。</summary>
+	void resize(size_type _rows, size_type _columns)
+	{
+		m_rows = _rows;
+		m_columns = _columns;
+		m_data.resize(_rows * _columns);
+	}
+
+	void fill(value_type _value)
+	{
+		std::fill(m_data.begin(), m_data.end(), _value);
+	}
+
+	matrix_view<type> view()
+	{
+		return matrix_view<type>(data(), m_rows, m_columns, m_columns);
+	}
+
+	matrix_view<const type> view() const
+	{
+		return matrix_view<const type>(data(), m_rows, m_columns, m_columns);
+	}
+
+	operator matrix_view<type>()
+	{
+		return view();
+	}
+
+	operator matrix_view<const type>() const
+	{
+		return view();
+	}
+
+	vector_view<type> row(size_type _row)
+	{
+		return view().row(_row);
+	}
+
+	vector_view<const type> row(size_type _row) const
+	{
+		return view().row(_row);
+	}
+
+	vector_view<type> column(size_type _column)
+	{
+		return view().column(_column);
+	}
+
+	vector_view<const type> column(size_type _column) const
+	{
+		return view().column(_column);
+	}
+
+	vector_view<type> diagonal()
+	{
+		return view().diagonal();
+	}
+
+	vector_view<const type> diagonal() const
+	{
+		return view().diagonal();
+	}
+
+	matrix_view<type> block(size_type _row, size_type _column, size_type _rows, size_type _columns)
+	{
+		return view().block(_row, _column, _rows, _columns);
+	}
+
+	matrix_view<const type> block(size_type _row, size_type _column, size_type _rows, size_type _columns) const
+	{
+		return view().block(_row, _column, _rows, _columns);
+	}
+
+	matrix_view<type> transposed()
+	{
+		return view().transposed();
+	}
+
+	matrix_view<const type> transposed() const
+	{
+		return view().transposed();
+	}
+
+	bool is_symmetric() const
+	{
+		return view().is_symmetric();
+	}
+
+private:
+	size_type m_rows;
+	size_type m_columns;
+	storage_type m_data;
+};
+
+/*!
+*	@brief BLASのレベル1/2に相当する演算です。
+*	要素が連続している場合はsimd::packで処理し、そうでない場合は要素ごとに処理します。
+*	gemvとgerは要素数がARCH_PARALLEL_THRESHOLD以上の場合に行または列をスレッドに分割します。
+*/
+template<class type>
+class blas_kernel
+{
+public:
+	typedef type value_type;
+	typedef size_t size_type;
+	typedef simd::pack<value_type> pack_type;
+	typedef std::vector<value_type, aligned_allocator<value_type>> buffer_type;
+
+	static const size_type width = pack_type::width;
+
+public:
+	///	<summary>y = alpha * x + y</summary>
+	static void axpy(size_type _size, value_type _alpha, const value_type* _x, size_type _x_stride, value_type* _y, size_type _y_stride)
+	{
+		if (_x_stride == 1 && _y_stride == 1)
+		{
+			axpy(_size, _alpha, _x, _y);
+			return;
+		}
+		for (size_type i = 0; i < _size; i++)
+		{
+			_y[i * _y_stride] += _alpha * _x[i * _x_stride];
+		}
+	}
+
+	static value_type dot(size_type _size, const value_type* _x, size_type _x_stride, const value_type* _y, size_type _y_stride)
+	{
+		if (_x_stride == 1 && _y_stride == 1)
+		{
+			return dot(_size, _x, _y);
+		}
+		value_type result = static_cast<value_type>(0);
+		for (size_type i = 0; i < _size; i++)
+		{
+			result += _x[i * _x_stride] * _y[i * _y_stride];
+		}
+		return result;
+	}
+
+	/*!
+	*	@brief ユークリッドノルムを求めます。
+	*	二乗和がオーバーフローまたはアンダーフローする場合だけ、最大の絶対値で割ってから求め直します。
+	*/
+	static value_type nrm2(size_type _size, const value_type* _x, size_type _x_stride)
+	{
+		const value_type sum = dot(_size, _x, _x_stride, _x, _x_stride);
+		if (sum != sum)
+		{
+			return sum;
+		}
+		if (sum >= std::numeric_limits<value_type>::min() / std::numeric_limits<value_type>::epsilon() && sum <= std::numeric_limits<value_type>::max())
+		{
+			return std::sqrt(sum);
+		}
+
+		value_type scale = static_cast<value_type>(0);
+		for (size_type i = 0; i < _size; i++)
+		{
+			scale = max(scale, std::abs(_x[i * _x_stride]));
+		}
+		if (scale == static_cast<value_type>(0) || scale > std::numeric_limits<value_type>::max())
+		{
+			return scale;
+		}
+		const value_type reciprocal = static_cast<value_type>(1) / scale;
+		value_type scaled_sum = static_cast<value_type>(0);
+		for (size_type i = 0; i < _size; i++)
+		{
+			const value_type x = _x[i * _x_stride] * reciprocal;
+			scaled_sum += x * x;
+		}
+		return scale * std::sqrt(scaled_sum);
+	}
+
+	/*!
+	*	@brief y = alpha * A * x + beta * yを求めます。Aは_rows x _columnsです。
+	*	@param [in]	_beta	0の場合はyを読みません。
+	*/
+	static void gemv(size_type _rows, size_type _columns, value_type _alpha, const value_type* _a, size_type _row_stride, size_type _column_stride, const value_type* _x, size_type _x_stride, value_type _beta, value_type* _y, size_type _y_stride)
+	{
+		scale(_rows, _beta, _y, _y_stride);
+		if (_rows == 0 || _columns == 0 || _alpha == static_cast<value_type>(0))
+		{
+			return;
+		}
+
+		if (_column_stride == 1)
+		{
+			// 行が連続している場合は、4行ずつxの読み込みを共有して内積を求めます。
+			buffer_type gathered;
+			const value_type* x = contiguous(_columns, _x, _x_stride, gathered);
+			parallel_for(_rows, grain(_columns), [&](size_type _begin, size_type _end)
+			{
+				const size_type unrolled = _begin + (_end - _begin) / 4 * 4;
+				size_type row = _begin;
+				for (; row < unrolled; row += 4)
+				{
+					const value_type* a = _a + row * _row_stride;
+					value_type sums[4];
+					dot4(_columns, a, a + _row_stride, a + _row_stride * 2, a + _row_stride * 3, x, sums);
+					for (size_type r = 0; r < 4; r++)
+					{
+						_y[(row + r) * _y_stride] += _alpha * sums[r];
+					}
+				}
+				for (; row < _end; row++)
+				{
+					_y[row * _y_stride] += _alpha * dot(_columns, _a + row * _row_stride, x);
+				}
+			});
+		}
+		else if (_row_stride == 1)
+		{
+			// 列が連続している場合は、行の範囲ごとに列を順にaxpyで足し込みます。
+			parallel_for(_rows, grain(_columns), [&](size_type _begin, size_type _end)
+			{
+				for (size_type column = 0; column < _columns; column++)
+				{
+					axpy(_end - _begin, _alpha * _x[column * _x_stride], _a + column * _column_stride + _begin, 1, _y + _begin * _y_stride, _y_stride);
+				}
+			});
+		}
+		else
+		{
+			for (size_type row = 0; row < _rows; row++)
+			{
+				_y[row * _y_stride] += _alpha * dot(_columns, _a + row * _row_stride, _column_stride, _x, _x_stride);
+			}
+		}
+	}
+
+	///	<summary>A = alpha * x * y^T + Aを求めます。Aは_rows x _columnsです。</summary>
+	static void ger(size_type _rows, size_type _columns, value_type _alpha, const value_type* _x, size_type _x_stride, const value_type* _y, size_type _y_stride, value_type* _a, size_type _row_stride, size_type _column_stride)
+	{
+		if (_rows == 0 || _columns == 0 || _alpha == static_cast<value_type>(0))
+		{
+			return;
+		}
+
+		if (_column_stride == 1)
+		{
+			buffer_type gathered;
+			const value_type* y = contiguous(_columns, _y, _y_stride, gathered);
+			parallel_for(_rows, grain(_columns), [&](size_type _begin, size_type _end)
+			{
+				for (size_type row = _begin; row < _end; row++)
+				{
+					axpy(_columns, _alpha * _x[row * _x_stride], y, _a + row * _row_stride);
+				}
+			});
+		}
+		else if (_row_stride == 1)
+		{
+			buffer_type gathered;
+			const value_type* x = contiguous(_rows, _x, _x_stride, gathered);
+			parallel_for(_columns, grain(_rows), [&](size_type _begin, size_type _end)
+			{
+				for (size_type column = _begin; column < _end; column++)
+				{
+					axpy(_rows, _alpha * _y[column * _y_stride], x, _a + column * _column_stride);
+				}
+			});
+		}
+		else
+		{
+			for (size_type row = 0; row < _rows; row++)
+			{
+				axpy(_columns, _alpha * _x[row * _x_stride], _y, _y_stride, _a + row * _row_stride, _column_stride);
+			}
+		}
+	}
+
+private:
+	static void axpy(size_type _size, value_type _alpha, const value_type* _x, value_type* _y)
+	{
+		simd::for_each<value_type>(_size, [&](auto _pack, size_type _index)
+		{
+			typedef decltype(_pack) pack_type;
+			simd::fmadd(pack_type(_alpha), pack_type::load(_x + _index), pack_type::load(_y + _index)).store(_y + _index);
+		});
+	}
+
+	///	<summary>累積を4本に分けて加算の依存を断ち切った内積です。</summary>
+	static value_type dot(size_type _size, const value_type* _x, const value_type* _y)
+	{
+		const pack_type zero(static_cast<value_type>(0));
+		pack_type sum0 = zero, sum1 = zero, sum2 = zero, sum3 = zero;
+		const size_type unrolled = _size - _size % (width * 4);
+		const size_type packed = _size - _size % width;
+		size_type i = 0;
+		for (; i < unrolled; i += width * 4)
+		{
+			sum0 = simd::fmadd(pack_type::load(_x + i), pack_type::load(_y + i), sum0);
+			sum1 = simd::fmadd(pack_type::load(_x + i + width), pack_type::load(_y + i + width), sum1);
+			sum2 = simd::fmadd(pack_type::load(_x + i + width * 2), pack_type::load(_y + i + width * 2), sum2);
+			sum3 = simd::fmadd(pack_type::load(_x + i + width * 3), pack_type::load(_y + i + width * 3), sum3);
+		}
+		for (; i < packed; i += width)
+		{
+			sum0 = simd::fmadd(pack_type::load(_x + i), pack_type::load(_y + i), sum0);
+		}
+		value_type result = reduce((sum0 + sum1) + (sum2 + sum3));
+		for (; i < _size; i++)
+		{
+			result += _x[i] * _y[i];
+		}
+		return result;
+	}
+
+	///	<summary>4本の行_a0から_a3と_xの内積を、_xの読み込みを共有して求めます。</summary>
+	static void dot4(size_type _size, const value_type* _a0, const value_type* _a1, const value_type* _a2, const value_type* _a3, const value_type* _x, value_type* _result)
+	{
+		const pack_type zero(static_cast<value_type>(0));
+		pack_type sum0 = zero, sum1 = zero, sum2 = zero, sum3 = zero;
+		const size_type packed = _size - _size % width;
+		size_type i = 0;
+		for (; i < packed; i += width)
+		{
+			const pack_type x = pack_type::load(_x + i);
+			sum0 = simd::fmadd(pack_type::load(_a0 + i), x, sum0);
+			sum1 = simd::fmadd(pack_type::load(_a1 + i), x, sum1);
+			sum2 = simd::fmadd(pack_type::load(_a2 + i), x, sum2);
+			sum3 = simd::fmadd(pack_type::load(_a3 + i), x, sum3);
+		}
+		_result[0] = reduce(sum0);
+		_result[1] = reduce(sum1);
+		_result[2] = reduce(sum2);
+		_result[3] = reduce(sum3);
+		for (; i < _size; i++)
+		{
+			_result[0] += _a0[i] * _x[i];
+			_result[1] += _a1[i] * _x[i];
+			_result[2] += _a2[i] * _x[i];
+			_result[3] += _a3[i] * _x[i];
+		}
+	}
+
+	static value_type reduce(const pack_type& _value)
+	{
+		value_type lanes[width];
+		_value.store(lanes);
+		value_type result = lanes[0];
+		for (size_type i = 1; i < width; i++)
+		{
+			result += lanes[i];
+		}
+		return result;
+	}
+
+	///	<summary>y = beta * y。betaが0の場合はyを読まずに0を書き込みます。</summary>
+	static void scale(size_type _size, value_type _beta, value_type* _y, size_type _y_stride)
+	{
+		if (_beta == static_cast<value_type>(1))
+		{
+			return;
+		}
+		for (size_type i = 0; i < _size; i++)
+		{
+			value_type& y = _y[i * _y_stride];
+			y = (_beta == static_cast<value_type>(0)) ? static_cast<value_type>(0) : _beta * y;
+		}
+	}
+
+	///	<summary>_xが連続していなければ_bufferに詰めてから返します。</summary>
+	static const value_type* contiguous(size_type _size, const value_type* _x, size_type _x_stride, buffer_type& _buffer)
+	{
+		if (_x_stride == 1)
+		{
+			return _x;
+		}
+		_buffer.resize(_size);
+		for (size_type i = 0; i < _size; i++)
+		{
+			_buffer[i] = _x[i * _x_stride];
+		}
+		return _buffer.data();
+	}
+
+	///	<summary>1区間の要素数がARCH_PARALLEL_THRESHOLD以上になる行数です。</summary>
+	static size_type grain(size_type _length)
+	{
+		return max(ARCH_PARALLEL_THRESHOLD / max(_length, static_cast<size_type>(1)), static_cast<size_type>(1));
+	}
+};
+
+///< dynamic_vector、dynamic_matrixとそれらのviewからview()で得られる参照の型
+template<class view_source> using view_of = decltype(std::declval<view_source&>().view());
+
+///< 読み取り専用で参照した場合の要素の型
+template<class view_source> using view_value_of = typename view_of<const view_source>::value_type;
+
+/*!
+*	@brief y = alpha * x + y
+*	_x、_yにはdynamic_vectorとvector_viewのどちらも渡せます。
+*/
+template<class x_type, class y_type> inline void axpy(view_value_of<x_type> _alpha, const x_type& _x, y_type&& _y)
+{
+	view_of<const x_type> x = _x.view();
+	auto y = _y.view();
+	assert(x.size() == y.size());
+	blas_kernel<view_value_of<x_type>>::axpy(x.size(), _alpha, x.data(), x.stride(), y.data(), y.stride());
+}
+
+template<class x_type, class y_type> inline view_value_of<x_type> dot(const x_type& _x, const y_type& _y)
+{
+	view_of<const x_type> x = _x.view();
+	view_of<const y_type> y = _y.view();
+	assert(x.size() == y.size());
+	return blas_kernel<view_value_of<x_type>>::dot(x.size(), x.data(), x.stride(), y.data(), y.stride());
+}
+
+///< ユークリッドノルム
+template<class x_type> inline view_value_of<x_type> nrm2(const x_type& _x)
+{
+	view_of<const x_type> x = _x.view();
+	return blas_kernel<view_value_of<x_type>>::nrm2(x.size(), x.data(), x.stride());
+}
+
+/*!
+*	@brief y = alpha * A * x + beta * y
+*	Aの転置との積はA.transposed()を渡します。_yは_a、_xと重なってはいけません。
+*/
+template<class a_type, class x_type, class y_type> inline void gemv(view_value_of<a_type> _alpha, const a_type& _a, const x_type& _x, view_value_of<a_type> _beta, y_type&& _y)
+{
+	view_of<const a_type> a = _a.view();
+	view_of<const x_type> x = _x.view();
+	auto y = _y.view();
+	assert(a.columns() == x.size() && a.rows() == y.size());
+	blas_kernel<view_value_of<a_type>>::gemv(a.rows(), a.columns(), _alpha, a.data(), a.row_stride(), a.column_stride(), x.data(), x.stride(), _beta, y.data(), y.stride());
+}
+
+///< A = alpha * x * y^T + A
+template<class x_type, class y_type, class a_type> inline void ger(view_value_of<x_type> _alpha, const x_type& _x, const y_type& _y, a_type&& _a)
+{
+	view_of<const x_type> x = _x.view();
+	view_of<const y_type> y = _y.view();
+	auto a = _a.view();
+	assert(a.rows() == x.size() && a.columns() == y.size());
+	blas_kernel<view_value_of<x_type>>::ger(a.rows(), a.columns(), _alpha, x.data(), x.stride(), y.data(), y.stride(), a.data(), a.row_stride(), a.column_stride());
+}
+
+/*!
+*	@brief C = alpha * A * B + beta * C
+*	列の間隔が1でない(転置した)参照は連続した領域にコピーしてからgemm_kernelで求めます。
+*/
+template<class a_type, class b_type, class c_type> inline void gemm(view_value_of<a_type> _alpha, const a_type& _a, const b_type& _b, view_value_of<a_type> _beta, c_type&& _c)
+{
+	typedef view_value_of<a_type> value_type;
+	view_of<const a_type> a = _a.view();
+	view_of<const b_type> b = _b.view();
+	auto c = _c.view();
+	assert(a.rows() == c.rows() && b.columns() == c.columns() && a.columns() == b.rows());
+
+	dynamic_matrix<value_type> a_copy, b_copy, c_copy;
+	if (a.column_stride() != 1)
+	{
+		a_copy = dynamic_matrix<value_type>(a);
+		a = a_copy.view();
+	}
+	if (b.column_stride() != 1)
+	{
+		b_copy = dynamic_matrix<value_type>(b);
+		b = b_copy.view();
+	}
+	if (c.column_stride() != 1)
+	{
+		c_copy = dynamic_matrix<value_type>(c);
+		gemm_kernel<value_type>::multiply(c.rows(), c.columns(), a.columns(), _alpha, a.data(), a.row_stride(), b.data(), b.row_stride(), _beta, c_copy.data(), c_copy.columns());
+		c.assign(c_copy);
+		return;
+	}
+	gemm_kernel<value_type>::multiply(c.rows(), c.columns(), a.columns(), _alpha, a.data(), a.row_stride(), b.data(), b.row_stride(), _beta, c.data(), c.row_stride());
+}
+
+}
@@ -12,9 +12,30 @@
 
 #pragma once
 
+#include <cmath>
+#include <limits>
 #include <type_traits>
 #include "constants.h"
 
+/*!
+*	@brief 定数式として評価されているときにtrueを返す組み込み関数です。
+*	C++14には対応する標準の機能がないため、使えるコンパイラでだけ定義します。
+*	Visual Studio 2017などの使えないコンパイラでは、ARCH_CONSTANT_EVALUATED()をfalseと定義すると常に実行時の実装を使います。
+*	その場合、sqrt、powとvector4<float/double>の演算は定数式で使えなくなります。
+*/
+#if !defined(ARCH_CONSTANT_EVALUATED)
+#	if defined(__has_builtin)
+#		if __has_builtin(__builtin_is_constant_evaluated)
+#			define ARCH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#		endif
+#	endif
+#endif
+#if !defined(ARCH_CONSTANT_EVALUATED)
+#	if (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#		define ARCH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#	endif
+#endif
+
 namespace arch
 {
 
@@ -23,22 +44,129 @@ template<class type> inline constexpr type abs(type _x)
 	return _x < static_cast<type>(0.0) ? -_x : _x;
 }
 
+/*!
+*	@brief ニュートン法による平方根です。定数式の中で使うためのもので、実行時はsqrtを使ってください。
+*	_x / 2 + 1から単調に減少させ、減少しなくなった時点で打ち切るため必ず終了します。
+*	float/doubleは1段広い型で反復してから丸め、整数型では切り捨てた値を返します。
+*/
+template<class type> inline constexpr type newton_sqrt(type _x)
+{
+	typedef typename std::conditional<std::is_same<type, float>::value, double,
+		typename std::conditional<std::is_same<type, double>::value, long double, type>::type>::type wide_type;
+
+	if (!(_x == _x) || _x <= static_cast<type>(0))
+	{
+		return _x == static_cast<type>(0) ? _x : std::numeric_limits<type>::quiet_NaN();
+	}
+
+	const wide_type x = static_cast<wide_type>(_x);
+	wide_type n = x / static_cast<wide_type>(2) + static_cast<wide_type>(1);
+	for (;;)
+	{
+		wide_type next = (n + x / n) / static_cast<wide_type>(2);
+		if (!(next < n))
+		{
+			return static_cast<type>(n);
+		}
+		n = next;
+	}
+}
+
+/*!
+*	@brief 平方根です。定数式ではnewton_sqrtで求め、実行時の浮動小数点数はsqrtss/sqrtsdなどの命令で求めます。
+*	定数式かどうかを判定できないコンパイラでは常にnewton_sqrtになります。
+*/
 template<class type> inline constexpr type sqrt(type _x)
 {
-	type n = _x / static_cast<type>(2.0);
-	type p = static_cast<type>(0.0);
+#if defined(ARCH_CONSTANT_EVALUATED)
+	if (std::is_floating_point<type>::value && !ARCH_CONSTANT_EVALUATED())
+	{
+		return std::sqrt(_x);
+	}
+#endif
+	return newton_sqrt(_x);
+}
 
-	while (n != p)
+/*!
+*	@brief ipowの実装です。指数を2で割りながら展開するため、乗算はlog2(exponent)回程度になります。
+*/
+template<int exponent, bool negative = (exponent < 0)> struct integer_power
+{
+	template<class type> static constexpr type apply(type _x)
 	{
-		p = n;
-		n = (n + _x / n) / static_cast<type>(2.0);
+		return static_cast<type>(1) / integer_power<-exponent>::apply(_x);
 	}
-	return n;
+};
+
+template<int exponent> struct integer_power<exponent, false>
+{
+	template<class type> static constexpr type apply(type _x)
+	{
+		return (exponent % 2 != 0 ? _x : static_cast<type>(1)) * integer_power<exponent / 2>::apply(_x * _x);
+	}
+};
+
+template<> struct integer_power<1, false>
+{
+	template<class type> static constexpr type apply(type _x)
+	{
+		return _x;
+	}
+};
+
+template<> struct integer_power<0, false>
+{
+	template<class type> static constexpr type apply(type)
+	{
+		return static_cast<type>(1);
+	}
+};
+
+/*!
+*	@brief _xのexponent乗です。指数がコンパイル時に決まる場合に使い、乗算は展開されます。
+*/
+template<int exponent, class type> inline constexpr type ipow(type _x)
+{
+	return integer_power<exponent>::apply(_x);
+}
+
+/*!
+*	@brief _xの_y乗です。2進累乗法で求めるため、乗算は指数の桁数に比例した回数で済みます。
+*	負の指数では逆数を返します。整数型では1 / _x^|_y|を切り捨てた値になります。
+*/
+template<class type> inline constexpr type pow(type _x, int _y)
+{
+	unsigned int n = _y < 0 ? 0u - static_cast<unsigned int>(_y) : static_cast<unsigned int>(_y);
+	type result = static_cast<type>(1);
+	while (n != 0)
+	{
+		if ((n & 1u) != 0)
+		{
+			result *= _x;
+		}
+		n >>= 1;
+		if (n != 0)
+		{
+			_x *= _x;
+		}
+	}
+	return _y < 0 ? static_cast<type>(1) / result : result;
 }
 
-template<class type> inline constexpr type pow(type _x, type _y)
+/*!
+*	@brief 実数の指数による_xの_y乗です。実行時はstd::powで求めます。
+*	定数式では_yが整数値の場合に限り、pow(type, int)で求めます。
+*/
+template<class type> inline constexpr typename std::enable_if<std::is_floating_point<type>::value, type>::type pow(type _x, type _y)
 {
-	return _y == 0 ? 1 : _y < 0 ? pow(_x, _y + 1) / _x : _x * pow(_x, _y - 1);
+#if defined(ARCH_CONSTANT_EVALUATED)
+	if (!ARCH_CONSTANT_EVALUATED())
+	{
+		return std::pow(_x, _y);
+	}
+#endif
+	const type limit = static_cast<type>(std::numeric_limits<int>::max());
+	return _y >= -limit && _y <= limit && _y == static_cast<type>(static_cast<int>(_y)) ? pow(_x, static_cast<int>(_y)) : std::pow(_x, _y);
 }
 
 template<class type> inline constexpr type ceil(type _x)
@@ -49,7 +177,7 @@ template<class type> inline constexpr type ceil(type _x)
 
 template<class type> inline constexpr type floor(type _x)
 {
-	return static_cast<type>(static_cast<long long>(_x - static_cast<type>(0.9)));
+	return static_cast<type>(static_cast<long long>(_x)) > _x ? static_cast<type>(static_cast<long long>(_x) - 1) : static_cast<type>(static_cast<long long>(_x));
 }
 
 template<class type> inline constexpr type round(type _x)
@@ -0,0 +1,254 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include "aligned_allocator.h"
+#include "functions.h"
+#include "parallel.h"
+#include "simd.h"
+
+namespace arch
+{
+
+/*!
+*	@brief _functionを0からcount - 1までの定数の添字で呼び出します。
+*	ループを展開し、添字が定数になることでマイクロカーネルの累積を配列でなくレジスタに置けるようにします。
+*/
+template<size_t count> struct unroll
+{
+	template<class function_type> static void apply(function_type& _function)
+	{
+		unroll<count - 1>::apply(_function);
+		_function(std::integral_constant<size_t, count - 1>());
+	}
+};
+
+template<> struct unroll<0>
+{
+	template<class function_type> static void apply(function_type&)
+	{
+	}
+};
+
+/*!
+*	@brief 行優先の行列積C = alpha * A * B + beta * Cを求めます。
+*	BLISと同じ構成で、Bの列ブロックと内側の次元のブロックを連続した領域に詰め直し、
+*	Aの行ブロックごとに詰め直したAとの積をtile_rows x tile_columnsのマイクロカーネルで求めます。
+*	マイクロカーネルはsimd::packのfmaddで書かれ、AVX2/FMAを有効にするとymmレジスタ12本を累積に使います。
+*	行ブロックは要素数がARCH_PARALLEL_THRESHOLD以上の場合にスレッドに分割します。
+*/
+template<class type>
+class gemm_kernel
+{
+public:
+	typedef type value_type;
+	typedef size_t size_type;
+	typedef simd::pack<value_type> pack_type;
+
+	static const size_type width = pack_type::width;
+	static const size_type tile_rows = (width == 1) ? 4 : 6;	///< マイクロカーネルが一度に求める行数
+	static const size_type tile_packs = (width == 1) ? 4 : 2;
+	static const size_type tile_columns = width * tile_packs;	///< マイクロカーネルが一度に求める列数
+	static const size_type row_block = tile_rows * 16;	///< 詰め直したAがL2に収まる行数
+	static const size_type inner_block = 256;	///< 詰め直したAとBの1行がL1に収まる内側の次元の長さ
+	static const size_type column_block = tile_columns * 256;	///< 詰め直したBがL3に収まる列数
+
+public:
+	/*!
+	*	@param [in]	_rows	AとCの行数
+	*	@param [in]	_columns	BとCの列数
+	*	@param [in]	_inner	Aの列数とBの行数
+	*	@param [in]	_a_stride	Aの行の間隔(要素数)
+	*	@param [in]	_beta	0の場合はCを読みません。
+	*	Cは_aや_bと重なってはいけません。
+	*/
+	static void multiply(size_type _rows, size_type _columns, size_type _inner, value_type _alpha, const value_type* _a, size_type _a_stride, const value_type* _b, size_type _b_stride, value_type _beta, value_type* _c, size_type _c_stride)
+	{
+		if (_rows == 0 || _columns == 0)
+		{
+			return;
+		}
+		if (_inner == 0 || _alpha == static_cast<value_type>(0))
+		{
+			for (size_type row = 0; row < _rows; row++)
+			{
+				for (size_type column = 0; column < _columns; column++)
+				{
+					value_type& c = _c[row * _c_stride + column];
+					c = (_beta == static_cast<value_type>(0)) ? static_cast<value_type>(0) : _beta * c;
+				}
+			}
+			return;
+		}
+
+		const size_type row_blocks = (_rows + row_block - 1) / row_block;
+		const size_type grain = (_rows * _columns >= ARCH_PARALLEL_THRESHOLD) ? 1 : row_blocks;
+		buffer_type& packed_b = buffer<1>();
+		for (size_type column = 0; column < _columns; column += column_block)
+		{
+			const size_type column_size = min(column_block, _columns - column);
+			for (size_type inner = 0; inner < _inner; inner += inner_block)
+			{
+				const size_type inner_size = min(inner_block, _inner - inner);
+				const value_type beta = (inner == 0) ? _beta : static_cast<value_type>(1);
+				pack_b(_b + inner * _b_stride + column, _b_stride, inner_size, column_size, packed_b);
+				parallel_for(row_blocks, grain, [&](size_type _begin, size_type _end)
+				{
+					buffer_type& packed_a = buffer<0>();
+					for (size_type block = _begin; block < _end; block++)
+					{
+						const size_type row = block * row_block;
+						const size_type row_size = min(row_block, _rows - row);
+						pack_a(_a + row * _a_stride + inner, _a_stride, row_size, inner_size, _alpha, packed_a);
+						multiply_block(row_size, column_size, inner_size, packed_a.data(), packed_b.data(), beta, _c + row * _c_stride + column, _c_stride);
+					}
+				});
+			}
+		}
+	}
+
+private:
+	typedef std::vector<value_type, aligned_allocator<value_type>> buffer_type;
+
+	///	<summary>詰め直したAとBを置くスレッドごとの領域です。</summary>
+	template<size_t index> static buffer_type& buffer()
+	{
+		static thread_local buffer_type data;
+		return data;
+	}
+
+	///	<summary>Aの_row_size x _inner_sizeのブロックにalphaを掛け、tile_rows行ずつ内側の次元の順に並べます。端数の行は0で埋めます。</summary>
+	static void pack_a(const value_type* _a, size_type _stride, size_type _row_size, size_type _inner_size, value_type _alpha, buffer_type& _packed)
+	{
+		const size_type slivers = (_row_size + tile_rows - 1) / tile_rows;
+		_packed.resize(slivers * tile_rows * _inner_size);
+		value_type* packed = _packed.data();
+		for (size_type sliver = 0; sliver < slivers; sliver++)
+		{
+			const size_type row = sliver * tile_rows;
+			const size_type rows = min(tile_rows, _row_size - row);
+			for (size_type k = 0; k < _inner_size; k++)
+			{
+				for (size_type r = 0; r < tile_rows; r++)
+				{
+					packed[k * tile_rows + r] = (r < rows) ? _alpha * _a[(row + r) * _stride + k] : static_cast<value_type>(0);
+				}
+			}
+			packed += tile_rows * _inner_size;
+		}
+	}
+
+	///	<summary>Bの_inner_size x _column_sizeのブロックをtile_columns列ずつ内側の次元の順に並べます。端数の列は0で埋めます。</summary>
+	static void pack_b(const value_type* _b, size_type _stride, size_type _inner_size, size_type _column_size, buffer_type& _packed)
+	{
+		const size_type slivers = (_column_size + tile_columns - 1) / tile_columns;
+		_packed.resize(slivers * tile_columns * _inner_size);
+		value_type* packed = _packed.data();
+		for (size_type sliver = 0; sliver < slivers; sliver++)
+		{
+			const size_type column = sliver * tile_columns;
+			const size_type columns = min(tile_columns, _column_size - column);
+			for (size_type k = 0; k < _inner_size; k++)
+			{
+				const value_type* b = _b + k * _stride + column;
+				for (size_type c = 0; c < tile_columns; c++)
+				{
+					packed[k * tile_columns + c] = (c < columns) ? b[c] : static_cast<value_type>(0);
+				}
+			}
+			packed += tile_columns * _inner_size;
+		}
+	}
+
+	///	<summary>詰め直したAとBのブロックの積をCに書き込みます。端数のタイルは一時領域で求めてから有効な範囲だけ書き込みます。</summary>
+	static void multiply_block(size_type _row_size, size_type _column_size, size_type _inner_size, const value_type* _a, const value_type* _b, value_type _beta, value_type* _c, size_type _c_stride)
+	{
+		for (size_type column = 0; column < _column_size; column += tile_columns)
+		{
+			const size_type columns = min(tile_columns, _column_size - column);
+			const value_type* b = _b + column * _inner_size;
+			for (size_type row = 0; row < _row_size; row += tile_rows)
+			{
+				const size_type rows = min(tile_rows, _row_size - row);
+				const value_type* a = _a + row * _inner_size;
+				value_type* c = _c + row * _c_stride + column;
+				if (rows == tile_rows && columns == tile_columns)
+				{
+					multiply_tile(_inner_size, a, b, _beta, c, _c_stride);
+					continue;
+				}
+
+				value_type tile[tile_rows * tile_columns];
+				multiply_tile(_inner_size, a, b, static_cast<value_type>(0), tile, tile_columns);
+				for (size_type r = 0; r < rows; r++)
+				{
+					for (size_type j = 0; j < columns; j++)
+					{
+						value_type& target = c[r * _c_stride + j];
+						target = (_beta == static_cast<value_type>(0)) ? tile[r * tile_columns + j] : _beta * target + tile[r * tile_columns + j];
+					}
+				}
+			}
+		}
+	}
+
+	///	<summary>マイクロカーネルです。tile_rows x tile_columnsの累積をレジスタに保持し、内側の次元を1つずつ進めます。</summary>
+	static void multiply_tile(size_type _inner_size, const value_type* _a, const value_type* _b, value_type _beta, value_type* _c, size_type _c_stride)
+	{
+		pack_type sum[tile_rows][tile_packs];
+		auto clear = [&](size_type _index)
+		{
+			sum[_index / tile_packs][_index % tile_packs] = pack_type(static_cast<value_type>(0));
+		};
+		unroll<tile_rows * tile_packs>::apply(clear);
+
+		for (size_type k = 0; k < _inner_size; k++)
+		{
+			pack_type b[tile_packs];
+			auto load = [&](size_type _p)
+			{
+				b[_p] = pack_type::load(_b + k * tile_columns + _p * width);
+			};
+			unroll<tile_packs>::apply(load);
+			auto accumulate = [&](size_type _index)
+			{
+				const size_type r = _index / tile_packs, p = _index % tile_packs;
+				sum[r][p] = simd::fmadd(pack_type(_a[k * tile_rows + r]), b[p], sum[r][p]);
+			};
+			unroll<tile_rows * tile_packs>::apply(accumulate);
+		}
+
+		const pack_type beta(_beta);
+		const bool overwrite = _beta == static_cast<value_type>(0);
+		auto store = [&](size_type _index)
+		{
+			const size_type r = _index / tile_packs, p = _index % tile_packs;
+			value_type* c = _c + r * _c_stride + p * width;
+			(overwrite ? sum[r][p] : simd::fmadd(beta, pack_type::load(c), sum[r][p])).store(c);
+		};
+		unroll<tile_rows * tile_packs>::apply(store);
+	}
+};
+
+/*!
+*	@brief 行優先の行列積C = alpha * A * B + beta * Cを求めます。各_strideは行の間隔(要素数)です。
+*	Cは_aや_bと重なってはいけません。
+*/
+template<class value_type> inline void gemm(size_t _rows, size_t _columns, size_t _inner, value_type _alpha, const value_type* _a, size_t _a_stride, const value_type* _b, size_t _b_stride, value_type _beta, value_type* _c, size_t _c_stride)
+{
+	gemm_kernel<value_type>::multiply(_rows, _columns, _inner, _alpha, _a, _a_stride, _b, _b_stride, _beta, _c, _c_stride);
+}
+
+}
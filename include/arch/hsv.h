@@ -144,11 +144,11 @@ public:
 
 		s = m / max;
 
-		if (max == color.r)
+		if (max == c.r)
 		{
 			h = static_cast<type>(60.0) * (c.g - c.b) / m;
 		}
-		else if (max == color.b)
+		else if (max == c.g)
 		{
 			h = static_cast<type>(60.0) * (static_cast<type>(2.0) + (c.b - c.r) / m);
 		}
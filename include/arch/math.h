@@ -12,19 +12,32 @@
 
 #pragma once
 
+#include "aligned_allocator.h"
 #include "color_chart.h"
 #include "constants.h"
+#include "decomposition.h"
 #include "dimension.h"
+#include "dual_quaternion.h"
+#include "dynamic_matrix.h"
 #include "functions.h"
+#include "gemm.h"
 #include "hsv.h"
 #include "interpolation.h"
 #include "matrix.h"
 #include "matrix3x3.h"
 #include "matrix4x4.h"
 #include "metric_prefix.h"
+#include "parallel.h"
+#include "philox.h"
 #include "polar.h"
 #include "quaternion.h"
 #include "random.h"
+#include "random_fill.h"
+#include "rigid_transform.h"
 #include "scalar.h"
+#include "simd.h"
+#include "skinning.h"
+#include "soa_vector.h"
+#include "trigonometric.h"
 #include "value.h"
 #include "vector.h"
\ No newline at end of file
@@ -13,13 +13,389 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <initializer_list>
+#include <memory>
+#include "dynamic_matrix.h"
+#include "functions.h"
+#include "gemm.h"
+#include "simd.h"
 
 namespace arch
 {
 
+template<class T, size_t row_size, size_t column_size> class matrix;
+template<class left_type, class right_type> class matrix_product;
+
+/*!
+*	@brief 行列の式の要素型と行数、列数です。matrix_typeは式を評価した結果の型です。
+*/
+template<class type> struct matrix_traits;
+
+template<class T, size_t row_size, size_t column_size> struct matrix_traits<matrix<T, row_size, column_size>>
+{
+	typedef T value_type;
+	typedef matrix<T, row_size, column_size> matrix_type;
+	static const size_t rows = row_size;
+	static const size_t columns = column_size;
+};
+
+/*!
+*	@brief 行列の式の基底です。要素ごとの演算は代入されるまで評価されず、代入先へ1回のループでpack幅ずつ書き込まれます。
+*	派生クラスは行優先の通し番号_indexから始まるpack幅の要素を返すpacket<pack_type>(_index)を持ちます。
+*/
+template<class derived_type> class matrix_expression
+{
+public:
+	const derived_type& derived() const
+	{
+		return static_cast<const derived_type&>(*this);
+	}
+};
+
+/*!
+*	@brief 式を評価した結果をヒープに保持します。大きな行列でもスタックを使わず、ノードの複製では結果を共有します。
+*/
+template<class matrix_type> class matrix_temporary
+{
+public:
+	typedef typename matrix_type::value_type value_type;
+	typedef typename matrix_type::size_type size_type;
+
+public:
+	template<class expression_type> matrix_temporary(const expression_type& _expression)
+		: m_matrix(std::make_shared<matrix_type>(_expression))
+	{
+	}
+
+	const value_type* data() const
+	{
+		return m_matrix->data();
+	}
+
+	template<class pack_type> pack_type packet(size_type _index) const
+	{
+		return m_matrix->template packet<pack_type>(_index);
+	}
+
+private:
+	std::shared_ptr<const matrix_type> m_matrix;
+};
+
+/*!
+*	@brief 式のノードが被演算子を保持する型です。
+*	matrixは参照で、行列の積は評価した結果を、それ以外のノードは値で保持します。
+*/
+template<class type> struct matrix_operand
+{
+	typedef const type storage_type;
+};
+
+template<class T, size_t row_size, size_t column_size> struct matrix_operand<matrix<T, row_size, column_size>>
+{
+	typedef const matrix<T, row_size, column_size>& storage_type;
+};
+
+template<class left_type, class right_type> struct matrix_operand<matrix_product<left_type, right_type>>
+{
+	typedef const matrix_temporary<typename matrix_traits<matrix_product<left_type, right_type>>::matrix_type> storage_type;
+};
+
+/*!
+*	@brief 行列の積の被演算子を保持する型です。matrixは参照で、それ以外の式は評価した結果を保持します。
+*/
+template<class type> struct matrix_evaluated
+{
+	typedef const matrix_temporary<typename matrix_traits<type>::matrix_type> storage_type;
+};
+
+template<class T, size_t row_size, size_t column_size> struct matrix_evaluated<matrix<T, row_size, column_size>>
+{
+	typedef const matrix<T, row_size, column_size>& storage_type;
+};
+
+namespace operation
+{
+
+struct plus
+{
+	template<class type> static type apply(const type& _a, const type& _b)
+	{
+		return _a + _b;
+	}
+};
+
+struct minus
+{
+	template<class type> static type apply(const type& _a, const type& _b)
+	{
+		return _a - _b;
+	}
+};
+
+struct multiplies
+{
+	template<class type> static type apply(const type& _a, const type& _b)
+	{
+		return _a * _b;
+	}
+};
+
+struct divides
+{
+	template<class type> static type apply(const type& _a, const type& _b)
+	{
+		return _a / _b;
+	}
+};
+
+}
+
+/*!
+*	@brief 同じ大きさの2つの式の要素ごとの演算です。
+*/
+template<class operation_type, class left_type, class right_type>
+class matrix_binary : public matrix_expression<matrix_binary<operation_type, left_type, right_type>>
+{
+public:
+	typedef typename matrix_traits<left_type>::value_type value_type;
+	typedef size_t size_type;
+
+	static_assert(matrix_traits<left_type>::rows == matrix_traits<right_type>::rows && matrix_traits<left_type>::columns == matrix_traits<right_type>::columns, "matrix sizes do not match.");
+
+public:
+	matrix_binary(const left_type& _left, const right_type& _right)
+		: m_left(_left), m_right(_right)
+	{
+	}
+
+	template<class pack_type> pack_type packet(size_type _index) const
+	{
+		return operation_type::apply(m_left.template packet<pack_type>(_index), m_right.template packet<pack_type>(_index));
+	}
+
+private:
+	typename matrix_operand<left_type>::storage_type m_left;
+	typename matrix_operand<right_type>::storage_type m_right;
+};
+
+/*!
+*	@brief 式の全要素とスカラーの演算です。
+*/
+template<class operation_type, class expression_type>
+class matrix_scalar : public matrix_expression<matrix_scalar<operation_type, expression_type>>
+{
+public:
+	typedef typename matrix_traits<expression_type>::value_type value_type;
+	typedef size_t size_type;
+
+public:
+	matrix_scalar(const expression_type& _expression, const value_type& _scalar)
+		: m_expression(_expression), m_scalar(_scalar)
+	{
+	}
+
+	template<class pack_type> pack_type packet(size_type _index) const
+	{
+		return operation_type::apply(m_expression.template packet<pack_type>(_index), pack_type(m_scalar));
+	}
+
+private:
+	typename matrix_operand<expression_type>::storage_type m_expression;
+	value_type m_scalar;
+};
+
+/*!
+*	@brief 式の全要素の符号を反転します。
+*/
+template<class expression_type>
+class matrix_negate : public matrix_expression<matrix_negate<expression_type>>
+{
+public:
+	typedef typename matrix_traits<expression_type>::value_type value_type;
+	typedef size_t size_type;
+
+public:
+	explicit matrix_negate(const expression_type& _expression)
+		: m_expression(_expression)
+	{
+	}
+
+	template<class pack_type> pack_type packet(size_type _index) const
+	{
+		return -m_expression.template packet<pack_type>(_index);
+	}
+
+private:
+	typename matrix_operand<expression_type>::storage_type m_expression;
+};
+
+/*!
+*	@brief 行列の積です。要素ごとの式の中では先に評価され、代入では代入先に直接書き込みます。
+*	代入先が被演算子と同じ行列の場合だけ一時行列を経由します。
+*/
+template<class left_type, class right_type>
+class matrix_product : public matrix_expression<matrix_product<left_type, right_type>>
+{
+public:
+	typedef typename matrix_traits<left_type>::value_type value_type;
+	typedef size_t size_type;
+
+	static_assert(matrix_traits<left_type>::columns == matrix_traits<right_type>::rows, "matrix sizes do not match.");
+
+public:
+	matrix_product(const left_type& _left, const right_type& _right)
+		: m_left(_left), m_right(_right)
+	{
+	}
+
+	///	<summary>_dataが被演算子のいずれかと同じ領域かどうかを取得します。</summary>
+	bool aliases(const value_type* _data) const
+	{
+		return m_left.data() == _data || m_right.data() == _data;
+	}
+
+	/*!
+	*	@brief 被演算子と重ならない_resultに積を書き込みます。
+	*	積和の回数がgemm_threshold以上の場合は詰め直しを伴うgemmを、それより小さい場合は詰め直さずに直接求めます。
+	*/
+	void assign_to(value_type* _result) const
+	{
+		const size_type rows = matrix_traits<left_type>::rows;
+		const size_type inner = matrix_traits<left_type>::columns;
+		const size_type columns = matrix_traits<right_type>::columns;
+		if (rows * inner * columns >= gemm_threshold)
+		{
+			gemm(rows, columns, inner, static_cast<value_type>(1), m_left.data(), inner, m_right.data(), columns, static_cast<value_type>(0), _result, columns);
+		}
+		else
+		{
+			multiply(m_left.data(), m_right.data(), _result, rows, inner, columns);
+		}
+	}
+
+	///< これ以上の積和の回数でgemmを使います。これより小さい行列では詰め直しの時間が積の時間を上回ります。
+	static const size_type gemm_threshold = 64 * 64 * 64;
+
+private:
+	/*!
+	*	@brief _rows x _inner行列と_inner x _columns行列の積を求めます。
+	*	内側の次元と列をキャッシュに収まるブロックに分け、結果の4行 x 2pack幅(SIMD化されていない型では4列)をレジスタに保持して内側の次元を走査します。
+	*/
+	static void multiply(const value_type* _a, const value_type* _b, value_type* _result, size_type _rows, size_type _inner, size_type _columns)
+	{
+		const size_type inner_block = 128;
+		const size_type column_block = 256;
+		for (size_type i = 0; i < _rows * _columns; i++)
+		{
+			_result[i] = static_cast<value_type>(0);
+		}
+		for (size_type inner = 0; inner < _inner; inner += inner_block)
+		{
+			const size_type inner_size = min(inner_block, _inner - inner);
+			for (size_type column = 0; column < _columns; column += column_block)
+			{
+				const size_type column_size = min(column_block, _columns - column);
+				const value_type* a = _a + inner;
+				const value_type* b = _b + inner * _columns + column;
+				value_type* result = _result + column;
+				const size_type tiled_rows = _rows - _rows % 4;
+				size_type row = 0;
+				for (; row < tiled_rows; row += 4)
+				{
+					multiply_rows<4>(a + row * _inner, b, result + row * _columns, inner_size, column_size, _inner, _columns);
+				}
+				for (; row < _rows; row++)
+				{
+					multiply_rows<1>(a + row * _inner, b, result + row * _columns, inner_size, column_size, _inner, _columns);
+				}
+			}
+		}
+	}
+
+	///	<summary>結果のtile_rows行の_column_size列に、_aのtile_rows行と_bの_inner_size行の積を足し込みます。</summary>
+	template<size_t tile_rows> static void multiply_rows(const value_type* _a, const value_type* _b, value_type* _result, size_type _inner_size, size_type _column_size, size_type _a_stride, size_type _stride)
+	{
+		typedef simd::pack<value_type> pack_type;
+		const size_type width = pack_type::width;
+		const size_type tile_packs = (width == 1) ? 4 : 2;
+		const size_type tiled_size = _column_size - _column_size % (width * tile_packs);
+		const size_type packed_size = _column_size - _column_size % width;
+		size_type column = 0;
+		for (; column < tiled_size; column += width * tile_packs)
+		{
+			multiply_tile<tile_rows, tile_packs, pack_type>(_a, _b + column, _result + column, _inner_size, _a_stride, _stride);
+		}
+		for (; column < packed_size; column += width)
+		{
+			multiply_tile<tile_rows, 1, pack_type>(_a, _b + column, _result + column, _inner_size, _a_stride, _stride);
+		}
+		for (; column < _column_size; column++)
+		{
+			multiply_tile<tile_rows, 1, simd::scalar<value_type>>(_a, _b + column, _result + column, _inner_size, _a_stride, _stride);
+		}
+	}
+
+	template<size_t tile_rows, size_t tile_packs, class pack_type> static void multiply_tile(const value_type* _a, const value_type* _b, value_type* _result, size_type _inner_size, size_type _a_stride, size_type _stride)
+	{
+		const size_type width = pack_type::width;
+		pack_type sum[tile_rows][tile_packs];
+		for (size_type r = 0; r < tile_rows; r++)
+		{
+			for (size_type p = 0; p < tile_packs; p++)
+			{
+				sum[r][p] = pack_type::load(_result + r * _stride + p * width);
+			}
+		}
+		for (size_type k = 0; k < _inner_size; k++)
+		{
+			pack_type b[tile_packs];
+			for (size_type p = 0; p < tile_packs; p++)
+			{
+				b[p] = pack_type::load(_b + k * _stride + p * width);
+			}
+			for (size_type r = 0; r < tile_rows; r++)
+			{
+				const pack_type a(_a[r * _a_stride + k]);
+				for (size_type p = 0; p < tile_packs; p++)
+				{
+					sum[r][p] = simd::fmadd(a, b[p], sum[r][p]);
+				}
+			}
+		}
+		for (size_type r = 0; r < tile_rows; r++)
+		{
+			for (size_type p = 0; p < tile_packs; p++)
+			{
+				sum[r][p].store(_result + r * _stride + p * width);
+			}
+		}
+	}
+
+private:
+	typename matrix_evaluated<left_type>::storage_type m_left;
+	typename matrix_evaluated<right_type>::storage_type m_right;
+};
+
+template<class operation_type, class left_type, class right_type> struct matrix_traits<matrix_binary<operation_type, left_type, right_type>> : matrix_traits<typename matrix_traits<left_type>::matrix_type>
+{
+};
+
+template<class operation_type, class expression_type> struct matrix_traits<matrix_scalar<operation_type, expression_type>> : matrix_traits<typename matrix_traits<expression_type>::matrix_type>
+{
+};
+
+template<class expression_type> struct matrix_traits<matrix_negate<expression_type>> : matrix_traits<typename matrix_traits<expression_type>::matrix_type>
+{
+};
+
+template<class left_type, class right_type> struct matrix_traits<matrix_product<left_type, right_type>>
+	: matrix_traits<matrix<typename matrix_traits<left_type>::value_type, matrix_traits<left_type>::rows, matrix_traits<right_type>::columns>>
+{
+};
+
 template<class T, size_t row_size, size_t column_size>
-class matrix
+class matrix : public matrix_expression<matrix<T, row_size, column_size>>
 {
 public:
 	typedef typename std::array<T, row_size * column_size>::value_type value_type;
@@ -50,8 +426,52 @@ public:
 			itr++;
 		}
 	}
+
+	///	<summary>式を評価して初期化します。</summary>
+	template<class expression_type> matrix(const matrix_expression<expression_type>& _expression)
+	{
+		assign(_expression.derived());
+	}
+
 	~matrix() = default;
 
+	matrix(const matrix&) = default;
+	matrix& operator=(const matrix&) = default;
+
+	/*!
+	*	@brief 式を評価して代入します。要素ごとの演算は一時行列を作らずに1回のループで書き込みます。
+	*	要素ごとの演算は同じ位置の要素しか参照しないため、右辺に自身を含んでいても正しく評価されます。
+	*/
+	template<class expression_type> matrix& operator=(const matrix_expression<expression_type>& _expression)
+	{
+		assign(_expression.derived());
+		return *this;
+	}
+
+	template<class expression_type> matrix& operator+=(const matrix_expression<expression_type>& _expression)
+	{
+		assign(matrix_binary<operation::plus, matrix, expression_type>(*this, _expression.derived()));
+		return *this;
+	}
+
+	template<class expression_type> matrix& operator-=(const matrix_expression<expression_type>& _expression)
+	{
+		assign(matrix_binary<operation::minus, matrix, expression_type>(*this, _expression.derived()));
+		return *this;
+	}
+
+	matrix& operator*=(const value_type& _value)
+	{
+		assign(matrix_scalar<operation::multiplies, matrix>(*this, _value));
+		return *this;
+	}
+
+	matrix& operator/=(const value_type& _value)
+	{
+		assign(matrix_scalar<operation::divides, matrix>(*this, _value));
+		return *this;
+	}
+
 	iterator begin()
 	{
 		return m_elements.begin();
@@ -125,6 +545,35 @@ public:
 		return &m_elements[y * column_size];
 	}
 
+	///	<summary>要素を参照するmatrix_viewを取得します。BLASの関数や分解にそのまま渡せます。</summary>
+	matrix_view<value_type> view()
+	{
+		return matrix_view<value_type>(data(), row_size, column_size, column_size);
+	}
+
+	matrix_view<const value_type> view() const
+	{
+		return matrix_view<const value_type>(data(), row_size, column_size, column_size);
+	}
+
+	template<class pack_type> pack_type packet(size_type _index) const
+	{
+		return pack_type::load(data() + _index);
+	}
+
+	matrix<value_type, column_size, row_size> transpose() const
+	{
+		matrix<value_type, column_size, row_size> result;
+		for (size_type y = 0; y < row_size; y++)
+		{
+			for (size_type x = 0; x < column_size; x++)
+			{
+				result[x][y] = at(y, x);
+			}
+		}
+		return result;
+	}
+
 	bool is_symmetric() const
 	{
 		for (size_type y = 0; y < row_size; y++)
@@ -151,12 +600,12 @@ public:
 				mat[y][x] = static_cast<value_type>(0.0);
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	static constexpr matrix identity()
 	{
-		static_assert(row_size != column_size, "row size is not equal column size.");
+		static_assert(row_size == column_size, "row size is not equal column size.");
 		matrix<value_type, row_size, column_size> mat;
 		for (size_type y = 0; y < row_size; y++)
 		{
@@ -165,11 +614,72 @@ public:
 				mat[y][x] = static_cast<value_type>(y == x ? 1.0 : 0.0);
 			}
 		}
-		return std::move(mat);
+		return mat;
+	}
+
+private:
+	template<class expression_type> void assign(const expression_type& _expression)
+	{
+		value_type* result = data();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type _index)
+		{
+			typedef decltype(_pack) pack_type;
+			_expression.template packet<pack_type>(_index).store(result + _index);
+		});
+	}
+
+	template<class left_type, class right_type> void assign(const matrix_product<left_type, right_type>& _product)
+	{
+		if (_product.aliases(data()))
+		{
+			matrix result;
+			_product.assign_to(result.data());
+			*this = result;
+		}
+		else
+		{
+			_product.assign_to(data());
+		}
 	}
 
 private:
 	std::array<value_type, row_size * column_size> m_elements;
 };
 
+template<class left_type, class right_type> inline matrix_binary<operation::plus, left_type, right_type> operator +(const matrix_expression<left_type>& _left, const matrix_expression<right_type>& _right)
+{
+	return matrix_binary<operation::plus, left_type, right_type>(_left.derived(), _right.derived());
+}
+
+template<class left_type, class right_type> inline matrix_binary<operation::minus, left_type, right_type> operator -(const matrix_expression<left_type>& _left, const matrix_expression<right_type>& _right)
+{
+	return matrix_binary<operation::minus, left_type, right_type>(_left.derived(), _right.derived());
+}
+
+template<class expression_type> inline matrix_negate<expression_type> operator -(const matrix_expression<expression_type>& _expression)
+{
+	return matrix_negate<expression_type>(_expression.derived());
+}
+
+template<class expression_type> inline matrix_scalar<operation::multiplies, expression_type> operator *(const matrix_expression<expression_type>& _expression, const typename matrix_traits<expression_type>::value_type& _value)
+{
+	return matrix_scalar<operation::multiplies, expression_type>(_expression.derived(), _value);
+}
+
+template<class expression_type> inline matrix_scalar<operation::multiplies, expression_type> operator *(const typename matrix_traits<expression_type>::value_type& _value, const matrix_expression<expression_type>& _expression)
+{
+	return matrix_scalar<operation::multiplies, expression_type>(_expression.derived(), _value);
+}
+
+template<class expression_type> inline matrix_scalar<operation::divides, expression_type> operator /(const matrix_expression<expression_type>& _expression, const typename matrix_traits<expression_type>::value_type& _value)
+{
+	return matrix_scalar<operation::divides, expression_type>(_expression.derived(), _value);
+}
+
+///	<summary>行列の積です。代入またはほかの式に使われたときに評価されます。大きな行列ではgemmを使います。</summary>
+template<class left_type, class right_type> inline matrix_product<left_type, right_type> operator *(const matrix_expression<left_type>& _left, const matrix_expression<right_type>& _right)
+{
+	return matrix_product<left_type, right_type>(_left.derived(), _right.derived());
+}
+
 }
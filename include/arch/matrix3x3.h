@@ -12,6 +12,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "parallel.h"
+#include "quaternion.h"
+#include "simd.h"
+#include "trigonometric.h"
 #include "vector.h"
 
 namespace arch
@@ -43,6 +50,7 @@ public:
 
 public:
 	matrix3x3() = default;
+	matrix3x3(const matrix3x3&) = default;
 
 	constexpr matrix3x3(
 		value_type _11, value_type _12, value_type _13,
@@ -85,11 +93,10 @@ public:
 		return 9;
 	}
 
+	///	<summary>1行目を余因子展開して行列式を求めます。一括版のdeterminant()やinverse()のpackと同じ式です。</summary>
 	constexpr value_type determinant() const
 	{
-		return
-			_11 * _22 * _33 + _21 * _32 * _13 + _31 * _12 * _23 -
-			_31 * _22 * _13 - _21 * _12 * _33 - _11 * _32 * _23;
+		return expand(_11, _12, _13, difference(_22, _33, _23, _32), difference(_23, _31, _21, _33), difference(_21, _32, _22, _31));
 	}
 
 	constexpr matrix3x3 cofactor() const
@@ -130,17 +137,75 @@ public:
 				);
 	}
 
+	///	<summary>*this * _matrix^Tを求めます。転置した行列を作らずに行どうしの内積で求めます。</summary>
+	constexpr matrix3x3 multiply_transposed(const matrix3x3& _matrix) const
+	{
+		return matrix3x3<value_type>
+			(
+				_11 * _matrix._11 + _12 * _matrix._12 + _13 * _matrix._13,
+				_11 * _matrix._21 + _12 * _matrix._22 + _13 * _matrix._23,
+				_11 * _matrix._31 + _12 * _matrix._32 + _13 * _matrix._33,
+				_21 * _matrix._11 + _22 * _matrix._12 + _23 * _matrix._13,
+				_21 * _matrix._21 + _22 * _matrix._22 + _23 * _matrix._23,
+				_21 * _matrix._31 + _22 * _matrix._32 + _23 * _matrix._33,
+				_31 * _matrix._11 + _32 * _matrix._12 + _33 * _matrix._13,
+				_31 * _matrix._21 + _32 * _matrix._22 + _33 * _matrix._23,
+				_31 * _matrix._31 + _32 * _matrix._32 + _33 * _matrix._33
+				);
+	}
+
+	///	<summary>*this^T * _matrixを求めます。転置した行列を作らずに列どうしの内積で求めます。</summary>
+	constexpr matrix3x3 transposed_multiply(const matrix3x3& _matrix) const
+	{
+		return matrix3x3<value_type>
+			(
+				_11 * _matrix._11 + _21 * _matrix._21 + _31 * _matrix._31,
+				_11 * _matrix._12 + _21 * _matrix._22 + _31 * _matrix._32,
+				_11 * _matrix._13 + _21 * _matrix._23 + _31 * _matrix._33,
+				_12 * _matrix._11 + _22 * _matrix._21 + _32 * _matrix._31,
+				_12 * _matrix._12 + _22 * _matrix._22 + _32 * _matrix._32,
+				_12 * _matrix._13 + _22 * _matrix._23 + _32 * _matrix._33,
+				_13 * _matrix._11 + _23 * _matrix._21 + _33 * _matrix._31,
+				_13 * _matrix._12 + _23 * _matrix._22 + _33 * _matrix._32,
+				_13 * _matrix._13 + _23 * _matrix._23 + _33 * _matrix._33
+				);
+	}
+
+	/*!
+	*	@brief 法線の変換に使う逆行列の転置を求めます。行列式が0の場合は単位行列を返します。
+	*	逆行列の転置は余因子行列を行列式で割ったものなので、inverse().transpose()のように随伴行列を転置し直しません。
+	*/
+	matrix3x3 normal_matrix() const
+	{
+		const value_type c11 = _22 * _33 - _23 * _32;
+		const value_type c12 = _23 * _31 - _21 * _33;
+		const value_type c13 = _21 * _32 - _22 * _31;
+		const value_type determinant = _11 * c11 + _12 * c12 + _13 * c13;
+		if (determinant == static_cast<value_type>(0))
+		{
+			return identity();
+		}
+
+		const value_type reciprocal = static_cast<value_type>(1) / determinant;
+		return matrix3x3<value_type>
+			(
+				c11 * reciprocal, c12 * reciprocal, c13 * reciprocal,
+				(_13 * _32 - _12 * _33) * reciprocal, (_11 * _33 - _13 * _31) * reciprocal, (_12 * _31 - _11 * _32) * reciprocal,
+				(_12 * _23 - _13 * _22) * reciprocal, (_13 * _21 - _11 * _23) * reciprocal, (_11 * _22 - _12 * _21) * reciprocal
+				);
+	}
+
 	constexpr matrix3x3 rotated(value_type roll, value_type pitch, value_type yaw) const
 	{
 		return *this * rotation(roll, pitch, yaw);
 	}
 
-	constexpr matrix3x3 translated(value_type _x, value_type _y, value_type _z) const
+	constexpr matrix3x3 translated(value_type _x, value_type _y) const
 	{
-		return *this * translation(_x, _y, _z);
+		return *this * translation(_x, _y);
 	}
 
-	constexpr matrix3x3 translated(const vector3<value_type>& _offset) const
+	constexpr matrix3x3 translated(const vector2<value_type>& _offset) const
 	{
 		return *this * translation(_offset);
 	}
@@ -155,6 +220,61 @@ public:
 				);
 	}
 
+	///	<summary>2次元の同次座標としてz = 1で変換します(平行移動を含みます)。</summary>
+	constexpr vector2<value_type> transform_point(const vector2<value_type>& _vector) const
+	{
+		return vector2<value_type>
+			(
+				_11 * _vector.x + _12 * _vector.y + _13,
+				_21 * _vector.x + _22 * _vector.y + _23
+				);
+	}
+
+	///	<summary>2次元の同次座標としてz = 0で変換します(平行移動を含みません)。</summary>
+	constexpr vector2<value_type> transform_direction(const vector2<value_type>& _vector) const
+	{
+		return vector2<value_type>
+			(
+				_11 * _vector.x + _12 * _vector.y,
+				_21 * _vector.x + _22 * _vector.y
+				);
+	}
+
+	///	<summary>2次元の同次座標としてz = 1で変換し、結果をzで割ります。</summary>
+	constexpr vector2<value_type> transform_homogeneous(const vector2<value_type>& _vector) const
+	{
+		return vector2<value_type>
+			(
+				_11 * _vector.x + _12 * _vector.y + _13,
+				_21 * _vector.x + _22 * _vector.y + _23
+				) / (_31 * _vector.x + _32 * _vector.y + _33);
+	}
+
+	/*!
+	*	@brief _count個のベクトルを一括で変換します。各関数の結果は1要素版と同じです。
+	*	行列の列をレジスタに置いたまま各ベクトルをSIMDで変換し、ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*	_inputと_outputは同じ配列でも構いません。
+	*/
+	void transform(const vector3<value_type>* _input, vector3<value_type>* _output, size_type _count) const
+	{
+		transform<3, 3, false>(reinterpret_cast<const value_type*>(_input), reinterpret_cast<value_type*>(_output), _count, static_cast<value_type>(0.0));
+	}
+
+	void transform_point(const vector2<value_type>* _input, vector2<value_type>* _output, size_type _count) const
+	{
+		transform<2, 2, false>(reinterpret_cast<const value_type*>(_input), reinterpret_cast<value_type*>(_output), _count, static_cast<value_type>(1.0));
+	}
+
+	void transform_direction(const vector2<value_type>* _input, vector2<value_type>* _output, size_type _count) const
+	{
+		transform<2, 2, false>(reinterpret_cast<const value_type*>(_input), reinterpret_cast<value_type*>(_output), _count, static_cast<value_type>(0.0));
+	}
+
+	void transform_homogeneous(const vector2<value_type>* _input, vector2<value_type>* _output, size_type _count) const
+	{
+		transform<2, 2, true>(reinterpret_cast<const value_type*>(_input), reinterpret_cast<value_type*>(_output), _count, static_cast<value_type>(1.0));
+	}
+
 public:
 	constexpr matrix3x3& operator=(const matrix3x3& _matrix)
 	{
@@ -178,7 +298,7 @@ public:
 				mat.data[y][x] = data[y][x] + _matrix.data[y][x];
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	constexpr matrix3x3& operator+=(const matrix3x3& _matrix)
@@ -203,7 +323,7 @@ public:
 				mat.data[y][x] = data[y][x] - _matrix.data[y][x];
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	constexpr matrix3x3& operator-=(const matrix3x3& _matrix)
@@ -231,7 +351,7 @@ public:
 				}
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	constexpr matrix3x3 operator*(value_type value) const
@@ -244,7 +364,7 @@ public:
 				mat.data[y][x] = data[y][x] * value;
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	constexpr matrix3x3& operator*=(const matrix3x3& _matrix)
@@ -275,7 +395,7 @@ public:
 				mat.data[y][x] = data[y][x] / value;
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	constexpr matrix3x3& operator/=(value_type value)
@@ -330,7 +450,7 @@ public:
 				mat.data[y][x] = data[y][x];
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	constexpr matrix3x3 operator-() const
@@ -343,7 +463,7 @@ public:
 				mat.data[y][x] = -data[y][x];
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	constexpr value_type operator()(size_type _row, size_type _column) const
@@ -387,30 +507,31 @@ public:
 				);
 	}
 
-	static constexpr matrix3x3 translation(value_type x, value_type y, value_type z)
+	///	<summary>2次元の平行移動行列です。移動量は3列目(_13, _23)に入り、transform_pointと対応します。</summary>
+	static constexpr matrix3x3 translation(value_type x, value_type y)
 	{
 		return matrix3x3<value_type>
 			(
-				static_cast<value_type>(1.0), static_cast<value_type>(0.0), static_cast<value_type>(0.0),
-				static_cast<value_type>(0.0), static_cast<value_type>(1.0), static_cast<value_type>(0.0),
-				x, y, z
+				static_cast<value_type>(1.0), static_cast<value_type>(0.0), x,
+				static_cast<value_type>(0.0), static_cast<value_type>(1.0), y,
+				static_cast<value_type>(0.0), static_cast<value_type>(0.0), static_cast<value_type>(1.0)
 				);
 	}
 
-	static constexpr matrix3x3 translation(const vector3<value_type>& offset)
+	static constexpr matrix3x3 translation(const vector2<value_type>& offset)
 	{
 		return matrix3x3<value_type>
 			(
-				static_cast<value_type>(1.0), static_cast<value_type>(0.0), static_cast<value_type>(0.0),
-				static_cast<value_type>(0.0), static_cast<value_type>(1.0), static_cast<value_type>(0.0),
-				offset.x, offset.y, offset.z
+				static_cast<value_type>(1.0), static_cast<value_type>(0.0), offset.x,
+				static_cast<value_type>(0.0), static_cast<value_type>(1.0), offset.y,
+				static_cast<value_type>(0.0), static_cast<value_type>(0.0), static_cast<value_type>(1.0)
 				);
 	}
 
 	static matrix3x3 roll(value_type roll)
 	{
-		const value_type roll_sin = sin(roll);
-		const value_type roll_cos = cos(roll);
+		value_type roll_sin, roll_cos;
+		sincos(roll, roll_sin, roll_cos);
 
 		return matrix3x3<value_type>
 			(
@@ -422,8 +543,8 @@ public:
 
 	static matrix3x3 pitch(value_type pitch)
 	{
-		const value_type pitch_sin = sin(pitch);
-		const value_type pitch_cos = cos(pitch);
+		value_type pitch_sin, pitch_cos;
+		sincos(pitch, pitch_sin, pitch_cos);
 
 		return matrix3x3<value_type>
 			(
@@ -435,8 +556,8 @@ public:
 
 	static matrix3x3 yaw(value_type yaw)
 	{
-		const value_type yaw_sin = sin(yaw);
-		const value_type yaw_cos = cos(yaw);
+		value_type yaw_sin, yaw_cos;
+		sincos(yaw, yaw_sin, yaw_cos);
 
 		return matrix3x3<value_type>
 			(
@@ -448,22 +569,1101 @@ public:
 
 	static matrix3x3 rotation(value_type roll, value_type pitch, value_type yaw)
 	{
-		const value_type roll_sin = sin(roll);
-		const value_type roll_cos = cos(roll);
-		const value_type pitch_sin = sin(pitch);
-		const value_type pitch_cos = cos(pitch);
-		const value_type yaw_sin = sin(yaw);
-		const value_type yaw_cos = cos(yaw);
+		vector3<value_type> sin, cos;
+		sincos(vector3<value_type>(roll, pitch, yaw), sin, cos);
+		return rotation(sin, cos);
+	}
+
+	/*!
+	*	@brief _count組の角度から回転行列をまとめて作ります。sin/cosはsincosでpack幅ずつ求めます。
+	*	ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*/
+	static void rotation(const value_type* _roll, const value_type* _pitch, const value_type* _yaw, matrix3x3* _result, size_type _count)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			const size_type block = 256;
+			value_type sin[3][block], cos[3][block];
+			for (size_type begin = _begin; begin < _end; begin += block)
+			{
+				const size_type size = min(block, _end - begin);
+				sincos(_roll + begin, sin[0], cos[0], size);
+				sincos(_pitch + begin, sin[1], cos[1], size);
+				sincos(_yaw + begin, sin[2], cos[2], size);
+				for (size_type i = 0; i < size; i++)
+				{
+					_result[begin + i] = rotation(vector3<value_type>(sin[0][i], sin[1][i], sin[2][i]), vector3<value_type>(cos[0][i], cos[1][i], cos[2][i]));
+				}
+			}
+		});
+	}
+
+	/*!
+	*	@brief _count個の行列の逆行列をまとめて求めます。行列を成分ごとの配列に並べ替え、packの各レーンが1つの行列を処理します。
+	*	行列式が0の行列には単位行列を書き込み、_singularの対応する要素をtrueにします。_determinantと_singularはnullptrでも構いません。
+	*	単体のinverse()と同じく行列式が厳密に0の場合だけを特異とするため、閾値が必要な場合は_determinantを使ってください。
+	*	行列式はpackの中でdeterminant()と同じ式から求めるため、_singularと_determinantは単体のinverse()と一致します。
+	*	ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*/
+	static void inverse(const matrix3x3* _input, matrix3x3* _result, value_type* _determinant, bool* _singular, size_type _count)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			for (size_type i = _begin; i < _end; i += batch_size)
+			{
+				inverse<true>(_input + i, _result + i, _determinant != nullptr ? _determinant + i : nullptr, _singular != nullptr ? _singular + i : nullptr, min(batch_size, _end - i));
+			}
+		});
+	}
+
+	///	<summary>_count個の行列の行列式をまとめて求めます。</summary>
+	static void determinant(const matrix3x3* _input, value_type* _result, size_type _count)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			for (size_type i = _begin; i < _end; i += batch_size)
+			{
+				inverse<false>(_input + i, nullptr, _result + i, nullptr, min(batch_size, _end - i));
+			}
+		});
+	}
+
+	/*!
+	*	@brief 対称行列の固有値と正規直交な固有ベクトルを求めます。上三角(_11, _12, _13, _22, _23, _33)だけを読みます。
+	*	固有値を降順で_valuesに、対応する固有ベクトルを_vectors[0]から_vectors[2]に書き込みます。固有ベクトルは右手系をなします。
+	*	三次方程式から最も孤立した固有値を求めて(A - λI)の行の外積からその固有ベクトルを求め、
+	*	残りの2つはその直交補空間に射影した2x2行列を1回のJacobi回転で対角化して求めます。
+	*	3つの固有値がほぼ等しく外積が信頼できない場合だけ、巡回Jacobi法で求め直します。
+	*/
+	void eigen_symmetric(vector3<value_type>& _values, vector3<value_type>* _vectors) const
+	{
+		typedef simd::scalar<value_type> pack_type;
+		pack_type values[3], vectors[9];
+		value_type* result[12];
+		for (size_type k = 0; k < 3; k++)
+		{
+			result[k] = &_values.data[k];
+		}
+		for (size_type k = 0; k < 9; k++)
+		{
+			result[3 + k] = &_vectors[k / 3].data[k % 3];
+		}
+
+		if (eigen_symmetric(pack_type(_11), pack_type(_12), pack_type(_13), pack_type(_22), pack_type(_23), pack_type(_33), values, vectors))
+		{
+			value_type jacobi[12];
+			eigen_jacobi(_11, _12, _13, _22, _23, _33, jacobi);
+			for (size_type k = 0; k < 12; k++)
+			{
+				*result[k] = jacobi[k];
+			}
+			return;
+		}
+		for (size_type k = 0; k < 3; k++)
+		{
+			*result[k] = values[k].value;
+		}
+		for (size_type k = 0; k < 9; k++)
+		{
+			*result[3 + k] = vectors[k].value;
+		}
+	}
+
+	/*!
+	*	@brief _count個の対称行列の固有値と固有ベクトルを、1要素版と同じ方法でまとめて求めます。
+	*	_valuesには_count個、_vectorsには3 * _count個の領域が必要で、i番目の行列の固有ベクトルは_vectors[3 * i]から並びます。
+	*	行列を成分ごとの配列に並べ替え、packの各レーンが1つの行列を処理します。ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*/
+	static void eigen_symmetric(const matrix3x3* _input, vector3<value_type>* _values, vector3<value_type>* _vectors, size_type _count)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			for (size_type i = _begin; i < _end; i += batch_size)
+			{
+				eigen_symmetric_block(_input + i, _values + i, _vectors + i * 3, min(batch_size, _end - i));
+			}
+		});
+	}
+
+	/*!
+	*	@brief 特異値分解 A = U diag(σ) V^T を求めます。UとVは回転行列(行列式が+1)です。
+	*	σは降順で、σ.xとσ.yは0以上、σ.zは行列式の符号を持ちます。
+	*	McAdamsらの方法に従い、A^T Aを近似Givens回転による固定回数のJacobi掃引で対角化してVを求め、
+	*	AVの列をノルムの降順に並べてGivens回転によるQR分解でUとσを求めます。分岐がないため、一括版ではpackの各レーンが1つの行列を処理します。
+	*/
+	void svd(matrix3x3& _u, vector3<value_type>& _sigma, matrix3x3& _v) const
+	{
+		typedef simd::scalar<value_type> pack_type;
+		pack_type input[9], u[4], sigma[3], v[4], result[9];
+		for (size_type k = 0; k < 9; k++)
+		{
+			input[k] = pack_type(data[k / 3][k % 3]);
+		}
+		svd(input, u, sigma, v);
+		rotation_matrix(u, result);
+		for (size_type k = 0; k < 9; k++)
+		{
+			_u.data[k / 3][k % 3] = result[k].value;
+		}
+		rotation_matrix(v, result);
+		for (size_type k = 0; k < 9; k++)
+		{
+			_v.data[k / 3][k % 3] = result[k].value;
+		}
+		for (size_type k = 0; k < 3; k++)
+		{
+			_sigma.data[k] = sigma[k].value;
+		}
+	}
+
+	/*!
+	*	@brief _count個の行列の特異値分解を、1要素版と同じ方法でまとめて求めます。
+	*	行列を成分ごとの配列に並べ替え、packの各レーンが1つの行列を処理します。ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*/
+	static void svd(const matrix3x3* _input, matrix3x3* _u, vector3<value_type>* _sigma, matrix3x3* _v, size_type _count)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			for (size_type i = _begin; i < _end; i += batch_size)
+			{
+				svd_block(_input + i, _u + i, _sigma + i, _v + i, nullptr, nullptr, min(batch_size, _end - i));
+			}
+		});
+	}
+
+	/*!
+	*	@brief 極分解 A = RS の回転Rをクォータニオンで返します。_stretchがnullptrでなければ対称行列Sを書き込みます。
+	*	特異値分解からR = UV^T、S = V diag(σ) V^Tとして求めるため、Rは常に回転で、行列式が負の場合はSが負の固有値を1つ持ちます。
+	*	返すクォータニオンは正規化済みでw >= 0です。
+	*/
+	quaternion<value_type> polar(matrix3x3* _stretch = nullptr) const
+	{
+		typedef simd::scalar<value_type> pack_type;
+		pack_type input[9], u[4], sigma[3], v[4], rotation[4], stretch[9];
+		for (size_type k = 0; k < 9; k++)
+		{
+			input[k] = pack_type(data[k / 3][k % 3]);
+		}
+		svd(input, u, sigma, v);
+		polar(u, sigma, v, rotation, _stretch != nullptr ? stretch : nullptr);
+		if (_stretch != nullptr)
+		{
+			for (size_type k = 0; k < 9; k++)
+			{
+				_stretch->data[k / 3][k % 3] = stretch[k].value;
+			}
+		}
+		return quaternion<value_type>(rotation[0].value, rotation[1].value, rotation[2].value, rotation[3].value);
+	}
+
+	/*!
+	*	@brief _count個の行列の極分解を、1要素版と同じ方法でまとめて求めます。_stretchはnullptrでも構いません。
+	*	行列を成分ごとの配列に並べ替え、packの各レーンが1つの行列を処理します。ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*/
+	static void polar(const matrix3x3* _input, quaternion<value_type>* _rotation, matrix3x3* _stretch, size_type _count)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			for (size_type i = _begin; i < _end; i += batch_size)
+			{
+				svd_block(_input + i, nullptr, nullptr, nullptr, _rotation + i, _stretch != nullptr ? _stretch + i : nullptr, min(batch_size, _end - i));
+			}
+		});
+	}
+
+	//conjugate();
+private:
+	///< 一括演算で一度に成分ごとの配列へ並べ替える行列の数
+	static const size_type batch_size = 64;
+
+	/*!
+	*	@brief _a * _b - _c * _d を求めます。typeはvalue_typeかsimd::pack<value_type>です。
+	*	積を順に変数へ置き、FMAへの縮約のされ方をスカラーとpackでそろえます。
+	*/
+	template<class element_type> static constexpr element_type difference(const element_type& _a, const element_type& _b, const element_type& _c, const element_type& _d)
+	{
+		const element_type ab = _a * _b;
+		const element_type cd = _c * _d;
+		return ab - cd;
+	}
+
+	///	<summary>1行目(_11, _12, _13)と、対応する余因子(_c11, _c12, _c13)から行列式を求めます。</summary>
+	template<class element_type> static constexpr element_type expand(const element_type& _11, const element_type& _12, const element_type& _13, const element_type& _c11, const element_type& _c12, const element_type& _c13)
+	{
+		const element_type t1 = _11 * _c11;
+		const element_type t2 = _12 * _c12;
+		const element_type t3 = _13 * _c13;
+		return t1 + t2 + t3;
+	}
+
+	/*!
+	*	@brief batch_size個以下の行列を成分ごとの配列に並べ替え、pack幅ずつ逆行列と行列式を求めます。
+	*	pack幅に満たない端数は単位行列で埋めて同じpackで処理します。compute_inverseがfalseの場合は行列式だけを求めます。
+	*	行列式はdeterminant()と同じdifference()とexpand()で求めます。SIMD化されていない型では並べ替えずに単体のinverse()を呼びます。
+	*/
+	template<bool compute_inverse> static void inverse(const matrix3x3* _input, matrix3x3* _result, value_type* _determinant, bool* _singular, size_type _count)
+	{
+		if (!simd::packed4<value_type>::value)
+		{
+			// 1レーンしかない場合は並べ替えずに1つずつ求めます。
+			for (size_type j = 0; j < _count; j++)
+			{
+				value_type determinant;
+				if (compute_inverse)
+				{
+					_result[j] = _input[j].inverse(determinant);
+				}
+				else
+				{
+					determinant = _input[j].determinant();
+				}
+				if (_determinant != nullptr)
+				{
+					_determinant[j] = determinant;
+				}
+				if (_singular != nullptr)
+				{
+					_singular[j] = determinant == static_cast<value_type>(0);
+				}
+			}
+			return;
+		}
+
+		typedef simd::pack<value_type> pack_type;
+		const size_type width = pack_type::width;
+		const size_type padded = (_count + width - 1) / width * width;
+		const size_type pitch = batch_size + width;
+		value_type lanes[9][pitch];
+		value_type determinants[pitch];
+		size_type j = 0;
+		for (; j + 4 <= _count; j += 4)
+		{
+			simd::aos_to_soa4<9>(reinterpret_cast<const value_type*>(_input + j), lanes[0] + j, pitch);
+		}
+		for (; j < _count; j++)
+		{
+			for (size_type k = 0; k < 9; k++)
+			{
+				lanes[k][j] = _input[j].data[k / 3][k % 3];
+			}
+		}
+		for (j = _count; j < padded; j++)
+		{
+			for (size_type k = 0; k < 9; k++)
+			{
+				lanes[k][j] = (k % 4 == 0) ? static_cast<value_type>(1) : static_cast<value_type>(0);
+			}
+		}
+
+		const pack_type zero(static_cast<value_type>(0)), one(static_cast<value_type>(1));
+		for (size_type i = 0; i < padded; i += width)
+		{
+			const pack_type m11 = pack_type::load(lanes[0] + i);
+			const pack_type m12 = pack_type::load(lanes[1] + i);
+			const pack_type m13 = pack_type::load(lanes[2] + i);
+			const pack_type m21 = pack_type::load(lanes[3] + i);
+			const pack_type m22 = pack_type::load(lanes[4] + i);
+			const pack_type m23 = pack_type::load(lanes[5] + i);
+			const pack_type m31 = pack_type::load(lanes[6] + i);
+			const pack_type m32 = pack_type::load(lanes[7] + i);
+			const pack_type m33 = pack_type::load(lanes[8] + i);
+
+			const pack_type a0 = difference(m22, m33, m23, m32);
+			const pack_type a3 = difference(m23, m31, m21, m33);
+			const pack_type a6 = difference(m21, m32, m22, m31);
+			const pack_type determinant = expand(m11, m12, m13, a0, a3, a6);
+			determinant.store(determinants + i);
+			if (!compute_inverse)
+			{
+				continue;
+			}
+
+			const auto singular = determinant == zero;
+			const pack_type reciprocal = one / simd::select(singular, one, determinant);
+			auto store = [&](size_type _k, const pack_type& _adjugate)
+			{
+				simd::select(singular, (_k % 4 == 0) ? one : zero, _adjugate * reciprocal).store(lanes[_k] + i);
+			};
+			store(0, a0);
+			store(1, m13 * m32 - m12 * m33);
+			store(2, m12 * m23 - m13 * m22);
+			store(3, a3);
+			store(4, m11 * m33 - m13 * m31);
+			store(5, m13 * m21 - m11 * m23);
+			store(6, a6);
+			store(7, m12 * m31 - m11 * m32);
+			store(8, m11 * m22 - m12 * m21);
+		}
+
+		for (j = 0; j < _count; j++)
+		{
+			if (_determinant != nullptr)
+			{
+				_determinant[j] = determinants[j];
+			}
+			if (_singular != nullptr)
+			{
+				_singular[j] = determinants[j] == static_cast<value_type>(0);
+			}
+		}
+		if (compute_inverse)
+		{
+			for (j = 0; j + 4 <= _count; j += 4)
+			{
+				simd::soa_to_aos4<9>(lanes[0] + j, reinterpret_cast<value_type*>(_result + j), pitch);
+			}
+			for (; j < _count; j++)
+			{
+				for (size_type k = 0; k < 9; k++)
+				{
+					_result[j].data[k / 3][k % 3] = lanes[k][j];
+				}
+			}
+		}
+	}
+
+	///	<summary>batch_size個以下の行列の固有値と固有ベクトルを、成分ごとの配列に並べ替えてpack幅ずつ求めます。</summary>
+	static void eigen_symmetric_block(const matrix3x3* _input, vector3<value_type>* _values, vector3<value_type>* _vectors, size_type _count)
+	{
+		if (!simd::packed4<value_type>::value)
+		{
+			for (size_type j = 0; j < _count; j++)
+			{
+				_input[j].eigen_symmetric(_values[j], _vectors + j * 3);
+			}
+			return;
+		}
+
+		typedef simd::pack<value_type> pack_type;
+		const size_type width = pack_type::width;
+		const size_type padded = (_count + width - 1) / width * width;
+		const size_type pitch = batch_size + width;
+		value_type lanes[9][pitch];
+		value_type results[12][pitch];
+		value_type fallbacks[pitch];
+		size_type j = 0;
+		for (; j + 4 <= _count; j += 4)
+		{
+			simd::aos_to_soa4<9>(reinterpret_cast<const value_type*>(_input + j), lanes[0] + j, pitch);
+		}
+		for (; j < _count; j++)
+		{
+			for (size_type k = 0; k < 9; k++)
+			{
+				lanes[k][j] = _input[j].data[k / 3][k % 3];
+			}
+		}
+		for (j = _count; j < padded; j++)
+		{
+			for (size_type k = 0; k < 9; k++)
+			{
+				lanes[k][j] = (k % 4 == 0) ? static_cast<value_type>(1) : static_cast<value_type>(0);
+			}
+		}
+
+		const pack_type zero(static_cast<value_type>(0)), one(static_cast<value_type>(1));
+		for (size_type i = 0; i < padded; i += width)
+		{
+			pack_type values[3], vectors[9];
+			const auto fallback = eigen_symmetric(pack_type::load(lanes[0] + i), pack_type::load(lanes[1] + i), pack_type::load(lanes[2] + i), pack_type::load(lanes[4] + i), pack_type::load(lanes[5] + i), pack_type::load(lanes[8] + i), values, vectors);
+			for (size_type k = 0; k < 3; k++)
+			{
+				values[k].store(results[k] + i);
+			}
+			for (size_type k = 0; k < 9; k++)
+			{
+				vectors[k].store(results[3 + k] + i);
+			}
+			simd::select(fallback, one, zero).store(fallbacks + i);
+		}
+		for (j = 0; j < _count; j++)
+		{
+			if (fallbacks[j] != static_cast<value_type>(0))
+			{
+				value_type jacobi[12];
+				eigen_jacobi(lanes[0][j], lanes[1][j], lanes[2][j], lanes[4][j], lanes[5][j], lanes[8][j], jacobi);
+				for (size_type k = 0; k < 12; k++)
+				{
+					results[k][j] = jacobi[k];
+				}
+			}
+		}
+
+		for (j = 0; j + 4 <= _count; j += 4)
+		{
+			simd::soa_to_aos4<3>(results[0] + j, reinterpret_cast<value_type*>(_values + j), pitch);
+			simd::soa_to_aos4<9>(results[3] + j, reinterpret_cast<value_type*>(_vectors + j * 3), pitch);
+		}
+		for (; j < _count; j++)
+		{
+			for (size_type k = 0; k < 3; k++)
+			{
+				_values[j].data[k] = results[k][j];
+			}
+			for (size_type k = 0; k < 9; k++)
+			{
+				_vectors[j * 3 + k / 3].data[k % 3] = results[3 + k][j];
+			}
+		}
+	}
+
+	/*!
+	*	@brief packの各レーンの対称行列の固有値(降順)を_values[0..2]に、固有ベクトルを_vectors[0..8]に3成分ずつ書き込みます。
+	*	外積が信頼できずeigen_jacobiで求め直す必要があるレーンを返します。
+	*/
+	template<class pack_type> static typename pack_type::mask_type eigen_symmetric(pack_type _a11, pack_type _a12, pack_type _a13, pack_type _a22, pack_type _a23, pack_type _a33, pack_type* _values, pack_type* _vectors)
+	{
+		typedef typename pack_type::mask_type mask_type;
+		const pack_type zero(static_cast<value_type>(0)), one(static_cast<value_type>(1)), two(static_cast<value_type>(2)), three(static_cast<value_type>(3));
+
+		// 最大の絶対値で正規化し、二乗のオーバーフローとアンダーフローを避けます。
+		const pack_type largest = simd::max(simd::max(simd::max(simd::abs(_a11), simd::abs(_a12)), simd::max(simd::abs(_a13), simd::abs(_a22))), simd::max(simd::abs(_a23), simd::abs(_a33)));
+		const pack_type scale = simd::select(largest == zero, one, largest);
+		const pack_type reciprocal = one / scale;
+		const pack_type a11 = _a11 * reciprocal, a12 = _a12 * reciprocal, a13 = _a13 * reciprocal;
+		const pack_type a22 = _a22 * reciprocal, a23 = _a23 * reciprocal, a33 = _a33 * reciprocal;
+
+		// C = (A - mI) / pの固有値yはy^3 - 3y - 2r = 0の根です(r = det(C) / 2)。以降はCで計算し、固有値をp倍してmを足します。
+		// p^2が正規化数に満たない場合は3つの固有値がほぼ等しいため、Jacobi法に任せます。
+		const pack_type m = (a11 + a22 + a33) * pack_type(static_cast<value_type>(1.0 / 3.0));
+		const pack_type b11 = a11 - m, b22 = a22 - m, b33 = a33 - m;
+		const pack_type p2 = (b11 * b11 + b22 * b22 + b33 * b33 + two * (a12 * a12 + a13 * a13 + a23 * a23)) * pack_type(static_cast<value_type>(1.0 / 6.0));
+		const mask_type degenerate = !(p2 >= pack_type(std::numeric_limits<value_type>::min()));
+		const pack_type p = simd::select(degenerate, one, simd::sqrt(p2));
+		const pack_type inverse_p = one / p;
+		const pack_type c11 = b11 * inverse_p, c22 = b22 * inverse_p, c33 = b33 * inverse_p;
+		const pack_type c12 = a12 * inverse_p, c13 = a13 * inverse_p, c23 = a23 * inverse_p;
+		const pack_type determinant = c11 * (c22 * c33 - c23 * c23) - c12 * (c12 * c33 - c23 * c13) + c13 * (c12 * c23 - c22 * c13);
+		const pack_type r = simd::min(simd::max(determinant * pack_type(static_cast<value_type>(0.5)), -one), one);
+
+		// 絶対値が最大の根が最も孤立した固有値です。|r|に対するその根は[√3, 2]にあり、両端で一致する一次式を初期値にニュートン法で求めます。
+		const pack_type t = simd::abs(r);
+		pack_type y = simd::fmadd(t, pack_type(static_cast<value_type>(2.0 - 1.7320508075688772)), pack_type(static_cast<value_type>(1.7320508075688772)));
+		for (int iteration = 0; iteration < 3; iteration++)
+		{
+			y = y - (y * (y * y - three) - two * t) / (three * (y * y - one));
+		}
+		const mask_type largest_isolated = r >= zero;
+		const pack_type shift = simd::select(largest_isolated, y, -y);
+
+		// (C - shift I)の行どうしの外積のうち最も長いものを孤立した固有値の固有ベクトルにします。
+		const pack_type r11 = c11 - shift, r22 = c22 - shift, r33 = c33 - shift;
+		pack_type vx = c12 * c23 - c13 * r22, vy = c13 * c12 - r11 * c23, vz = r11 * r22 - c12 * c12;
+		pack_type length = vx * vx + vy * vy + vz * vz;
+		auto choose = [&](const pack_type& _x, const pack_type& _y, const pack_type& _z)
+		{
+			const pack_type candidate = _x * _x + _y * _y + _z * _z;
+			const mask_type longer = candidate > length;
+			vx = simd::select(longer, _x, vx);
+			vy = simd::select(longer, _y, vy);
+			vz = simd::select(longer, _z, vz);
+			length = simd::max(candidate, length);
+		};
+		choose(c12 * r33 - c13 * c23, c13 * c13 - r11 * r33, r11 * c23 - c12 * c13);
+		choose(r22 * r33 - c23 * c23, c23 * c13 - c12 * r33, c12 * c23 - r22 * c13);
+
+		// 正しく求まった外積の長さの二乗は4以上になります。
+		const mask_type fallback = degenerate | !(length > one);
+		const pack_type normalizer = one / simd::sqrt(simd::select(fallback, one, length));
+		vx = vx * normalizer;
+		vy = vy * normalizer;
+		vz = vz * normalizer;
+
+		// vに直交する正規直交基底u, w = v x u
+		const mask_type x_larger = simd::abs(vx) > simd::abs(vy);
+		pack_type ux = simd::select(x_larger, -vz, zero), uy = simd::select(x_larger, zero, vz), uz = simd::select(x_larger, vx, -vy);
+		const pack_type u_normalizer = one / simd::sqrt(simd::select(fallback, one, ux * ux + uy * uy + uz * uz));
+		ux = ux * u_normalizer;
+		uy = uy * u_normalizer;
+		uz = uz * u_normalizer;
+		const pack_type wx = vy * uz - vz * uy, wy = vz * ux - vx * uz, wz = vx * uy - vy * ux;
+
+		// Cをu, wに射影した2x2行列をJacobi回転で対角化します。孤立した固有値はvのレイリー商にします。
+		const pack_type cux = c11 * ux + c12 * uy + c13 * uz, cuy = c12 * ux + c22 * uy + c23 * uz, cuz = c13 * ux + c23 * uy + c33 * uz;
+		const pack_type cwx = c11 * wx + c12 * wy + c13 * wz, cwy = c12 * wx + c22 * wy + c23 * wz, cwz = c13 * wx + c23 * wy + c33 * wz;
+		const pack_type s11 = ux * cux + uy * cuy + uz * cuz;
+		const pack_type s12 = wx * cux + wy * cuy + wz * cuz;
+		const pack_type s22 = wx * cwx + wy * cwy + wz * cwz;
+		const pack_type isolated = vx * (c11 * vx + c12 * vy + c13 * vz) + vy * (c12 * vx + c22 * vy + c23 * vz) + vz * (c13 * vx + c23 * vy + c33 * vz);
+
+		const mask_type diagonal = s12 == zero;
+		const pack_type tau = (s22 - s11) / (two * simd::select(diagonal, one, s12));
+		pack_type tangent = one / (simd::abs(tau) + simd::sqrt(simd::fmadd(tau, tau, one)));
+		tangent = simd::select(diagonal, zero, simd::select(tau < zero, -tangent, tangent));
+		const pack_type cosine = one / simd::sqrt(simd::fmadd(tangent, tangent, one));
+		const pack_type sine = tangent * cosine;
+		const pack_type mu1 = s11 - tangent * s12, mu2 = s22 + tangent * s12;
+		const pack_type e1x = cosine * ux - sine * wx, e1y = cosine * uy - sine * wy, e1z = cosine * uz - sine * wz;
+		const pack_type e2x = sine * ux + cosine * wx, e2y = sine * uy + cosine * wy, e2z = sine * uz + cosine * wz;
+
+		// 降順に並べます。孤立した固有値はrが0以上なら最大、負なら最小です。
+		const mask_type swap = mu2 > mu1;
+		const pack_type high = simd::select(swap, mu2, mu1), low = simd::select(swap, mu1, mu2);
+		const pack_type hx = simd::select(swap, e2x, e1x), hy = simd::select(swap, e2y, e1y), hz = simd::select(swap, e2z, e1z);
+		const pack_type lx = simd::select(swap, e1x, e2x), ly = simd::select(swap, e1y, e2y), lz = simd::select(swap, e1z, e2z);
+		// 3つがほぼ等しい場合に丸め誤差で順序が入れ替わらないようにします。
+		const pack_type ordered = simd::select(largest_isolated, simd::max(isolated, high), simd::min(isolated, low));
+
+		_values[0] = simd::fmadd(simd::select(largest_isolated, ordered, high), p, m) * scale;
+		_values[1] = simd::fmadd(simd::select(largest_isolated, high, low), p, m) * scale;
+		_values[2] = simd::fmadd(simd::select(largest_isolated, low, ordered), p, m) * scale;
+		_vectors[0] = simd::select(largest_isolated, vx, hx);
+		_vectors[1] = simd::select(largest_isolated, vy, hy);
+		_vectors[2] = simd::select(largest_isolated, vz, hz);
+		_vectors[3] = simd::select(largest_isolated, hx, lx);
+		_vectors[4] = simd::select(largest_isolated, hy, ly);
+		_vectors[5] = simd::select(largest_isolated, hz, lz);
+		_vectors[6] = _vectors[1] * _vectors[5] - _vectors[2] * _vectors[4];
+		_vectors[7] = _vectors[2] * _vectors[3] - _vectors[0] * _vectors[5];
+		_vectors[8] = _vectors[0] * _vectors[4] - _vectors[1] * _vectors[3];
+		return fallback;
+	}
+
+	/*!
+	*	@brief 巡回Jacobi法で対称行列の固有値と固有ベクトルを求めます。
+	*	_resultの先頭3要素に降順の固有値を、続く9要素に対応する固有ベクトルを3成分ずつ書き込みます。
+	*/
+	static void eigen_jacobi(value_type _a11, value_type _a12, value_type _a13, value_type _a22, value_type _a23, value_type _a33, value_type* _result)
+	{
+		const value_type largest = max(max(std::abs(_a11), std::abs(_a12), std::abs(_a13)), max(std::abs(_a22), std::abs(_a23), std::abs(_a33)));
+		const value_type scale = (largest == static_cast<value_type>(0)) ? static_cast<value_type>(1) : largest;
+		value_type a[3][3] =
+		{
+			{ _a11 / scale, _a12 / scale, _a13 / scale },
+			{ _a12 / scale, _a22 / scale, _a23 / scale },
+			{ _a13 / scale, _a23 / scale, _a33 / scale }
+		};
+		value_type v[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+
+		const value_type epsilon = std::numeric_limits<value_type>::epsilon();
+		for (int sweep = 0; sweep < 16; sweep++)
+		{
+			const value_type off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+			const value_type diagonal = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+			if (off <= epsilon * epsilon * diagonal * static_cast<value_type>(0.25) || off < std::numeric_limits<value_type>::min())
+			{
+				break;
+			}
+			for (size_type pair = 0; pair < 3; pair++)
+			{
+				const size_type p = (pair == 2) ? 1 : 0;
+				const size_type q = (pair == 0) ? 1 : 2;
+				if (a[p][q] == static_cast<value_type>(0))
+				{
+					continue;
+				}
+				const value_type tau = (a[q][q] - a[p][p]) / (static_cast<value_type>(2) * a[p][q]);
+				value_type tangent = static_cast<value_type>(1) / (std::abs(tau) + std::sqrt(tau * tau + static_cast<value_type>(1)));
+				tangent = (tau < static_cast<value_type>(0)) ? -tangent : tangent;
+				const value_type cosine = static_cast<value_type>(1) / std::sqrt(tangent * tangent + static_cast<value_type>(1));
+				const value_type sine = tangent * cosine;
+				for (size_type k = 0; k < 3; k++)
+				{
+					const value_type kp = a[k][p], kq = a[k][q];
+					a[k][p] = cosine * kp - sine * kq;
+					a[k][q] = sine * kp + cosine * kq;
+				}
+				for (size_type k = 0; k < 3; k++)
+				{
+					const value_type pk = a[p][k], qk = a[q][k];
+					a[p][k] = cosine * pk - sine * qk;
+					a[q][k] = sine * pk + cosine * qk;
+				}
+				for (size_type k = 0; k < 3; k++)
+				{
+					const value_type kp = v[k][p], kq = v[k][q];
+					v[k][p] = cosine * kp - sine * kq;
+					v[k][q] = sine * kp + cosine * kq;
+				}
+			}
+		}
+
+		size_type order[3] = { 0, 1, 2 };
+		for (size_type i = 0; i < 2; i++)
+		{
+			for (size_type j = 0; j < 2 - i; j++)
+			{
+				if (a[order[j]][order[j]] < a[order[j + 1]][order[j + 1]])
+				{
+					std::swap(order[j], order[j + 1]);
+				}
+			}
+		}
+		for (size_type k = 0; k < 3; k++)
+		{
+			_result[k] = a[order[k]][order[k]] * scale;
+		}
+		for (size_type k = 0; k < 2; k++)
+		{
+			for (size_type c = 0; c < 3; c++)
+			{
+				_result[3 + k * 3 + c] = v[c][order[k]];
+			}
+		}
+		_result[9] = _result[4] * _result[8] - _result[5] * _result[7];
+		_result[10] = _result[5] * _result[6] - _result[3] * _result[8];
+		_result[11] = _result[3] * _result[7] - _result[4] * _result[6];
+	}
+
+	/*!
+	*	@brief batch_size個以下の行列の特異値分解を、成分ごとの配列に並べ替えてpack幅ずつ求めます。
+	*	_u, _sigma, _vにはsvdの結果を、_rotation, _stretchにはpolarの結果を書き込みます。nullptrの出力は求めません。
+	*/
+	static void svd_block(const matrix3x3* _input, matrix3x3* _u, vector3<value_type>* _sigma, matrix3x3* _v, quaternion<value_type>* _rotation, matrix3x3* _stretch, size_type _count)
+	{
+		if (!simd::packed4<value_type>::value)
+		{
+			for (size_type j = 0; j < _count; j++)
+			{
+				if (_u != nullptr)
+				{
+					_input[j].svd(_u[j], _sigma[j], _v[j]);
+				}
+				if (_rotation != nullptr)
+				{
+					_rotation[j] = _input[j].polar(_stretch != nullptr ? _stretch + j : nullptr);
+				}
+			}
+			return;
+		}
+
+		typedef simd::pack<value_type> pack_type;
+		const size_type width = pack_type::width;
+		const size_type padded = (_count + width - 1) / width * width;
+		const size_type pitch = batch_size + width;
+		// 出力ごとの成分の配列の先頭(u: 9, σ: 3, v: 9, 回転: 4, S: 9)
+		enum { u_offset = 0, sigma_offset = 9, v_offset = 12, rotation_offset = 21, stretch_offset = 25, result_size = 34 };
+		value_type lanes[9][pitch];
+		value_type results[result_size][pitch];
+		size_type j = 0;
+		for (; j + 4 <= _count; j += 4)
+		{
+			simd::aos_to_soa4<9>(reinterpret_cast<const value_type*>(_input + j), lanes[0] + j, pitch);
+		}
+		for (; j < _count; j++)
+		{
+			for (size_type k = 0; k < 9; k++)
+			{
+				lanes[k][j] = _input[j].data[k / 3][k % 3];
+			}
+		}
+		for (j = _count; j < padded; j++)
+		{
+			for (size_type k = 0; k < 9; k++)
+			{
+				lanes[k][j] = (k % 4 == 0) ? static_cast<value_type>(1) : static_cast<value_type>(0);
+			}
+		}
+
+		for (size_type i = 0; i < padded; i += width)
+		{
+			pack_type input[9], u[4], sigma[3], v[4], result[9];
+			for (size_type k = 0; k < 9; k++)
+			{
+				input[k] = pack_type::load(lanes[k] + i);
+			}
+			svd(input, u, sigma, v);
+			if (_u != nullptr)
+			{
+				rotation_matrix(u, result);
+				for (size_type k = 0; k < 9; k++)
+				{
+					result[k].store(results[u_offset + k] + i);
+				}
+				rotation_matrix(v, result);
+				for (size_type k = 0; k < 9; k++)
+				{
+					result[k].store(results[v_offset + k] + i);
+				}
+				for (size_type k = 0; k < 3; k++)
+				{
+					sigma[k].store(results[sigma_offset + k] + i);
+				}
+			}
+			if (_rotation != nullptr)
+			{
+				pack_type rotation[4];
+				polar(u, sigma, v, rotation, _stretch != nullptr ? result : nullptr);
+				for (size_type k = 0; k < 4; k++)
+				{
+					rotation[k].store(results[rotation_offset + k] + i);
+				}
+				if (_stretch != nullptr)
+				{
+					for (size_type k = 0; k < 9; k++)
+					{
+						result[k].store(results[stretch_offset + k] + i);
+					}
+				}
+			}
+		}
+
+		static_assert(sizeof(quaternion<value_type>) == sizeof(value_type) * 4, "quaternion must be tightly packed.");
+		for (j = 0; j + 4 <= _count; j += 4)
+		{
+			if (_u != nullptr)
+			{
+				simd::soa_to_aos4<9>(results[u_offset] + j, reinterpret_cast<value_type*>(_u + j), pitch);
+				simd::soa_to_aos4<3>(results[sigma_offset] + j, reinterpret_cast<value_type*>(_sigma + j), pitch);
+				simd::soa_to_aos4<9>(results[v_offset] + j, reinterpret_cast<value_type*>(_v + j), pitch);
+			}
+			if (_rotation != nullptr)
+			{
+				simd::soa_to_aos4<4>(results[rotation_offset] + j, reinterpret_cast<value_type*>(_rotation + j), pitch);
+			}
+			if (_stretch != nullptr)
+			{
+				simd::soa_to_aos4<9>(results[stretch_offset] + j, reinterpret_cast<value_type*>(_stretch + j), pitch);
+			}
+		}
+		for (; j < _count; j++)
+		{
+			for (size_type k = 0; k < 9; k++)
+			{
+				if (_u != nullptr)
+				{
+					_u[j].data[k / 3][k % 3] = results[u_offset + k][j];
+					_v[j].data[k / 3][k % 3] = results[v_offset + k][j];
+				}
+				if (_stretch != nullptr)
+				{
+					_stretch[j].data[k / 3][k % 3] = results[stretch_offset + k][j];
+				}
+			}
+			for (size_type k = 0; k < 3 && _u != nullptr; k++)
+			{
+				_sigma[j].data[k] = results[sigma_offset + k][j];
+			}
+			for (size_type k = 0; k < 4 && _rotation != nullptr; k++)
+			{
+				_rotation[j].data[k] = results[rotation_offset + k][j];
+			}
+		}
+	}
+
+	/*!
+	*	@brief packの各レーンの行列_a[0..8](行優先)を A = U diag(σ) V^T に分解します。
+	*	UとVは回転のクォータニオン(x, y, z, w)として_u[0..3]と_v[0..3]に、σは_sigma[0..2]に書き込みます。
+	*/
+	template<class pack_type> static void svd(const pack_type* _a, pack_type* _u, pack_type* _sigma, pack_type* _v)
+	{
+		const pack_type zero(static_cast<value_type>(0)), one(static_cast<value_type>(1));
+
+		// 最大の絶対値で正規化し、A^T Aのオーバーフローとアンダーフローを避けます。
+		pack_type largest = simd::abs(_a[0]);
+		for (size_type k = 1; k < 9; k++)
+		{
+			largest = simd::max(largest, simd::abs(_a[k]));
+		}
+		const pack_type scale = simd::select(largest == zero, one, largest);
+		const pack_type reciprocal = one / scale;
+		pack_type a[9];
+		for (size_type k = 0; k < 9; k++)
+		{
+			a[k] = _a[k] * reciprocal;
+		}
+
+		// S = A^T AをJacobi法で対角化します。近似Givens回転は収束の終盤で3次収束するため、掃引の回数は固定します。
+		pack_type s[3][3];
+		for (size_type r = 0; r < 3; r++)
+		{
+			for (size_type c = r; c < 3; c++)
+			{
+				s[r][c] = s[c][r] = a[r] * a[c] + a[3 + r] * a[3 + c] + a[6 + r] * a[6 + c];
+			}
+		}
+		_v[0] = _v[1] = _v[2] = zero;
+		_v[3] = one;
+		const int sweeps = sizeof(value_type) > sizeof(float) ? 8 : 6;
+		for (int sweep = 0; sweep < sweeps; sweep++)
+		{
+			jacobi_conjugate<0, 1, 2>(s, _v);
+			jacobi_conjugate<1, 2, 0>(s, _v);
+			jacobi_conjugate<2, 0, 1>(s, _v);
+		}
+		normalize_quaternion(_v);
+
+		// B = AVの列をノルムの降順に並べます。列の入れ替えは片方の符号を反転した90度回転としてVにも掛けます。
+		pack_type v[9], b[9];
+		rotation_matrix(_v, v);
+		for (size_type r = 0; r < 3; r++)
+		{
+			for (size_type c = 0; c < 3; c++)
+			{
+				b[r * 3 + c] = a[r * 3] * v[c] + a[r * 3 + 1] * v[3 + c] + a[r * 3 + 2] * v[6 + c];
+			}
+		}
+		pack_type rho[3];
+		for (size_type c = 0; c < 3; c++)
+		{
+			rho[c] = b[c] * b[c] + b[3 + c] * b[3 + c] + b[6 + c] * b[6 + c];
+		}
+		sort_columns<0, 1>(b, rho, _v);
+		sort_columns<0, 2>(b, rho, _v);
+		sort_columns<1, 2>(b, rho, _v);
+
+		// Givens回転でBをQR分解し、UとRの対角成分σを求めます。
+		_u[0] = _u[1] = _u[2] = zero;
+		_u[3] = one;
+		givens_qr<0, 1>(b, _u);
+		givens_qr<0, 2>(b, _u);
+		givens_qr<1, 2>(b, _u);
+		normalize_quaternion(_u);
+		_sigma[0] = b[0] * scale;
+		_sigma[1] = b[4] * scale;
+		_sigma[2] = b[8] * scale;
+	}
+
+	/*!
+	*	@brief svdの結果から極分解 A = RS の回転R = UV^Tをクォータニオンで_rotation[0..3]に書き込みます。
+	*	_stretchがnullptrでなければS = V diag(σ) V^Tを_stretch[0..8]に書き込みます。
+	*/
+	template<class pack_type> static void polar(const pack_type* _u, const pack_type* _sigma, const pack_type* _v, pack_type* _rotation, pack_type* _stretch)
+	{
+		// U * conj(V)。q = -qも同じ回転のため、w >= 0にそろえます。
+		const pack_type x = _u[3] * -_v[0] + _u[0] * _v[3] + _u[1] * -_v[2] - _u[2] * -_v[1];
+		const pack_type y = _u[3] * -_v[1] - _u[0] * -_v[2] + _u[1] * _v[3] + _u[2] * -_v[0];
+		const pack_type z = _u[3] * -_v[2] + _u[0] * -_v[1] - _u[1] * -_v[0] + _u[2] * _v[3];
+		const pack_type w = _u[3] * _v[3] + _u[0] * _v[0] + _u[1] * _v[1] + _u[2] * _v[2];
+		const auto negative = w < pack_type(static_cast<value_type>(0));
+		_rotation[0] = simd::select(negative, -x, x);
+		_rotation[1] = simd::select(negative, -y, y);
+		_rotation[2] = simd::select(negative, -z, z);
+		_rotation[3] = simd::select(negative, -w, w);
+		normalize_quaternion(_rotation);
+
+		if (_stretch != nullptr)
+		{
+			pack_type v[9];
+			rotation_matrix(_v, v);
+			for (size_type r = 0; r < 3; r++)
+			{
+				for (size_type c = r; c < 3; c++)
+				{
+					_stretch[r * 3 + c] = _stretch[c * 3 + r] = v[r * 3] * _sigma[0] * v[c * 3] + v[r * 3 + 1] * _sigma[1] * v[c * 3 + 1] + v[r * 3 + 2] * _sigma[2] * v[c * 3 + 2];
+				}
+			}
+		}
+	}
+
+	/*!
+	*	@brief 対称行列_sの(_p, _q)成分を近似Givens回転で小さくし、回転を_quaternionに右から掛けます。
+	*	(_p, _q, _r)は(0, 1, 2)の巡回置換で、回転軸は_r軸です。
+	*	回転角はtan(θ/2) ≒ s_pq / (2(s_pp - s_qq))で近似し、近似が悪い大きな角度ではπ/4回転に置き換えます。
+	*/
+	template<size_type _p, size_type _q, size_type _r, class pack_type> static void jacobi_conjugate(pack_type (&_s)[3][3], pack_type* _quaternion)
+	{
+		const pack_type one(static_cast<value_type>(1)), two(static_cast<value_type>(2));
+		// 3 + 2√2 = cot^2(π/8)、cos(π/8)、sin(π/8)
+		const pack_type gamma(static_cast<value_type>(5.8284271247461903));
+		const pack_type cos_pi_8(static_cast<value_type>(0.92387953251128674));
+		const pack_type sin_pi_8(static_cast<value_type>(0.38268343236508978));
+
+		const pack_type ch = two * (_s[_p][_p] - _s[_q][_q]), sh = _s[_p][_q];
+		const auto accurate = gamma * sh * sh < ch * ch;
+		const pack_type w = simd::rsqrt(simd::select(accurate, ch * ch + sh * sh, one));
+		const pack_type half_cos = simd::select(accurate, w * ch, cos_pi_8);
+		const pack_type half_sin = simd::select(accurate, w * sh, sin_pi_8);
+
+		// S' = Q^T S Q、Q = [c -s; s c]
+		const pack_type c = half_cos * half_cos - half_sin * half_sin;
+		const pack_type s = two * half_cos * half_sin;
+		const pack_type cc = c * c, ss = s * s, cs = c * s;
+		const pack_type pp = _s[_p][_p], qq = _s[_q][_q], pq = _s[_p][_q], pr = _s[_p][_r], qr = _s[_q][_r];
+		_s[_p][_p] = cc * pp + two * cs * pq + ss * qq;
+		_s[_q][_q] = ss * pp - two * cs * pq + cc * qq;
+		// 収束した非対角成分は掃引のたびに小さくなり非正規化数になるため、ε^2未満は0にします。
+		const pack_type zero(static_cast<value_type>(0)), tiny(std::numeric_limits<value_type>::epsilon() * std::numeric_limits<value_type>::epsilon());
+		auto flush = [&](const pack_type& _value)
+		{
+			return simd::select(simd::abs(_value) < tiny, zero, _value);
+		};
+		_s[_p][_q] = _s[_q][_p] = flush((cc - ss) * pq + cs * (qq - pp));
+		_s[_p][_r] = _s[_r][_p] = flush(c * pr + s * qr);
+		_s[_q][_r] = _s[_r][_q] = flush(c * qr - s * pr);
+
+		multiply_axis<_r>(_quaternion, half_cos, half_sin);
+	}
+
+	/*!
+	*	@brief Bの第_column列のノルムが第_other列より小さいレーンで、2つの列を(b_other, -b_column)に入れ替えます。
+	*	列の入れ替えは(_column, _other)平面の90度回転なので、同じ回転を_quaternionにも掛けます。
+	*/
+	template<size_type _column, size_type _other, class pack_type> static void sort_columns(pack_type* _b, pack_type* _rho, pack_type* _quaternion)
+	{
+		const auto swap = _rho[_column] < _rho[_other];
+		for (size_type r = 0; r < 3; r++)
+		{
+			const pack_type column = _b[r * 3 + _column];
+			_b[r * 3 + _column] = simd::select(swap, _b[r * 3 + _other], column);
+			_b[r * 3 + _other] = simd::select(swap, -column, _b[r * 3 + _other]);
+		}
+		const pack_type rho = _rho[_column];
+		_rho[_column] = simd::select(swap, _rho[_other], rho);
+		_rho[_other] = simd::select(swap, rho, _rho[_other]);
 
+		const pack_type zero(static_cast<value_type>(0));
+		const pack_type half_cos = simd::select(swap, pack_type(static_cast<value_type>(0.70710678118654752)), pack_type(static_cast<value_type>(1)));
+		const pack_type half_sin = simd::select(swap, pack_type(static_cast<value_type>(0.70710678118654752)), zero);
+		rotate_plane<_column, _other>(_quaternion, half_cos, half_sin);
+	}
+
+	/*!
+	*	@brief Givens回転で_b(_row, _column)を0にし、回転を_quaternionに右から掛けます。_columnは対角成分の行です。
+	*	回転の半角はtan(θ/2) = b_rc / (|b_cc| + ρ)で求め、b_ccが負の場合はcotを使って対角成分を非負にします。
+	*/
+	template<size_type _column, size_type _row, class pack_type> static void givens_qr(pack_type* _b, pack_type* _quaternion)
+	{
+		const pack_type zero(static_cast<value_type>(0));
+		const pack_type epsilon(std::sqrt(std::numeric_limits<value_type>::min()));
+		const pack_type a1 = _b[_column * 3 + _column], a2 = _b[_row * 3 + _column];
+		const pack_type rho = simd::sqrt(a1 * a1 + a2 * a2);
+		pack_type sh = simd::select(rho > epsilon, a2, zero);
+		pack_type ch = simd::abs(a1) + simd::max(rho, epsilon);
+		const auto negative = a1 < zero;
+		const pack_type swapped = ch;
+		ch = simd::select(negative, sh, ch);
+		sh = simd::select(negative, swapped, sh);
+		const pack_type w = simd::rsqrt(ch * ch + sh * sh);
+		ch = ch * w;
+		sh = sh * w;
+
+		// B' = G^T B、G = [c -s; s c]
+		const pack_type c = ch * ch - sh * sh;
+		const pack_type s = pack_type(static_cast<value_type>(2)) * ch * sh;
+		for (size_type k = 0; k < 3; k++)
+		{
+			const pack_type upper = _b[_column * 3 + k], lower = _b[_row * 3 + k];
+			_b[_column * 3 + k] = c * upper + s * lower;
+			_b[_row * 3 + k] = c * lower - s * upper;
+		}
+		rotate_plane<_column, _row>(_quaternion, ch, sh);
+	}
+
+	///	<summary>(_first, _second)平面で_first軸を_second軸へ向ける回転(半角のcos, sin)を_quaternionに右から掛けます。</summary>
+	template<size_type _first, size_type _second, class pack_type> static void rotate_plane(pack_type* _quaternion, const pack_type& _half_cos, const pack_type& _half_sin)
+	{
+		// (_first, _second, 軸)が巡回置換でなければ軸まわりの逆回転です。
+		multiply_axis<3 - _first - _second>(_quaternion, _half_cos, (_second == (_first + 1) % 3) ? _half_sin : -_half_sin);
+	}
+
+	///	<summary>_quaternionに_axis軸まわりの回転(半角のcos, sin)を右から掛けます。</summary>
+	template<size_type _axis, class pack_type> static void multiply_axis(pack_type* _quaternion, const pack_type& _half_cos, const pack_type& _half_sin)
+	{
+		const size_type p = (_axis + 1) % 3, q = (_axis + 2) % 3;
+		const pack_type qp = _quaternion[p], qq = _quaternion[q], qr = _quaternion[_axis], qw = _quaternion[3];
+		_quaternion[p] = qp * _half_cos + qq * _half_sin;
+		_quaternion[q] = qq * _half_cos - qp * _half_sin;
+		_quaternion[_axis] = qr * _half_cos + qw * _half_sin;
+		_quaternion[3] = qw * _half_cos - qr * _half_sin;
+	}
+
+	template<class pack_type> static void normalize_quaternion(pack_type* _quaternion)
+	{
+		const pack_type norm = simd::rsqrt(_quaternion[0] * _quaternion[0] + _quaternion[1] * _quaternion[1] + _quaternion[2] * _quaternion[2] + _quaternion[3] * _quaternion[3]);
+		for (size_type k = 0; k < 4; k++)
+		{
+			_quaternion[k] = _quaternion[k] * norm;
+		}
+	}
+
+	///	<summary>単位クォータニオン_quaternion(x, y, z, w)が表す回転行列(列ベクトルに左から掛ける)を行優先で_matrix[0..8]に書き込みます。</summary>
+	template<class pack_type> static void rotation_matrix(const pack_type* _quaternion, pack_type* _matrix)
+	{
+		const pack_type one(static_cast<value_type>(1)), two(static_cast<value_type>(2));
+		const pack_type x = _quaternion[0], y = _quaternion[1], z = _quaternion[2], w = _quaternion[3];
+		const pack_type x2 = two * x, y2 = two * y, z2 = two * z;
+		const pack_type xx = x * x2, yy = y * y2, zz = z * z2, xy = x * y2, xz = x * z2, yz = y * z2, wx = w * x2, wy = w * y2, wz = w * z2;
+		_matrix[0] = one - yy - zz;
+		_matrix[1] = xy - wz;
+		_matrix[2] = xz + wy;
+		_matrix[3] = xy + wz;
+		_matrix[4] = one - xx - zz;
+		_matrix[5] = yz - wx;
+		_matrix[6] = xz - wy;
+		_matrix[7] = yz + wx;
+		_matrix[8] = one - xx - yy;
+	}
+
+	///	<summary>x = roll, y = pitch, z = yawのsin/cosから回転行列を作ります。</summary>
+	static matrix3x3 rotation(const vector3<value_type>& _sin, const vector3<value_type>& _cos)
+	{
 		return matrix3x3<value_type>
 			(
-				yaw_sin * pitch_sin * roll_sin + yaw_cos * roll_cos, yaw_sin * pitch_sin * roll_cos - yaw_cos * roll_sin, yaw_sin * pitch_cos,
-				pitch_cos * roll_sin, pitch_cos * roll_cos, -pitch_sin,
-				yaw_cos * pitch_sin * roll_sin - yaw_sin * roll_cos, yaw_cos * pitch_sin * roll_cos + yaw_sin * roll_sin, yaw_cos * pitch_cos
+				_sin.z * _sin.y * _sin.x + _cos.z * _cos.x, _sin.z * _sin.y * _cos.x - _cos.z * _sin.x, _sin.z * _cos.y,
+				_cos.y * _sin.x, _cos.y * _cos.x, -_sin.y,
+				_cos.z * _sin.y * _sin.x - _sin.z * _cos.x, _cos.z * _sin.y * _cos.x + _sin.z * _sin.x, _cos.z * _cos.y
 				);
 	}
 
-	//conjugate();
+	template<size_t input_size, size_t output_size, bool divide> void transform(const value_type* _input, value_type* _output, size_type _count, value_type _z) const
+	{
+		static_assert(sizeof(vector2<value_type>) == sizeof(value_type) * 2, "vector2 must be tightly packed.");
+		static_assert(sizeof(vector3<value_type>) == sizeof(value_type) * 3, "vector3 must be tightly packed.");
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			transform<input_size, output_size, divide>(_input + _begin * input_size, _output + _begin * output_size, _end - _begin, _z, simd::packed4<value_type>());
+		});
+	}
+
+#if defined(ARCH_SIMD_SSE)
+	///	<summary>3つの列をレジスタに保持し、各ベクトルを列の線形結合として変換します。</summary>
+	template<size_t input_size, size_t output_size, bool divide> void transform(const value_type* _input, value_type* _output, size_type _count, value_type _z, std::true_type) const
+	{
+		typedef typename simd::packed4<value_type>::type packed;
+		value_type columns[3][4] = {};
+		for (size_type y = 0; y < 3; y++)
+		{
+			for (size_type x = 0; x < 3; x++)
+			{
+				columns[x][y] = data[y][x];
+			}
+		}
+		const packed column_x = simd::load4(columns[0]);
+		const packed column_y = simd::load4(columns[1]);
+		const packed column_z = input_size == 3 ? simd::load4(columns[2]) : simd::mul(simd::load4(columns[2]), simd::set4(_z));
+
+		for (size_type i = 0; i < _count; i++)
+		{
+			const value_type* value = _input + i * input_size;
+			packed result = input_size == 3 ? simd::mul(column_z, simd::set4(value[2])) : column_z;
+			result = simd::fmadd(column_y, simd::set4(value[1]), result);
+			result = simd::fmadd(column_x, simd::set4(value[0]), result);
+			if (divide)
+			{
+				result = simd::div(result, simd::splat<2>(result));
+			}
+
+			if (output_size == 3)
+			{
+				simd::store3(_output + i * output_size, result);
+			}
+			else
+			{
+				simd::store2(_output + i * output_size, result);
+			}
+		}
+	}
+#endif
+
+	template<size_t input_size, size_t output_size, bool divide> void transform(const value_type* _input, value_type* _output, size_type _count, value_type _z, std::false_type) const
+	{
+		for (size_type i = 0; i < _count; i++)
+		{
+			const value_type* value = _input + i * input_size;
+			const value_type z = input_size == 3 ? value[2] : _z;
+			value_type result[3];
+			for (size_type y = 0; y < 3; y++)
+			{
+				result[y] = data[y][0] * value[0] + data[y][1] * value[1] + data[y][2] * z;
+			}
+			for (size_type y = 0; y < output_size; y++)
+			{
+				_output[i * output_size + y] = divide ? result[y] / result[2] : result[y];
+			}
+		}
+	}
+
 public:
 	union
 	{
@@ -12,6 +12,11 @@
 
 #pragma once
 
+#include <cassert>
+#include "matrix3x3.h"
+#include "parallel.h"
+#include "simd.h"
+#include "trigonometric.h"
 #include "vector.h"
 
 namespace arch
@@ -99,62 +104,146 @@ public:
 
 	constexpr value_type determinant() const
 	{
-		return
-			_11 * (_22 * (_33 * _44 - _34 * _43) + _23 * (_34 * _42 - _32 * _44) + _24 * (_32 * _43 - _33 * _42)) +
-			_21 * (_32 * (_14 * _43 - _13 * _44) + _33 * (_12 * _44 - _14 * _42) + _34 * (_13 * _42 - _12 * _43)) +
-			_31 * (_42 * (_13 * _24 - _14 * _23) + _43 * (_14 * _22 - _12 * _24) + _44 * (_12 * _23 - _13 * _22)) +
-			_41 * (_12 * (_23 * _34 - _24 * _33) + _13 * (_24 * _32 - _22 * _34) + _14 * (_22 * _33 - _23 * _32));
+		return minors<value_type>(_11, _12, _13, _14, _21, _22, _23, _24, _31, _32, _33, _34, _41, _42, _43, _44).determinant();
 	}
 
+	///	<summary>余因子行列を転置した行列(随伴行列)を求めます。</summary>
 	constexpr matrix4x4 cofactor() const
 	{
+		value_type determinant = static_cast<value_type>(0);
+		return adjugate(determinant);
+	}
+
+	///	<summary>逆行列を求めます。行列式が0の場合は単位行列を返します。</summary>
+	matrix4x4 inverse() const
+	{
+		value_type determinant;
+		return inverse(determinant);
+	}
+
+	/*!
+	*	@brief 逆行列と行列式を同時に求めます。行列式が0の場合は単位行列を返します。
+	*	上2行と下2行の2x2小行列式を1度ずつ求め、行列式と余因子の両方で共有します。行列式はdeterminant()や一括版と同じ式です。
+	*	floatのSIMD版は2x2のブロックに分けて求めるため、行列式と余因子のどちらもその他の型とは丸め誤差の分だけ異なります。
+	*/
+	matrix4x4 inverse(value_type& _determinant) const
+	{
+		return inverse(_determinant, std::integral_constant<bool, simd::packed4<value_type>::value && std::is_same<value_type, float>::value>());
+	}
+
+	/*!
+	*	@brief 4行目が(0, 0, 0, 1)のアフィン変換の逆行列です。左上3x3の逆行列と、それで変換した平行移動の符号を反転したものから作ります。
+	*	3x3部分の行列式が0の場合は単位行列を返します。デバッグビルドではis_affine()を確認します。
+	*/
+	matrix4x4 inverse_affine() const
+	{
+		assert(is_affine() && "inverse_affine requires the last row to be (0, 0, 0, 1).");
+		const value_type c11 = _22 * _33 - _23 * _32;
+		const value_type c12 = _23 * _31 - _21 * _33;
+		const value_type c13 = _21 * _32 - _22 * _31;
+		const value_type determinant = _11 * c11 + _12 * c12 + _13 * c13;
+		if (determinant == static_cast<value_type>(0))
+		{
+			return identity();
+		}
+
+		const value_type reciprocal = static_cast<value_type>(1) / determinant;
+		const value_type i11 = c11 * reciprocal;
+		const value_type i12 = (_13 * _32 - _12 * _33) * reciprocal;
+		const value_type i13 = (_12 * _23 - _13 * _22) * reciprocal;
+		const value_type i21 = c12 * reciprocal;
+		const value_type i22 = (_11 * _33 - _13 * _31) * reciprocal;
+		const value_type i23 = (_13 * _21 - _11 * _23) * reciprocal;
+		const value_type i31 = c13 * reciprocal;
+		const value_type i32 = (_12 * _31 - _11 * _32) * reciprocal;
+		const value_type i33 = (_11 * _22 - _12 * _21) * reciprocal;
 		return matrix4x4<value_type>
 			(
-				_22 * (_33 * _44 - _34 * _43) + _23 * (_34 * _42 - _32 * _44) + _24 * (_32 * _43 - _33 * _42),
-				_32 * (_14 * _43 - _13 * _44) + _33 * (_12 * _44 - _14 * _42) + _34 * (_13 * _42 - _12 * _43),
-				_42 * (_13 * _24 - _14 * _23) + _43 * (_14 * _22 - _12 * _24) + _44 * (_12 * _23 - _13 * _22),
-				_12 * (_23 * _34 - _24 * _33) + _13 * (_24 * _32 - _22 * _34) + _14 * (_22 * _33 - _23 * _32),
-
-				_21 * (_33 * _44 - _34 * _43) + _23 * (_34 * _41 - _31 * _44) + _24 * (_31 * _43 - _33 * _41),
-				_31 * (_14 * _43 - _13 * _44) + _33 * (_11 * _44 - _14 * _41) + _34 * (_13 * _41 - _11 * _43),
-				_41 * (_13 * _24 - _14 * _23) + _43 * (_14 * _21 - _11 * _24) + _44 * (_11 * _23 - _13 * _21),
-				_11 * (_23 * _34 - _24 * _33) + _13 * (_24 * _31 - _21 * _34) + _14 * (_21 * _33 - _23 * _31),
-
-				_21 * (_32 * _44 - _34 * _42) + _22 * (_34 * _41 - _31 * _44) + _24 * (_31 * _42 - _32 * _41),
-				_31 * (_14 * _42 - _44 * _12) + _32 * (_11 * _44 - _41 * _14) + _34 * (_12 * _41 - _11 * _42),
-				_41 * (_12 * _24 - _14 * _22) + _42 * (_14 * _21 - _11 * _24) + _44 * (_11 * _22 - _12 * _21),
-				_11 * (_22 * _34 - _24 * _32) + _12 * (_24 * _31 - _21 * _34) + _14 * (_21 * _32 - _22 * _31),
-
-				_21 * (_32 * _43 - _33 * _42) + _22 * (_33 * _41 - _31 * _43) + _23 * (_31 * _42 - _32 * _41),
-				_31 * (_13 * _42 - _12 * _43) + _32 * (_11 * _43 - _13 * _41) + _33 * (_12 * _41 - _11 * _42),
-				_41 * (_12 * _23 - _13 * _22) + _42 * (_13 * _21 - _11 * _23) + _43 * (_11 * _22 - _12 * _21),
-				_11 * (_22 * _33 - _23 * _32) + _12 * (_23 * _31 - _21 * _33) + _13 * (_21 * _32 - _22 * _31)
+				i11, i12, i13, -(i11 * _14 + i12 * _24 + i13 * _34),
+				i21, i22, i23, -(i21 * _14 + i22 * _24 + i23 * _34),
+				i31, i32, i33, -(i31 * _14 + i32 * _24 + i33 * _34),
+				static_cast<value_type>(0), static_cast<value_type>(0), static_cast<value_type>(0), static_cast<value_type>(1)
 				);
 	}
 
-	matrix4x4 inverse() const
+	/*!
+	*	@brief 回転と平行移動だけからなる剛体変換の逆行列です。左上3x3を転置し、それで変換した平行移動の符号を反転します。
+	*	デバッグビルドではis_rigid()を確認します。
+	*/
+	matrix4x4 inverse_rigid() const
 	{
-		auto det = determinant();
-		return (det != static_cast<value_type>(0)) ? cofactor() / det : identity();
+		assert(is_rigid() && "inverse_rigid requires an orthonormal rotation and the last row to be (0, 0, 0, 1).");
+		return matrix4x4<value_type>
+			(
+				_11, _21, _31, -(_11 * _14 + _21 * _24 + _31 * _34),
+				_12, _22, _32, -(_12 * _14 + _22 * _24 + _32 * _34),
+				_13, _23, _33, -(_13 * _14 + _23 * _24 + _33 * _34),
+				static_cast<value_type>(0), static_cast<value_type>(0), static_cast<value_type>(0), static_cast<value_type>(1)
+				);
 	}
 
-	constexpr matrix4x4 inverse(value_type& _determinant) const
+	///	<summary>4行目が(0, 0, 0, 1)かどうかを取得します。</summary>
+	constexpr bool is_affine() const
 	{
-		_determinant = determinant();
-		return (_determinant != 0) ? cofactor() / _determinant : identity();
+		return _41 == static_cast<value_type>(0) && _42 == static_cast<value_type>(0) && _43 == static_cast<value_type>(0) && _44 == static_cast<value_type>(1);
 	}
 
-	matrix4x4 transpose() const
+	///	<summary>アフィン変換で、左上3x3の各列が_tolerance以内で正規直交かどうかを取得します。</summary>
+	bool is_rigid(value_type _tolerance = static_cast<value_type>(1.0e-4)) const
 	{
-		matrix4x4<value_type> mat;
-		for (size_t y = 0; y < 4; y++)
+		if (!is_affine())
 		{
-			for (size_t x = 0; x < 4; x++)
+			return false;
+		}
+		const value_type products[6] =
+		{
+			_11 * _11 + _21 * _21 + _31 * _31 - static_cast<value_type>(1),
+			_12 * _12 + _22 * _22 + _32 * _32 - static_cast<value_type>(1),
+			_13 * _13 + _23 * _23 + _33 * _33 - static_cast<value_type>(1),
+			_11 * _12 + _21 * _22 + _31 * _32,
+			_11 * _13 + _21 * _23 + _31 * _33,
+			_12 * _13 + _22 * _23 + _32 * _33
+		};
+		for (value_type product : products)
+		{
+			if (arch::abs(product) > _tolerance)
 			{
-				mat.data[x][y] = data[y][x];
+				return false;
 			}
 		}
-		return std::move(mat);
+		return true;
+	}
+
+	matrix4x4 transpose() const
+	{
+		matrix4x4<value_type> result;
+		transpose(result, simd::packed4<value_type>());
+		return result;
+	}
+
+	///	<summary>*this * _matrix^Tを求めます。_matrixの転置はレジスタ上で行い、転置した行列を作りません。</summary>
+	matrix4x4 multiply_transposed(const matrix4x4& _matrix) const
+	{
+		matrix4x4<value_type> result;
+		multiply_transposed(_matrix, result, simd::packed4<value_type>());
+		return result;
+	}
+
+	///	<summary>*this^T * _matrixを求めます。結果の各行を*thisの列の成分を係数とした_matrixの行の線形結合として求め、転置した行列を作りません。</summary>
+	matrix4x4 transposed_multiply(const matrix4x4& _matrix) const
+	{
+		matrix4x4<value_type> result;
+		transposed_multiply(_matrix, result, simd::packed4<value_type>());
+		return result;
+	}
+
+	/*!
+	*	@brief 法線の変換に使う、左上3x3の逆行列の転置を求めます。3x3部分の行列式が0の場合は単位行列を返します。
+	*	4x4の逆行列も転置も作らず、左上3x3の余因子から直接求めます。
+	*/
+	matrix3x3<value_type> normal_matrix() const
+	{
+		return matrix3x3<value_type>(_11, _12, _13, _21, _22, _23, _31, _32, _33).normal_matrix();
 	}
 
 	constexpr matrix4x4 rotated(value_type roll, value_type pitch, value_type yaw) const
@@ -184,27 +273,76 @@ public:
 
 	constexpr vector4<value_type> transform(const vector4<value_type>& _vector) const
 	{
-		return vector3<value_type>
+		return vector4<value_type>
 			(
 				_11 * _vector.x + _12 * _vector.y + _13 * _vector.z + _14 * _vector.w,
 				_21 * _vector.x + _22 * _vector.y + _23 * _vector.z + _24 * _vector.w,
-				_31 * _vector.x + _32 * _vector.y + _33 * _vector.z + _24 * _vector.w
+				_31 * _vector.x + _32 * _vector.y + _33 * _vector.z + _34 * _vector.w,
+				_41 * _vector.x + _42 * _vector.y + _43 * _vector.z + _44 * _vector.w
 				);
 	}
 
-public:
-	matrix4x4& operator=(const matrix4x4& _matrix)
+	///	<summary>w = 1として変換します(平行移動を含みます)。</summary>
+	constexpr vector3<value_type> transform_point(const vector3<value_type>& _vector) const
 	{
-		for (size_t y = 0; y < 4; y++)
-		{
-			for (size_t x = 0; x < 4; x++)
-			{
-				data[y][x] = _matrix.data[y][x];
-			}
-		}
-		return *this;
+		return vector3<value_type>
+			(
+				_11 * _vector.x + _12 * _vector.y + _13 * _vector.z + _14,
+				_21 * _vector.x + _22 * _vector.y + _23 * _vector.z + _24,
+				_31 * _vector.x + _32 * _vector.y + _33 * _vector.z + _34
+				);
+	}
+
+	///	<summary>w = 0として変換します(平行移動を含みません)。</summary>
+	constexpr vector3<value_type> transform_direction(const vector3<value_type>& _vector) const
+	{
+		return transform(_vector);
+	}
+
+	///	<summary>w = 1として変換し、結果をwで割ります。</summary>
+	constexpr vector3<value_type> transform_homogeneous(const vector3<value_type>& _vector) const
+	{
+		return vector3<value_type>
+			(
+				_11 * _vector.x + _12 * _vector.y + _13 * _vector.z + _14,
+				_21 * _vector.x + _22 * _vector.y + _23 * _vector.z + _24,
+				_31 * _vector.x + _32 * _vector.y + _33 * _vector.z + _34
+				) / (_41 * _vector.x + _42 * _vector.y + _43 * _vector.z + _44);
+	}
+
+	/*!
+	*	@brief _count個のベクトルを一括で変換します。各関数の結果は1要素版と同じです。
+	*	行列の列をレジスタに置いたまま各ベクトルをSIMDで変換し、ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*	_inputと_outputは同じ配列でも構いません。
+	*/
+	void transform(const vector3<value_type>* _input, vector3<value_type>* _output, size_type _count) const
+	{
+		transform<3, 3, false>(reinterpret_cast<const value_type*>(_input), reinterpret_cast<value_type*>(_output), _count, static_cast<value_type>(0.0));
 	}
 
+	void transform(const vector4<value_type>* _input, vector4<value_type>* _output, size_type _count) const
+	{
+		transform<4, 4, false>(reinterpret_cast<const value_type*>(_input), reinterpret_cast<value_type*>(_output), _count, static_cast<value_type>(0.0));
+	}
+
+	void transform_point(const vector3<value_type>* _input, vector3<value_type>* _output, size_type _count) const
+	{
+		transform<3, 3, false>(reinterpret_cast<const value_type*>(_input), reinterpret_cast<value_type*>(_output), _count, static_cast<value_type>(1.0));
+	}
+
+	void transform_direction(const vector3<value_type>* _input, vector3<value_type>* _output, size_type _count) const
+	{
+		transform<3, 3, false>(reinterpret_cast<const value_type*>(_input), reinterpret_cast<value_type*>(_output), _count, static_cast<value_type>(0.0));
+	}
+
+	void transform_homogeneous(const vector3<value_type>* _input, vector3<value_type>* _output, size_type _count) const
+	{
+		transform<3, 3, true>(reinterpret_cast<const value_type*>(_input), reinterpret_cast<value_type*>(_output), _count, static_cast<value_type>(1.0));
+	}
+
+public:
+	matrix4x4& operator=(const matrix4x4& _matrix) = default;
+
 	matrix4x4 operator+(const matrix4x4& _matrix) const
 	{
 		matrix4x4<value_type> mat;
@@ -215,7 +353,7 @@ public:
 				mat.data[y][x] = data[y][x] + _matrix.data[y][x];
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	matrix4x4& operator+=(const matrix4x4& _matrix)
@@ -240,7 +378,7 @@ public:
 				mat.data[y][x] = data[y][x] - _matrix.data[y][x];
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	matrix4x4& operator-=(const matrix4x4& _matrix)
@@ -257,18 +395,9 @@ public:
 
 	matrix4x4 operator*(const matrix4x4& _matrix) const
 	{
-		matrix4x4<value_type> mat = zero();
-		for (size_t y = 0; y < 4; y++)
-		{
-			for (size_t x = 0; x < 4; x++)
-			{
-				for (size_t i = 0; i < 4; i++)
-				{
-					mat.data[y][x] += data[y][i] * _matrix.data[i][x];
-				}
-			}
-		}
-		return std::move(mat);
+		matrix4x4<value_type> result;
+		multiply(_matrix, result, simd::packed4<value_type>());
+		return result;
 	}
 
 	matrix4x4 operator*(value_type value) const
@@ -281,7 +410,7 @@ public:
 				mat.data[y][x] = data[y][x] * value;
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	matrix4x4& operator*=(const matrix4x4& _matrix)
@@ -312,7 +441,7 @@ public:
 				mat.data[y][x] = data[y][x] / value;
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	matrix4x4& operator/=(value_type value)
@@ -333,7 +462,7 @@ public:
 		{
 			for (size_t x = 0; x < 4; x++)
 			{
-				if (data[y][x] != value)
+				if (data[y][x] != vector.data[y][x])
 				{
 					return false;
 				}
@@ -348,7 +477,7 @@ public:
 		{
 			for (size_t x = 0; x < 4; x++)
 			{
-				if (data[y][x] != value)
+				if (data[y][x] != vector.data[y][x])
 				{
 					return true;
 				}
@@ -367,7 +496,7 @@ public:
 				mat.data[y][x] = data[y][x];
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	matrix4x4 operator-() const
@@ -380,7 +509,7 @@ public:
 				mat.data[y][x] = -data[y][x];
 			}
 		}
-		return std::move(mat);
+		return mat;
 	}
 
 	value_type operator()(uint rowIndex, uint columnIndex) const
@@ -452,8 +581,8 @@ public:
 
 	static matrix4x4 roll(value_type roll)
 	{
-		const value_type roll_sin = sin(roll);
-		const value_type roll_cos = cos(roll);
+		value_type roll_sin, roll_cos;
+		sincos(roll, roll_sin, roll_cos);
 
 		return matrix4x4<value_type>
 			(
@@ -478,8 +607,8 @@ public:
 
 	static matrix4x4 pitch(value_type pitch)
 	{
-		const value_type pitch_sin = sin(pitch);
-		const value_type pitch_cos = cos(pitch);
+		value_type pitch_sin, pitch_cos;
+		sincos(pitch, pitch_sin, pitch_cos);
 
 		return matrix4x4<value_type>
 			(
@@ -504,8 +633,8 @@ public:
 
 	static matrix4x4 yaw(value_type yaw)
 	{
-		const value_type yaw_sin = sin(yaw);
-		const value_type yaw_cos = cos(yaw);
+		value_type yaw_sin, yaw_cos;
+		sincos(yaw, yaw_sin, yaw_cos);
 
 		return matrix4x4<value_type>
 			(
@@ -530,31 +659,63 @@ public:
 
 	static matrix4x4 rotation(value_type roll, value_type pitch, value_type yaw)
 	{
-		const value_type roll_sin = sin(roll);
-		const value_type roll_cos = cos(roll);
-		const value_type pitch_sin = sin(pitch);
-		const value_type pitch_cos = cos(pitch);
-		const value_type yaw_sin = sin(yaw);
-		const value_type yaw_cos = cos(yaw);
+		vector3<value_type> sin, cos;
+		sincos(vector3<value_type>(roll, pitch, yaw), sin, cos);
+		return rotation(sin, cos);
+	}
 
-		return matrix4x4<value_type>
-			(
-				yaw_sin * pitch_sin * roll_sin + yaw_cos * roll_cos,
-				yaw_sin * pitch_sin * roll_cos - yaw_cos * roll_sin,
-				yaw_sin * pitch_cos,
-				static_cast<value_type>(0.0),
-				pitch_cos * roll_sin,
-				pitch_cos * roll_cos,
-				-pitch_sin,
-				static_cast<value_type>(0.0),
-				yaw_cos * pitch_sin * roll_sin - yaw_sin * roll_cos,
-				yaw_cos * pitch_sin * roll_cos + yaw_sin * roll_sin,
-				yaw_cos * pitch_cos,
-				static_cast<value_type>(0.0),
-				static_cast<value_type>(0.0),
-				static_cast<value_type>(0.0),
-				static_cast<value_type>(1.0)
-				);
+	/*!
+	*	@brief _count組の角度から回転行列をまとめて作ります。sin/cosはsincosでpack幅ずつ求めます。
+	*	ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*/
+	static void rotation(const value_type* _roll, const value_type* _pitch, const value_type* _yaw, matrix4x4* _result, size_type _count)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			const size_type block = 256;
+			value_type sin[3][block], cos[3][block];
+			for (size_type begin = _begin; begin < _end; begin += block)
+			{
+				const size_type size = min(block, _end - begin);
+				sincos(_roll + begin, sin[0], cos[0], size);
+				sincos(_pitch + begin, sin[1], cos[1], size);
+				sincos(_yaw + begin, sin[2], cos[2], size);
+				for (size_type i = 0; i < size; i++)
+				{
+					_result[begin + i] = rotation(vector3<value_type>(sin[0][i], sin[1][i], sin[2][i]), vector3<value_type>(cos[0][i], cos[1][i], cos[2][i]));
+				}
+			}
+		});
+	}
+
+	/*!
+	*	@brief _count個の行列の逆行列をまとめて求めます。行列を成分ごとの配列に並べ替え、packの各レーンが1つの行列を処理します。
+	*	行列式が0の行列には単位行列を書き込み、_singularの対応する要素をtrueにします。_determinantと_singularはnullptrでも構いません。
+	*	単体のinverse()と同じく行列式が厳密に0の場合だけを特異とするため、閾値が必要な場合は_determinantを使ってください。
+	*	行列式はpackの中でdeterminant()と同じ小行列式の式から求めるため、_determinantと_singularはdeterminant()と一致します。
+	*	ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*/
+	static void inverse(const matrix4x4* _input, matrix4x4* _result, value_type* _determinant, bool* _singular, size_type _count)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			for (size_type i = _begin; i < _end; i += batch_size)
+			{
+				inverse<true>(_input + i, _result + i, _determinant != nullptr ? _determinant + i : nullptr, _singular != nullptr ? _singular + i : nullptr, min(batch_size, _end - i));
+			}
+		});
+	}
+
+	///	<summary>_count個の行列の行列式をまとめて求めます。</summary>
+	static void determinant(const matrix4x4* _input, value_type* _result, size_type _count)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			for (size_type i = _begin; i < _end; i += batch_size)
+			{
+				inverse<false>(_input + i, nullptr, _result + i, nullptr, min(batch_size, _end - i));
+			}
+		});
 	}
 
 	static constexpr matrix4x4 scaling(value_type _scale_x, value_type _scale_y, value_type _scale_z)
@@ -603,6 +764,7 @@ public:
 				);
 	}
 
+	///	<summary>平行移動行列です。移動量は4列目(_14, _24, _34)に入ります。</summary>
 	static constexpr matrix4x4 translation(value_type _x, value_type _y, value_type _z)
 	{
 		return matrix4x4<value_type>
@@ -610,18 +772,18 @@ public:
 				static_cast<value_type>(1.0),
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(0.0),
-				static_cast<value_type>(0.0),
+				_x,
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(1.0),
 				static_cast<value_type>(0.0),
-				static_cast<value_type>(0.0),
+				_y,
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(1.0),
-				static_cast<value_type>(0.0),
-				_x,
-				_y,
 				_z,
+				static_cast<value_type>(0.0),
+				static_cast<value_type>(0.0),
+				static_cast<value_type>(0.0),
 				static_cast<value_type>(1.0)
 				);
 	}
@@ -633,22 +795,23 @@ public:
 				static_cast<value_type>(1.0),
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(0.0),
-				static_cast<value_type>(0.0),
+				_offset.x,
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(1.0),
 				static_cast<value_type>(0.0),
-				static_cast<value_type>(0.0),
+				_offset.y,
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(1.0),
-				static_cast<value_type>(0.0),
-				_offset.x,
-				_offset.y,
 				_offset.z,
+				static_cast<value_type>(0.0),
+				static_cast<value_type>(0.0),
+				static_cast<value_type>(0.0),
 				static_cast<value_type>(1.0)
 				);
 	}
 
+	///	<summary>zを[near_z, far_z]から[0, 1]に写す正射影行列です。</summary>
 	static constexpr matrix4x4 ortho(value_type width, value_type height, value_type near_z, value_type far_z)
 	{
 		return matrix4x4<value_type>
@@ -664,14 +827,459 @@ public:
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(1.0) / (far_z - near_z),
-				static_cast<value_type>(1.0),
+				near_z / (near_z - far_z),
+				static_cast<value_type>(0.0),
 				static_cast<value_type>(0.0),
 				static_cast<value_type>(0.0),
-				near_z / (near_z - far_z),
 				static_cast<value_type>(1.0)
 				);
 	}
 
+private:
+	/*!
+	*	@brief 上2行(s)と下2行(c)の2x2小行列式です。determinant()、adjugate()、一括版のpackが同じ式で行列式と余因子を求めます。
+	*	element_typeはvalue_typeかsimd::pack<value_type>です。
+	*/
+	template<class element_type> struct minors
+	{
+		element_type s0, s1, s2, s3, s4, s5;
+		element_type c0, c1, c2, c3, c4, c5;
+
+		constexpr minors(
+			const element_type& _11, const element_type& _12, const element_type& _13, const element_type& _14,
+			const element_type& _21, const element_type& _22, const element_type& _23, const element_type& _24,
+			const element_type& _31, const element_type& _32, const element_type& _33, const element_type& _34,
+			const element_type& _41, const element_type& _42, const element_type& _43, const element_type& _44)
+			: s0(difference(_11, _22, _21, _12)), s1(difference(_11, _23, _21, _13)), s2(difference(_11, _24, _21, _14))
+			, s3(difference(_12, _23, _22, _13)), s4(difference(_12, _24, _22, _14)), s5(difference(_13, _24, _23, _14))
+			, c0(difference(_31, _42, _41, _32)), c1(difference(_31, _43, _41, _33)), c2(difference(_31, _44, _41, _34))
+			, c3(difference(_32, _43, _42, _33)), c4(difference(_32, _44, _42, _34)), c5(difference(_33, _44, _43, _34))
+		{
+		}
+
+		constexpr element_type determinant() const
+		{
+			const element_type t0 = s0 * c5;
+			const element_type t1 = s1 * c4;
+			const element_type t2 = s2 * c3;
+			const element_type t3 = s3 * c2;
+			const element_type t4 = s4 * c1;
+			const element_type t5 = s5 * c0;
+			return t0 - t1 + t2 + t3 - t4 + t5;
+		}
+
+		///	<summary>_a * _b - _c * _d</summary>
+		static constexpr element_type difference(const element_type& _a, const element_type& _b, const element_type& _c, const element_type& _d)
+		{
+			const element_type ab = _a * _b;
+			const element_type cd = _c * _d;
+			return ab - cd;
+		}
+	};
+
+	///	<summary>x = roll, y = pitch, z = yawのsin/cosから回転行列を作ります。</summary>
+	static matrix4x4 rotation(const vector3<value_type>& _sin, const vector3<value_type>& _cos)
+	{
+		return matrix4x4<value_type>
+			(
+				_sin.z * _sin.y * _sin.x + _cos.z * _cos.x,
+				_sin.z * _sin.y * _cos.x - _cos.z * _sin.x,
+				_sin.z * _cos.y,
+				static_cast<value_type>(0.0),
+				_cos.y * _sin.x,
+				_cos.y * _cos.x,
+				-_sin.y,
+				static_cast<value_type>(0.0),
+				_cos.z * _sin.y * _sin.x - _sin.z * _cos.x,
+				_cos.z * _sin.y * _cos.x + _sin.z * _sin.x,
+				_cos.z * _cos.y,
+				static_cast<value_type>(0.0),
+				static_cast<value_type>(0.0),
+				static_cast<value_type>(0.0),
+				static_cast<value_type>(0.0),
+				static_cast<value_type>(1.0)
+				);
+	}
+
+#if defined(ARCH_SIMD_SSE)
+	///	<summary>_matrixの4行をレジスタに保持し、結果の各行を_matrixの行の線形結合として求めます。</summary>
+	void multiply(const matrix4x4& _matrix, matrix4x4& _result, std::true_type) const
+	{
+		typedef typename simd::packed4<value_type>::type packed;
+		const packed row0 = simd::load4(_matrix.data[0]);
+		const packed row1 = simd::load4(_matrix.data[1]);
+		const packed row2 = simd::load4(_matrix.data[2]);
+		const packed row3 = simd::load4(_matrix.data[3]);
+		for (size_type y = 0; y < 4; y++)
+		{
+			packed result = simd::mul(simd::set4(data[y][0]), row0);
+			result = simd::fmadd(simd::set4(data[y][1]), row1, result);
+			result = simd::fmadd(simd::set4(data[y][2]), row2, result);
+			result = simd::fmadd(simd::set4(data[y][3]), row3, result);
+			simd::store4(_result.data[y], result);
+		}
+	}
+
+	void multiply_transposed(const matrix4x4& _matrix, matrix4x4& _result, std::true_type) const
+	{
+		typedef typename simd::packed4<value_type>::type packed;
+		packed column0 = simd::load4(_matrix.data[0]);
+		packed column1 = simd::load4(_matrix.data[1]);
+		packed column2 = simd::load4(_matrix.data[2]);
+		packed column3 = simd::load4(_matrix.data[3]);
+		simd::transpose(column0, column1, column2, column3);
+		for (size_type y = 0; y < 4; y++)
+		{
+			packed result = simd::mul(simd::set4(data[y][0]), column0);
+			result = simd::fmadd(simd::set4(data[y][1]), column1, result);
+			result = simd::fmadd(simd::set4(data[y][2]), column2, result);
+			result = simd::fmadd(simd::set4(data[y][3]), column3, result);
+			simd::store4(_result.data[y], result);
+		}
+	}
+
+	void transposed_multiply(const matrix4x4& _matrix, matrix4x4& _result, std::true_type) const
+	{
+		typedef typename simd::packed4<value_type>::type packed;
+		const packed row0 = simd::load4(_matrix.data[0]);
+		const packed row1 = simd::load4(_matrix.data[1]);
+		const packed row2 = simd::load4(_matrix.data[2]);
+		const packed row3 = simd::load4(_matrix.data[3]);
+		for (size_type y = 0; y < 4; y++)
+		{
+			packed result = simd::mul(simd::set4(data[0][y]), row0);
+			result = simd::fmadd(simd::set4(data[1][y]), row1, result);
+			result = simd::fmadd(simd::set4(data[2][y]), row2, result);
+			result = simd::fmadd(simd::set4(data[3][y]), row3, result);
+			simd::store4(_result.data[y], result);
+		}
+	}
+
+	void transpose(matrix4x4& _result, std::true_type) const
+	{
+		typedef typename simd::packed4<value_type>::type packed;
+		packed row0 = simd::load4(data[0]);
+		packed row1 = simd::load4(data[1]);
+		packed row2 = simd::load4(data[2]);
+		packed row3 = simd::load4(data[3]);
+		simd::transpose(row0, row1, row2, row3);
+		simd::store4(_result.data[0], row0);
+		simd::store4(_result.data[1], row1);
+		simd::store4(_result.data[2], row2);
+		simd::store4(_result.data[3], row3);
+	}
+
+	matrix4x4 inverse(value_type& _determinant, std::true_type) const
+	{
+		simd::float4_type row0 = simd::load4(data[0]);
+		simd::float4_type row1 = simd::load4(data[1]);
+		simd::float4_type row2 = simd::load4(data[2]);
+		simd::float4_type row3 = simd::load4(data[3]);
+		const simd::float4_type determinant = simd::adjugate(row0, row1, row2, row3);
+		_determinant = _mm_cvtss_f32(determinant);
+		if (_determinant == static_cast<value_type>(0))
+		{
+			return identity();
+		}
+
+		matrix4x4<value_type> result;
+		simd::store4(result.data[0], simd::div(row0, determinant));
+		simd::store4(result.data[1], simd::div(row1, determinant));
+		simd::store4(result.data[2], simd::div(row2, determinant));
+		simd::store4(result.data[3], simd::div(row3, determinant));
+		return result;
+	}
+#endif
+
+	void multiply(const matrix4x4& _matrix, matrix4x4& _result, std::false_type) const
+	{
+		for (size_type y = 0; y < 4; y++)
+		{
+			for (size_type x = 0; x < 4; x++)
+			{
+				_result.data[y][x] = data[y][0] * _matrix.data[0][x] + data[y][1] * _matrix.data[1][x] + data[y][2] * _matrix.data[2][x] + data[y][3] * _matrix.data[3][x];
+			}
+		}
+	}
+
+	void multiply_transposed(const matrix4x4& _matrix, matrix4x4& _result, std::false_type) const
+	{
+		for (size_type y = 0; y < 4; y++)
+		{
+			for (size_type x = 0; x < 4; x++)
+			{
+				_result.data[y][x] = data[y][0] * _matrix.data[x][0] + data[y][1] * _matrix.data[x][1] + data[y][2] * _matrix.data[x][2] + data[y][3] * _matrix.data[x][3];
+			}
+		}
+	}
+
+	void transposed_multiply(const matrix4x4& _matrix, matrix4x4& _result, std::false_type) const
+	{
+		for (size_type y = 0; y < 4; y++)
+		{
+			for (size_type x = 0; x < 4; x++)
+			{
+				_result.data[y][x] = data[0][y] * _matrix.data[0][x] + data[1][y] * _matrix.data[1][x] + data[2][y] * _matrix.data[2][x] + data[3][y] * _matrix.data[3][x];
+			}
+		}
+	}
+
+	void transpose(matrix4x4& _result, std::false_type) const
+	{
+		for (size_type y = 0; y < 4; y++)
+		{
+			for (size_type x = 0; x < 4; x++)
+			{
+				_result.data[x][y] = data[y][x];
+			}
+		}
+	}
+
+	matrix4x4 inverse(value_type& _determinant, std::false_type) const
+	{
+		const matrix4x4<value_type> result = adjugate(_determinant);
+		return _determinant != static_cast<value_type>(0) ? result / _determinant : identity();
+	}
+
+	///< 一括演算で一度に成分ごとの配列へ並べ替える行列の数
+	static const size_type batch_size = 64;
+
+	/*!
+	*	@brief batch_size個以下の行列を成分ごとの配列に並べ替え、pack幅ずつ逆行列と行列式を求めます。
+	*	pack幅に満たない端数は単位行列で埋めて同じpackで処理します。compute_inverseがfalseの場合は行列式だけを求めます。
+	*	行列式はminorsのdeterminant()で求めるため、単体のdeterminant()と同じ式になります。SIMD化されていない型では並べ替えずに単体のinverse()を呼びます。
+	*/
+	template<bool compute_inverse> static void inverse(const matrix4x4* _input, matrix4x4* _result, value_type* _determinant, bool* _singular, size_type _count)
+	{
+		if (!simd::packed4<value_type>::value)
+		{
+			// 1レーンしかない場合は並べ替えずに1つずつ求めます。
+			for (size_type j = 0; j < _count; j++)
+			{
+				value_type determinant;
+				if (compute_inverse)
+				{
+					_result[j] = _input[j].inverse(determinant);
+				}
+				else
+				{
+					determinant = _input[j].determinant();
+				}
+				if (_determinant != nullptr)
+				{
+					_determinant[j] = determinant;
+				}
+				if (_singular != nullptr)
+				{
+					_singular[j] = determinant == static_cast<value_type>(0);
+				}
+			}
+			return;
+		}
+
+		typedef simd::pack<value_type> pack_type;
+		const size_type width = pack_type::width;
+		const size_type padded = (_count + width - 1) / width * width;
+		const size_type pitch = batch_size + width;
+		value_type lanes[16][pitch];
+		value_type determinants[pitch];
+		size_type j = 0;
+		for (; j + 4 <= _count; j += 4)
+		{
+			simd::aos_to_soa4<16>(reinterpret_cast<const value_type*>(_input + j), lanes[0] + j, pitch);
+		}
+		for (; j < _count; j++)
+		{
+			for (size_type k = 0; k < 16; k++)
+			{
+				lanes[k][j] = _input[j].m[k];
+			}
+		}
+		for (j = _count; j < padded; j++)
+		{
+			for (size_type k = 0; k < 16; k++)
+			{
+				lanes[k][j] = (k % 5 == 0) ? static_cast<value_type>(1) : static_cast<value_type>(0);
+			}
+		}
+
+		const pack_type zero(static_cast<value_type>(0)), one(static_cast<value_type>(1));
+		for (size_type i = 0; i < padded; i += width)
+		{
+			const pack_type m11 = pack_type::load(lanes[0] + i);
+			const pack_type m12 = pack_type::load(lanes[1] + i);
+			const pack_type m13 = pack_type::load(lanes[2] + i);
+			const pack_type m14 = pack_type::load(lanes[3] + i);
+			const pack_type m21 = pack_type::load(lanes[4] + i);
+			const pack_type m22 = pack_type::load(lanes[5] + i);
+			const pack_type m23 = pack_type::load(lanes[6] + i);
+			const pack_type m24 = pack_type::load(lanes[7] + i);
+			const pack_type m31 = pack_type::load(lanes[8] + i);
+			const pack_type m32 = pack_type::load(lanes[9] + i);
+			const pack_type m33 = pack_type::load(lanes[10] + i);
+			const pack_type m34 = pack_type::load(lanes[11] + i);
+			const pack_type m41 = pack_type::load(lanes[12] + i);
+			const pack_type m42 = pack_type::load(lanes[13] + i);
+			const pack_type m43 = pack_type::load(lanes[14] + i);
+			const pack_type m44 = pack_type::load(lanes[15] + i);
+
+			const minors<pack_type> minor(m11, m12, m13, m14, m21, m22, m23, m24, m31, m32, m33, m34, m41, m42, m43, m44);
+			const pack_type determinant = minor.determinant();
+			determinant.store(determinants + i);
+			if (!compute_inverse)
+			{
+				continue;
+			}
+
+			const auto singular = determinant == zero;
+			const pack_type reciprocal = one / simd::select(singular, one, determinant);
+			auto store = [&](size_type _k, const pack_type& _adjugate)
+			{
+				simd::select(singular, (_k % 5 == 0) ? one : zero, _adjugate * reciprocal).store(lanes[_k] + i);
+			};
+			store(0, m22 * minor.c5 - m23 * minor.c4 + m24 * minor.c3);
+			store(1, m13 * minor.c4 - m12 * minor.c5 - m14 * minor.c3);
+			store(2, m42 * minor.s5 - m43 * minor.s4 + m44 * minor.s3);
+			store(3, m33 * minor.s4 - m32 * minor.s5 - m34 * minor.s3);
+			store(4, m23 * minor.c2 - m21 * minor.c5 - m24 * minor.c1);
+			store(5, m11 * minor.c5 - m13 * minor.c2 + m14 * minor.c1);
+			store(6, m43 * minor.s2 - m41 * minor.s5 - m44 * minor.s1);
+			store(7, m31 * minor.s5 - m33 * minor.s2 + m34 * minor.s1);
+			store(8, m21 * minor.c4 - m22 * minor.c2 + m24 * minor.c0);
+			store(9, m12 * minor.c2 - m11 * minor.c4 - m14 * minor.c0);
+			store(10, m41 * minor.s4 - m42 * minor.s2 + m44 * minor.s0);
+			store(11, m32 * minor.s2 - m31 * minor.s4 - m34 * minor.s0);
+			store(12, m22 * minor.c1 - m21 * minor.c3 - m23 * minor.c0);
+			store(13, m11 * minor.c3 - m12 * minor.c1 + m13 * minor.c0);
+			store(14, m42 * minor.s1 - m41 * minor.s3 - m43 * minor.s0);
+			store(15, m31 * minor.s3 - m32 * minor.s1 + m33 * minor.s0);
+		}
+
+		for (j = 0; j < _count; j++)
+		{
+			if (_determinant != nullptr)
+			{
+				_determinant[j] = determinants[j];
+			}
+			if (_singular != nullptr)
+			{
+				_singular[j] = determinants[j] == static_cast<value_type>(0);
+			}
+		}
+		if (compute_inverse)
+		{
+			for (j = 0; j + 4 <= _count; j += 4)
+			{
+				simd::soa_to_aos4<16>(lanes[0] + j, reinterpret_cast<value_type*>(_result + j), pitch);
+			}
+			for (; j < _count; j++)
+			{
+				for (size_type k = 0; k < 16; k++)
+				{
+					_result[j].m[k] = lanes[k][j];
+				}
+			}
+		}
+	}
+
+	///	<summary>上2行(s)と下2行(c)の2x2小行列式を1度ずつ求め、随伴行列と行列式を同時に求めます。</summary>
+	constexpr matrix4x4 adjugate(value_type& _determinant) const
+	{
+		const minors<value_type> minor(_11, _12, _13, _14, _21, _22, _23, _24, _31, _32, _33, _34, _41, _42, _43, _44);
+		_determinant = minor.determinant();
+		return matrix4x4<value_type>
+			(
+				_22 * minor.c5 - _23 * minor.c4 + _24 * minor.c3,
+				-_12 * minor.c5 + _13 * minor.c4 - _14 * minor.c3,
+				_42 * minor.s5 - _43 * minor.s4 + _44 * minor.s3,
+				-_32 * minor.s5 + _33 * minor.s4 - _34 * minor.s3,
+
+				-_21 * minor.c5 + _23 * minor.c2 - _24 * minor.c1,
+				_11 * minor.c5 - _13 * minor.c2 + _14 * minor.c1,
+				-_41 * minor.s5 + _43 * minor.s2 - _44 * minor.s1,
+				_31 * minor.s5 - _33 * minor.s2 + _34 * minor.s1,
+
+				_21 * minor.c4 - _22 * minor.c2 + _24 * minor.c0,
+				-_11 * minor.c4 + _12 * minor.c2 - _14 * minor.c0,
+				_41 * minor.s4 - _42 * minor.s2 + _44 * minor.s0,
+				-_31 * minor.s4 + _32 * minor.s2 - _34 * minor.s0,
+
+				-_21 * minor.c3 + _22 * minor.c1 - _23 * minor.c0,
+				_11 * minor.c3 - _12 * minor.c1 + _13 * minor.c0,
+				-_41 * minor.s3 + _42 * minor.s1 - _43 * minor.s0,
+				_31 * minor.s3 - _32 * minor.s1 + _33 * minor.s0
+				);
+	}
+
+	template<size_t input_size, size_t output_size, bool divide> void transform(const value_type* _input, value_type* _output, size_type _count, value_type _w) const
+	{
+		static_assert(sizeof(vector3<value_type>) == sizeof(value_type) * 3, "vector3 must be tightly packed.");
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			transform<input_size, output_size, divide>(_input + _begin * input_size, _output + _begin * output_size, _end - _begin, _w, simd::packed4<value_type>());
+		});
+	}
+
+#if defined(ARCH_SIMD_SSE)
+	///	<summary>4つの列をレジスタに保持し、各ベクトルを列の線形結合として変換します。</summary>
+	template<size_t input_size, size_t output_size, bool divide> void transform(const value_type* _input, value_type* _output, size_type _count, value_type _w, std::true_type) const
+	{
+		typedef typename simd::packed4<value_type>::type packed;
+		value_type columns[4][4];
+		for (size_type y = 0; y < 4; y++)
+		{
+			for (size_type x = 0; x < 4; x++)
+			{
+				columns[x][y] = data[y][x];
+			}
+		}
+		const packed column_x = simd::load4(columns[0]);
+		const packed column_y = simd::load4(columns[1]);
+		const packed column_z = simd::load4(columns[2]);
+		const packed column_w = input_size == 4 ? simd::load4(columns[3]) : simd::mul(simd::load4(columns[3]), simd::set4(_w));
+
+		for (size_type i = 0; i < _count; i++)
+		{
+			const value_type* value = _input + i * input_size;
+			packed result = input_size == 4 ? simd::mul(column_w, simd::set4(value[3])) : column_w;
+			result = simd::fmadd(column_z, simd::set4(value[2]), result);
+			result = simd::fmadd(column_y, simd::set4(value[1]), result);
+			result = simd::fmadd(column_x, simd::set4(value[0]), result);
+			if (divide)
+			{
+				result = simd::div(result, simd::splat<3>(result));
+			}
+
+			if (output_size == 4)
+			{
+				simd::store4(_output + i * output_size, result);
+			}
+			else
+			{
+				simd::store3(_output + i * output_size, result);
+			}
+		}
+	}
+#endif
+
+	template<size_t input_size, size_t output_size, bool divide> void transform(const value_type* _input, value_type* _output, size_type _count, value_type _w, std::false_type) const
+	{
+		for (size_type i = 0; i < _count; i++)
+		{
+			const value_type* value = _input + i * input_size;
+			const value_type w = input_size == 4 ? value[3] : _w;
+			value_type result[4];
+			for (size_type y = 0; y < 4; y++)
+			{
+				result[y] = data[y][0] * value[0] + data[y][1] * value[1] + data[y][2] * value[2] + data[y][3] * w;
+			}
+			for (size_type y = 0; y < output_size; y++)
+			{
+				_output[i * output_size + y] = divide ? result[y] / result[3] : result[y];
+			}
+		}
+	}
+
 public:
 	union
 	{
@@ -1,4 +1,4 @@
-//=================================================================================//
+﻿//=================================================================================//
 //                                                                                 //
 //  ArchMath                                                                       //
 //                                                                                 //
@@ -22,27 +22,27 @@ namespace prefix
 
 constexpr long double operator"" _tera(long double _value)
 {
-	return _value * pow(10.0, 12.0);
+	return _value * ipow<12>(static_cast<long double>(10.0));
 }
 
 constexpr long double operator"" _giga(long double _value)
 {
-	return _value * pow(10.0, 9.0);
+	return _value * ipow<9>(static_cast<long double>(10.0));
 }
 
 constexpr long double operator"" _mega(long double _value)
 {
-	return _value * pow(10.0, 6.0);
+	return _value * ipow<6>(static_cast<long double>(10.0));
 }
 
 constexpr long double operator"" _kilo(long double _value)
 {
-	return _value * pow(10.0, 3.0);
+	return _value * ipow<3>(static_cast<long double>(10.0));
 }
 
 constexpr long double operator"" _hecto(long double _value)
 {
-	return _value * pow(static_cast<long double>(10.0), static_cast<long double>(2.0));
+	return _value * ipow<2>(static_cast<long double>(10.0));
 }
 
 constexpr long double operator"" _deca(long double _value)
@@ -57,27 +57,27 @@ constexpr long double operator"" _deci(long double _value)
 
 constexpr long double operator"" _centi(long double _value)
 {
-	return _value / pow(static_cast<long double>(10.0), static_cast<long double>(2.0));
+	return _value / ipow<2>(static_cast<long double>(10.0));
 }
 
 constexpr long double operator"" _milli(long double _value)
 {
-	return _value / pow(static_cast<long double>(10.0), static_cast<long double>(3.0));
+	return _value / ipow<3>(static_cast<long double>(10.0));
 }
 
 constexpr long double operator"" _micro(long double _value)
 {
-	return _value / pow(static_cast<long double>(10.0), static_cast<long double>(6.0));
+	return _value / ipow<6>(static_cast<long double>(10.0));
 }
 
 constexpr long double operator"" _nano(long double _value)
 {
-	return _value / pow(static_cast<long double>(10.0), static_cast<long double>(9.0));
+	return _value / ipow<9>(static_cast<long double>(10.0));
 }
 
 constexpr long double operator"" _pico(long double _value)
 {
-	return _value / pow(static_cast<long double>(10.0), static_cast<long double>(12.0));
+	return _value / ipow<12>(static_cast<long double>(10.0));
 }
 
 }
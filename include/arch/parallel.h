@@ -0,0 +1,187 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "functions.h"
+
+/*!
+*	@brief 一括演算をスレッドに分割し始める要素数です。
+*	ARCH_NO_PARALLELを定義すると常に呼び出したスレッドで処理します。
+*/
+#if !defined(ARCH_PARALLEL_THRESHOLD)
+#define ARCH_PARALLEL_THRESHOLD 65536
+#endif
+
+namespace arch
+{
+
+/*!
+*	@brief 固定数のワーカースレッドでタスクを処理します。
+*/
+class thread_pool
+{
+public:
+	explicit thread_pool(size_t _thread_count)
+		: m_stop(false)
+	{
+		for (size_t i = 0; i < _thread_count; i++)
+		{
+			m_threads.emplace_back([this]() { run(); });
+		}
+	}
+
+	~thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_condition.notify_all();
+		for (auto& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	size_t size() const
+	{
+		return m_threads.size();
+	}
+
+	void push(std::function<void()> _task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_tasks.push(std::move(_task));
+		}
+		m_condition.notify_one();
+	}
+
+	///	<summary>現在のスレッドがいずれかのスレッドプールのワーカーかどうかを取得します。</summary>
+	static bool& is_worker()
+	{
+		static thread_local bool worker = false;
+		return worker;
+	}
+
+	///	<summary>ハードウェアスレッド数から呼び出し元の1スレッドを除いた数のワーカーを持つ共有プールを取得します。</summary>
+	static thread_pool& shared()
+	{
+		static thread_pool pool(max(std::thread::hardware_concurrency(), 1u) - 1);
+		return pool;
+	}
+
+private:
+	void run()
+	{
+		is_worker() = true;
+		for (;;)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+				if (m_stop && m_tasks.empty())
+				{
+					return;
+				}
+				task = std::move(m_tasks.front());
+				m_tasks.pop();
+			}
+			task();
+		}
+	}
+
+private:
+	std::vector<std::thread> m_threads;
+	std::queue<std::function<void()>> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_stop;
+};
+
+/*!
+*	@brief [0, _count)を_grain個以上ずつの区間に分け、共有スレッドプールと呼び出したスレッドで処理します。
+*	_functionは(begin, end)を受け取ります。ワーカー内から呼ばれた場合は入れ子にせずそのまま処理します。
+*	_functionが例外を送出した場合は全ての区間の終了を待ってから最初の例外を再送出します。
+*/
+template<class function_type> inline void parallel_for(size_t _count, size_t _grain, function_type _function)
+{
+#if !defined(ARCH_NO_PARALLEL)
+	if (_grain > 0 && _count >= _grain * 2 && !thread_pool::is_worker())
+	{
+		thread_pool& pool = thread_pool::shared();
+		size_t chunks = min(pool.size() + 1, _count / _grain);
+		if (chunks > 1)
+		{
+			size_t step = (_count + chunks - 1) / chunks;
+			size_t remaining = chunks - 1;
+			std::mutex mutex;
+			std::condition_variable finished;
+			std::exception_ptr exception;
+			// タスクは呼び出し元のスタック上の変数を参照するため、例外でも全ての区間が終わるまで戻りません。
+			auto run = [&](size_t _begin, size_t _end)
+			{
+				try
+				{
+					_function(_begin, _end);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (!exception)
+					{
+						exception = std::current_exception();
+					}
+				}
+			};
+			for (size_t c = 1; c < chunks; c++)
+			{
+				size_t begin = min(c * step, _count);
+				size_t end = min(begin + step, _count);
+				pool.push([&, begin, end]()
+				{
+					run(begin, end);
+					std::lock_guard<std::mutex> lock(mutex);
+					remaining--;
+					finished.notify_one();
+				});
+			}
+			run(static_cast<size_t>(0), step);
+
+			std::unique_lock<std::mutex> lock(mutex);
+			finished.wait(lock, [&]() { return remaining == 0; });
+			if (exception)
+			{
+				std::rethrow_exception(exception);
+			}
+			return;
+		}
+	}
+#else
+	static_cast<void>(_grain);
+#endif
+	_function(static_cast<size_t>(0), _count);
+}
+
+}
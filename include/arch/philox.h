@@ -0,0 +1,287 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "random.h"
+#include "simd.h"
+
+namespace arch
+{
+
+namespace simd
+{
+
+#if defined(ARCH_SIMD_SSE)
+
+/*!
+*	@brief 各32ビットレーンの積の上位と下位を求めます。
+*/
+inline void multiply_high_low(__m128i _a, __m128i _b, __m128i& _high, __m128i& _low)
+{
+	__m128i even = _mm_mul_epu32(_a, _b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(_a, 32), _mm_srli_epi64(_b, 32));
+	_low = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	_high = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+}
+
+inline __m128i set1_epi32(__m128i, uint32_t _value)
+{
+	return _mm_set1_epi32(static_cast<int>(_value));
+}
+
+inline __m128i exclusive_or(__m128i _a, __m128i _b)
+{
+	return _mm_xor_si128(_a, _b);
+}
+
+/*!
+*	@brief 4ブロック分のカウンタの並び(各レジスタが同じ語)を、ブロック順に並べて格納します。
+*/
+inline void store_blocks(uint32_t* _output, __m128i _c0, __m128i _c1, __m128i _c2, __m128i _c3)
+{
+	__m128i t0 = _mm_unpacklo_epi32(_c0, _c1);
+	__m128i t1 = _mm_unpacklo_epi32(_c2, _c3);
+	__m128i t2 = _mm_unpackhi_epi32(_c0, _c1);
+	__m128i t3 = _mm_unpackhi_epi32(_c2, _c3);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(_output + 0), _mm_unpacklo_epi64(t0, t1));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(_output + 4), _mm_unpackhi_epi64(t0, t1));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(_output + 8), _mm_unpacklo_epi64(t2, t3));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(_output + 12), _mm_unpackhi_epi64(t2, t3));
+}
+
+#endif
+
+#if defined(__AVX2__) && !defined(ARCH_NO_SIMD)
+
+inline void multiply_high_low(__m256i _a, __m256i _b, __m256i& _high, __m256i& _low)
+{
+	__m256i even = _mm256_mul_epu32(_a, _b);
+	__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(_a, 32), _mm256_srli_epi64(_b, 32));
+	_low = _mm256_unpacklo_epi32(_mm256_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm256_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	_high = _mm256_unpacklo_epi32(_mm256_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)), _mm256_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+}
+
+inline __m256i set1_epi32(__m256i, uint32_t _value)
+{
+	return _mm256_set1_epi32(static_cast<int>(_value));
+}
+
+inline __m256i exclusive_or(__m256i _a, __m256i _b)
+{
+	return _mm256_xor_si256(_a, _b);
+}
+
+inline void store_blocks(uint32_t* _output, __m256i _c0, __m256i _c1, __m256i _c2, __m256i _c3)
+{
+	__m256i t0 = _mm256_unpacklo_epi32(_c0, _c1);
+	__m256i t1 = _mm256_unpacklo_epi32(_c2, _c3);
+	__m256i t2 = _mm256_unpackhi_epi32(_c0, _c1);
+	__m256i t3 = _mm256_unpackhi_epi32(_c2, _c3);
+	__m256i b0 = _mm256_unpacklo_epi64(t0, t1);
+	__m256i b1 = _mm256_unpackhi_epi64(t0, t1);
+	__m256i b2 = _mm256_unpacklo_epi64(t2, t3);
+	__m256i b3 = _mm256_unpackhi_epi64(t2, t3);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(_output + 0), _mm256_permute2x128_si256(b0, b1, 0x20));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(_output + 8), _mm256_permute2x128_si256(b2, b3, 0x20));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(_output + 16), _mm256_permute2x128_si256(b0, b1, 0x31));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(_output + 24), _mm256_permute2x128_si256(b2, b3, 0x31));
+}
+
+#endif
+
+}
+
+/*!
+*	@brief カウンタ方式の乱数生成器Philox4x32-10です。
+*	(シード, ストリーム, カウンタ)から4個の32ビット値が一意に決まるため、
+*	どのスレッドがどの範囲を受け持っても同じ値が得られます。
+*	UniformRandomBitGeneratorの要件を満たすので、random()やvector4::random()に渡せます。
+*/
+class philox4x32
+{
+public:
+	typedef uint32_t result_type;
+	typedef uint32_t block_type[4];
+
+	static constexpr uint64_t default_seed = 20111129u;
+
+public:
+	explicit philox4x32(uint64_t _seed = default_seed, uint64_t _stream = 0, uint64_t _counter = 0)
+		: m_seed(_seed), m_stream(_stream), m_counter(_counter), m_index(4)
+	{
+	}
+
+	static constexpr result_type min()
+	{
+		return std::numeric_limits<result_type>::min();
+	}
+
+	static constexpr result_type max()
+	{
+		return std::numeric_limits<result_type>::max();
+	}
+
+	result_type operator()()
+	{
+		if (m_index == 4)
+		{
+			block(m_seed, m_stream, m_counter++, m_buffer);
+			m_index = 0;
+		}
+		return m_buffer[m_index++];
+	}
+
+	///	<summary>次に生成するブロックのカウンタを設定します。1ブロックは4個の値です。</summary>
+	void seek(uint64_t _counter)
+	{
+		m_counter = _counter;
+		m_index = 4;
+	}
+
+	uint64_t seed() const
+	{
+		return m_seed;
+	}
+
+	uint64_t stream() const
+	{
+		return m_stream;
+	}
+
+	///	<summary>次に生成するブロックのカウンタを取得します。</summary>
+	uint64_t counter() const
+	{
+		return m_counter;
+	}
+
+	/*!
+	*	@brief _count個の値を順に生成します。operator()を_count回呼んだ場合と同じ値になります。
+	*	まとまった部分はAVX2で8ブロック、SSE2で4ブロックを同時に求めます。
+	*/
+	void generate(result_type* _output, size_t _count)
+	{
+		size_t i = 0;
+		for (; i < _count && m_index < 4; i++)
+		{
+			_output[i] = m_buffer[m_index++];
+		}
+#if defined(__AVX2__) && !defined(ARCH_NO_SIMD)
+		for (; i + 32 <= _count; i += 32)
+		{
+			blocks<__m256i>(_output + i);
+		}
+#endif
+#if defined(ARCH_SIMD_SSE)
+		for (; i + 16 <= _count; i += 16)
+		{
+			blocks<__m128i>(_output + i);
+		}
+#endif
+		for (; i + 4 <= _count; i += 4)
+		{
+			block(m_seed, m_stream, m_counter++, _output + i);
+		}
+		if (i < _count)
+		{
+			block(m_seed, m_stream, m_counter++, m_buffer);
+			m_index = _count - i;
+			std::memcpy(_output + i, m_buffer, m_index * sizeof(result_type));
+		}
+	}
+
+	/*!
+	*	@brief カウンタ(_counter, _stream)を鍵_seedで暗号化した4個の値を求めます。
+	*/
+	static void block(uint64_t _seed, uint64_t _stream, uint64_t _counter, result_type* _output)
+	{
+		uint32_t k0 = static_cast<uint32_t>(_seed), k1 = static_cast<uint32_t>(_seed >> 32);
+		uint32_t c0 = static_cast<uint32_t>(_counter), c1 = static_cast<uint32_t>(_counter >> 32);
+		uint32_t c2 = static_cast<uint32_t>(_stream), c3 = static_cast<uint32_t>(_stream >> 32);
+		for (int round = 0; round < rounds; round++)
+		{
+			uint64_t p0 = static_cast<uint64_t>(multiplier0) * c0;
+			uint64_t p1 = static_cast<uint64_t>(multiplier1) * c2;
+			uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+			uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+			c1 = static_cast<uint32_t>(p1);
+			c3 = static_cast<uint32_t>(p0);
+			c0 = n0;
+			c2 = n2;
+			k0 += weyl0;
+			k1 += weyl1;
+		}
+		_output[0] = c0;
+		_output[1] = c1;
+		_output[2] = c2;
+		_output[3] = c3;
+	}
+
+private:
+#if defined(ARCH_SIMD_SSE)
+	/*!
+	*	@brief レジスタのレーン数だけ連続したカウンタのブロックを同時に求めます。
+	*/
+	template<class register_type> void blocks(result_type* _output)
+	{
+		const size_t lanes = sizeof(register_type) / sizeof(uint32_t);
+		alignas(32) uint32_t low[8], high[8];
+		for (size_t lane = 0; lane < lanes; lane++)
+		{
+			low[lane] = static_cast<uint32_t>(m_counter + lane);
+			high[lane] = static_cast<uint32_t>((m_counter + lane) >> 32);
+		}
+		m_counter += lanes;
+
+		register_type c0, c1, c2, c3;
+		std::memcpy(&c0, low, sizeof(register_type));
+		std::memcpy(&c1, high, sizeof(register_type));
+		c2 = simd::set1_epi32(c0, static_cast<uint32_t>(m_stream));
+		c3 = simd::set1_epi32(c0, static_cast<uint32_t>(m_stream >> 32));
+		const register_type m0 = simd::set1_epi32(c0, multiplier0);
+		const register_type m1 = simd::set1_epi32(c0, multiplier1);
+		uint32_t k0 = static_cast<uint32_t>(m_seed), k1 = static_cast<uint32_t>(m_seed >> 32);
+		for (int round = 0; round < rounds; round++)
+		{
+			register_type h0, l0, h1, l1;
+			simd::multiply_high_low(c0, m0, h0, l0);
+			simd::multiply_high_low(c2, m1, h1, l1);
+			c0 = simd::exclusive_or(simd::exclusive_or(h1, c1), simd::set1_epi32(c0, k0));
+			c2 = simd::exclusive_or(simd::exclusive_or(h0, c3), simd::set1_epi32(c0, k1));
+			c1 = l1;
+			c3 = l0;
+			k0 += weyl0;
+			k1 += weyl1;
+		}
+		simd::store_blocks(_output, c0, c1, c2, c3);
+	}
+#endif
+
+private:
+	static constexpr int rounds = 10;
+	static constexpr uint32_t multiplier0 = 0xD2511F53u;
+	static constexpr uint32_t multiplier1 = 0xCD9E8D57u;
+	static constexpr uint32_t weyl0 = 0x9E3779B9u;
+	static constexpr uint32_t weyl1 = 0xBB67AE85u;
+
+	uint64_t m_seed;
+	uint64_t m_stream;
+	uint64_t m_counter;
+	block_type m_buffer;
+	size_t m_index;
+};
+
+}
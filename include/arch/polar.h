@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include "trigonometric.h"
 #include "vector.h"
 
 namespace arch
@@ -57,9 +58,11 @@ public:
 		return radius != _polar.radius || theta != _polar.theta;
 	}
 
-	constexpr operator vector2<value_type>() const
+	operator vector2<value_type>() const
 	{
-		return vector2<value_type>(sin(theta) * radius, cos(theta) * radius);
+		value_type theta_sin, theta_cos;
+		sincos(theta, theta_sin, theta_cos);
+		return vector2<value_type>(theta_sin * radius, theta_cos * radius);
 	}
 
 public:
@@ -108,10 +111,11 @@ public:
 		return radius != polar.radius || theta1 != polar.theta1 || theta2 != polar.theta2;
 	}
 
-	constexpr operator vector3<value_type>() const
+	operator vector3<value_type>() const
 	{
-		value_type theta1_sin = sin(theta1);
-		return vector3<value_type>(theta1_sin * cos(theta2) * radius, theta1_sin * sin(theta2) * radius, cos(theta1) * radius);
+		vector2<value_type> sin, cos;
+		sincos(vector2<value_type>(theta1, theta2), sin, cos);
+		return vector3<value_type>(sin.x * cos.y * radius, sin.x * sin.y * radius, cos.x * radius);
 	}
 
 public:
@@ -12,11 +12,19 @@
 
 #pragma once
 
+#include <cmath>
+#include <limits>
+#include "parallel.h"
+#include "simd.h"
+#include "trigonometric.h"
 #include "vector.h"
 
 namespace arch
 {
 
+template <typename type> class matrix3x3;
+template <typename type> class matrix4x4;
+
 /*!
 *	@brief 4元数(クォータニオン)を表します。
 */
@@ -25,6 +33,7 @@ class quaternion
 {
 public:
 	quaternion() = default;
+	quaternion(const quaternion&) = default;
 	~quaternion() = default;
 
 	constexpr quaternion(value_type pitch, value_type yaw, value_type roll)
@@ -39,42 +48,23 @@ public:
 
 	quaternion(const vector3<value_type>& angles)
 	{
-		vector3<value_type>	half_angles;
 		vector3<value_type>	sin_angles, cos_angles;
-		vector4<value_type> q0, q1;
-
-		half_angles = vector3<value_type>(angles.x, angles.y, angles.z) * static_cast<value_type>(0.5);
-		sin_angles.x = sin(half_angles.x);
-		sin_angles.y = sin(half_angles.y);
-		sin_angles.z = sin(half_angles.z);
-		cos_angles.x = cos(half_angles.x);
-		cos_angles.y = cos(half_angles.y);
-		cos_angles.z = cos(half_angles.z);
-
-		q0.x = sin_angles.x * cos_angles.y * cos_angles.z;
-		q0.y = cos_angles.x * sin_angles.y * cos_angles.z;
-		q0.z = cos_angles.x * cos_angles.y * sin_angles.z;
-		q0.w = cos_angles.x * cos_angles.y * cos_angles.z;
-
-		q1.x = cos_angles.x * sin_angles.y * sin_angles.z;
-		q1.y = -sin_angles.x * cos_angles.y * sin_angles.z;
-		q1.z = -sin_angles.x * sin_angles.y * cos_angles.z;
-		q1.w = sin_angles.x * sin_angles.y * sin_angles.z;
-
-		*this = q0 + q1;
+		sincos(angles * static_cast<value_type>(0.5), sin_angles, cos_angles);
+		*this = rotation(sin_angles, cos_angles);
 	}
 
 	quaternion(const vector3<value_type>& axis, value_type angle)
 	{
 		angle *= static_cast<value_type>(0.5);
 
-		value_type sin_angle = sin(angle);
+		value_type sin_angle, cos_angle;
+		sincos(angle, sin_angle, cos_angle);
 		vector3<value_type> norm_axis = axis.normalized();
 
 		x = sin_angle * norm_axis.x;
 		y = sin_angle * norm_axis.y;
 		z = sin_angle * norm_axis.z;
-		w = cos(angle);
+		w = cos_angle;
 	}
 
 	quaternion(const vector4<value_type>& _q)
@@ -95,16 +85,133 @@ public:
 		return quaternion(-x, -y, -z, w);
 	}
 
+	/*!
+	*	@brief _vectorをこのクォータニオンが表す回転で回転します(q v q^-1)。単位クォータニオンを前提とします。
+	*	クォータニオンの積を2回求める代わりに、t = 2(q × v)としてv + wt + q × tで求めます。
+	*/
 	vector3<value_type> rotate(const vector3<value_type>& _vector) const
 	{
-		quaternion<value_type> vec(_vector.x, _vector.y, _vector.z, static_cast<value_type>(0.0));
-		return ((conjugated() * vec) * (*this)).real;
+		const value_type tx = static_cast<value_type>(2) * (y * _vector.z - z * _vector.y);
+		const value_type ty = static_cast<value_type>(2) * (z * _vector.x - x * _vector.z);
+		const value_type tz = static_cast<value_type>(2) * (x * _vector.y - y * _vector.x);
+		return vector3<value_type>
+			(
+				_vector.x + w * tx + (y * tz - z * ty),
+				_vector.y + w * ty + (z * tx - x * tz),
+				_vector.z + w * tz + (x * ty - y * tx)
+				);
 	}
 
+	///	<summary>_vectorのxyzを回転します。wはそのまま返します。</summary>
 	vector4<value_type> rotate(const vector4<value_type>& _vector) const
 	{
-		quaternion<value_type> vec(_vector.x, _vector.y, _vector.z, static_cast<value_type>(0.0));
-		auto result = (conjugated() * vec) * (*this);
+		const vector3<value_type> result = rotate(vector3<value_type>(_vector.x, _vector.y, _vector.z));
+		return vector4<value_type>(result.x, result.y, result.z, _vector.w);
+	}
+
+	/*!
+	*	@brief _count個のベクトルをまとめて回転します。結果は1要素版と丸め誤差の範囲で一致します。
+	*	回転行列を一度だけ求め、成分ごとの配列に並べ替えたベクトルをpack幅ずつ変換するため、1要素あたりの演算は9回の積和です。
+	*	_inputと_outputは同じ配列でも構いません。ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*/
+	void rotate(const vector3<value_type>* _input, vector3<value_type>* _output, size_t _count) const
+	{
+		value_type matrix[9];
+		rotation_matrix(matrix);
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_t _begin, size_t _end)
+		{
+			for (size_t i = _begin; i < _end; i += batch_size)
+			{
+				rotate(matrix, _input + i, _output + i, min(batch_size, _end - i));
+			}
+		});
+	}
+
+	/*!
+	*	@brief このクォータニオンが表す回転行列(列ベクトルに左から掛ける)に変換します。単位クォータニオンを前提とします。
+	*	三角関数を使わず、積9回と加減算で求めます。matrix3x3.hをインクルードしてから使ってください。
+	*/
+	matrix3x3<value_type> to_matrix3x3() const
+	{
+		value_type matrix[9];
+		rotation_matrix(matrix);
+		return matrix3x3<value_type>(matrix);
+	}
+
+	///	<summary>回転行列に平行移動0を加えた4x4行列に変換します。matrix4x4.hをインクルードしてから使ってください。</summary>
+	matrix4x4<value_type> to_matrix4x4() const
+	{
+		value_type matrix[9];
+		rotation_matrix(matrix);
+		const value_type zero = static_cast<value_type>(0.0);
+		return matrix4x4<value_type>
+			(
+				matrix[0], matrix[1], matrix[2], zero,
+				matrix[3], matrix[4], matrix[5], zero,
+				matrix[6], matrix[7], matrix[8], zero,
+				zero, zero, zero, static_cast<value_type>(1.0)
+				);
+	}
+
+	/*!
+	*	@brief 回転行列からクォータニオンを作ります(Shepperdの方法)。
+	*	トレースと対角成分のうち最大のものから1成分を平方根で求め、残りの3成分を非対角成分の和と差から求めるため、どの回転でも桁落ちしません。
+	*	wが負にならないように符号をそろえます。
+	*/
+	static quaternion from_matrix(const matrix3x3<value_type>& _matrix)
+	{
+		return from_matrix(_matrix._11, _matrix._12, _matrix._13, _matrix._21, _matrix._22, _matrix._23, _matrix._31, _matrix._32, _matrix._33);
+	}
+
+	///	<summary>4x4行列の左上3x3の回転行列からクォータニオンを作ります。平行移動は無視します。</summary>
+	static quaternion from_matrix(const matrix4x4<value_type>& _matrix)
+	{
+		return from_matrix(_matrix._11, _matrix._12, _matrix._13, _matrix._21, _matrix._22, _matrix._23, _matrix._31, _matrix._32, _matrix._33);
+	}
+
+	/*!
+	*	@brief _beginから_endへ球面線形補間(slerp)します。単位クォータニオンを前提とします。
+	*	内積が負のときは_endの符号を反転して短い方の弧を通ります。角度はsimd::acos/simd::sincosの多項式で求めるため、結果は一括版と一致します。
+	*/
+	static quaternion slerp(const quaternion& _begin, const quaternion& _end, value_type _factor)
+	{
+		return interpolate(_begin, _end, _factor, [](const auto* _b, const auto* _e, const auto& _t, auto* _r) { slerp(_b, _e, _t, _r); });
+	}
+
+	///	<summary>_count組の_begin[i]から_end[i]へ_factors[i]で球面線形補間します。_resultは_beginまたは_endと同じ配列でも構いません。</summary>
+	static void slerp(const quaternion* _begin, const quaternion* _end, const value_type* _factors, quaternion* _result, size_t _count)
+	{
+		interpolate(_begin, _end, _factors, _result, _count, [](const auto* _b, const auto* _e, const auto& _t, auto* _r) { slerp(_b, _e, _t, _r); });
+	}
+
+	/*!
+	*	@brief _beginから_endへ線形補間して正規化(nlerp)します。短い方の弧を通ります。
+	*	角速度が一定にならず、slerpとの角度の差は90度の回転の補間で最大0.9度、180度近くで最大8度程度になりますが、三角関数を使わないため最も速く求められます。
+	*/
+	static quaternion nlerp(const quaternion& _begin, const quaternion& _end, value_type _factor)
+	{
+		return interpolate(_begin, _end, _factor, [](const auto* _b, const auto* _e, const auto& _t, auto* _r) { nlerp(_b, _e, _t, _r); });
+	}
+
+	///	<summary>_count組の_begin[i]から_end[i]へ_factors[i]でnlerpします。_resultは_beginまたは_endと同じ配列でも構いません。</summary>
+	static void nlerp(const quaternion* _begin, const quaternion* _end, const value_type* _factors, quaternion* _result, size_t _count)
+	{
+		interpolate(_begin, _end, _factors, _result, _count, [](const auto* _b, const auto* _e, const auto& _t, auto* _r) { nlerp(_b, _e, _t, _r); });
+	}
+
+	/*!
+	*	@brief slerpの近似です。補間係数を内積の多項式で補正してからnlerpするため、三角関数を使わずにslerpとの角度の誤差を小さくできます。
+	*	補正の多項式はArseny Kapoulkineの"Approximating slerp"の係数を使います。slerpとの角度の差は最大7.7e-4ラジアン(0.05度)程度です。
+	*/
+	static quaternion fast_slerp(const quaternion& _begin, const quaternion& _end, value_type _factor)
+	{
+		return interpolate(_begin, _end, _factor, [](const auto* _b, const auto* _e, const auto& _t, auto* _r) { fast_slerp(_b, _e, _t, _r); });
+	}
+
+	///	<summary>_count組の_begin[i]から_end[i]へ_factors[i]でfast_slerpします。_resultは_beginまたは_endと同じ配列でも構いません。</summary>
+	static void fast_slerp(const quaternion* _begin, const quaternion* _end, const value_type* _factors, quaternion* _result, size_t _count)
+	{
+		interpolate(_begin, _end, _factors, _result, _count, [](const auto* _b, const auto* _e, const auto& _t, auto* _r) { fast_slerp(_b, _e, _t, _r); });
 	}
 
 public:
@@ -125,14 +232,7 @@ public:
 
 	quaternion operator*(const quaternion& _quaternion) const
 	{
-
-		return quaternion
-			(
-				(this->w * _quaternion.x) + (this->x * _quaternion.w) + (this->y * _quaternion.z) - (this->z * _quaternion.y),
-				(this->w * _quaternion.y) - (this->x * _quaternion.z) + (this->y * _quaternion.w) + (this->z * _quaternion.x),
-				(this->w * _quaternion.z) + (this->x * _quaternion.y) - (this->y * _quaternion.x) + (this->z * _quaternion.w),
-				(this->w * _quaternion.w) - (this->x * _quaternion.x) - (this->y * _quaternion.y) - (this->z * _quaternion.z)
-				);
+		return multiply(_quaternion, simd::packed4<value_type>());
 	}
 
 	quaternion& operator*=(const quaternion& quaternion)
@@ -152,11 +252,365 @@ public:
 	}
 
 public:
-	static constexpr quaternion& identity()
+	static constexpr quaternion identity()
 	{
 		return quaternion(static_cast<value_type>(0.0), static_cast<value_type>(0.0), static_cast<value_type>(0.0), static_cast<value_type>(1.0));
 	}
 
+	/*!
+	*	@brief _count組の角度(quaternion(const vector3&)と同じ並び)からまとめて作ります。
+	*	sin/cosはsincosでpack幅ずつ求め、ARCH_PARALLEL_THRESHOLD以上の要素はスレッドに分割します。
+	*/
+	static void rotation(const vector3<value_type>* _angles, quaternion* _result, size_t _count)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_t _begin, size_t _end)
+		{
+			const size_t block = 256;
+			value_type half_angles[3][block], sin[3][block], cos[3][block];
+			for (size_t begin = _begin; begin < _end; begin += block)
+			{
+				const size_t size = min(block, _end - begin);
+				for (size_t i = 0; i < size; i++)
+				{
+					half_angles[0][i] = _angles[begin + i].x * static_cast<value_type>(0.5);
+					half_angles[1][i] = _angles[begin + i].y * static_cast<value_type>(0.5);
+					half_angles[2][i] = _angles[begin + i].z * static_cast<value_type>(0.5);
+				}
+				for (size_t c = 0; c < 3; c++)
+				{
+					sincos(half_angles[c], sin[c], cos[c], size);
+				}
+				for (size_t i = 0; i < size; i++)
+				{
+					_result[begin + i] = rotation(vector3<value_type>(sin[0][i], sin[1][i], sin[2][i]), vector3<value_type>(cos[0][i], cos[1][i], cos[2][i]));
+				}
+			}
+		});
+	}
+
+private:
+	///< 一括回転・補間で一度に成分ごとの配列へ並べ替える要素の数
+	static const size_t batch_size = 64;
+
+#if defined(ARCH_SIMD_SSE)
+	/*!
+	*	@brief 4成分を1つのレジスタに置いて積を求めます。
+	*	*thisの各成分を全要素に複製し、_quaternionの成分を並べ替えて符号を付けたものとの積和を4回求めます。
+	*/
+	quaternion multiply(const quaternion& _quaternion, std::true_type) const
+	{
+		typedef typename simd::packed4<value_type>::type packed;
+		static const value_type signs[3][4] =
+		{
+			{ 1, -1, 1, -1 },
+			{ 1, 1, -1, -1 },
+			{ -1, 1, 1, -1 }
+		};
+		const packed a = simd::load4(data);
+		const packed b = simd::load4(_quaternion.data);
+		packed result = simd::mul(simd::splat<3>(a), b);
+		result = simd::fmadd(simd::mul(simd::splat<0>(a), simd::load4(signs[0])), simd::swap_pairs(simd::swap_halves(b)), result);
+		result = simd::fmadd(simd::mul(simd::splat<1>(a), simd::load4(signs[1])), simd::swap_halves(b), result);
+		result = simd::fmadd(simd::mul(simd::splat<2>(a), simd::load4(signs[2])), simd::swap_pairs(b), result);
+
+		value_type product[4];
+		simd::store4(product, result);
+		return quaternion(product[0], product[1], product[2], product[3]);
+	}
+#endif
+
+	quaternion multiply(const quaternion& _quaternion, std::false_type) const
+	{
+		return quaternion
+			(
+				(this->w * _quaternion.x) + (this->x * _quaternion.w) + (this->y * _quaternion.z) - (this->z * _quaternion.y),
+				(this->w * _quaternion.y) - (this->x * _quaternion.z) + (this->y * _quaternion.w) + (this->z * _quaternion.x),
+				(this->w * _quaternion.z) + (this->x * _quaternion.y) - (this->y * _quaternion.x) + (this->z * _quaternion.w),
+				(this->w * _quaternion.w) - (this->x * _quaternion.x) - (this->y * _quaternion.y) - (this->z * _quaternion.z)
+				);
+	}
+
+	///	<summary>このクォータニオンが表す回転行列(列ベクトルに左から掛ける)を行優先で_matrix[0..8]に書き込みます。</summary>
+	void rotation_matrix(value_type* _matrix) const
+	{
+		const value_type x2 = x + x, y2 = y + y, z2 = z + z;
+		const value_type xx = x * x2, yy = y * y2, zz = z * z2, xy = x * y2, xz = x * z2, yz = y * z2, wx = w * x2, wy = w * y2, wz = w * z2;
+		_matrix[0] = static_cast<value_type>(1) - yy - zz;
+		_matrix[1] = xy - wz;
+		_matrix[2] = xz + wy;
+		_matrix[3] = xy + wz;
+		_matrix[4] = static_cast<value_type>(1) - xx - zz;
+		_matrix[5] = yz - wx;
+		_matrix[6] = xz - wy;
+		_matrix[7] = yz + wx;
+		_matrix[8] = static_cast<value_type>(1) - xx - yy;
+	}
+
+	///	<summary>batch_size個以下のベクトルを成分ごとの配列に並べ替え、pack幅ずつ_matrixで変換します。</summary>
+	static void rotate(const value_type* _matrix, const vector3<value_type>* _input, vector3<value_type>* _output, size_t _count)
+	{
+		static_assert(sizeof(vector3<value_type>) == sizeof(value_type) * 3, "vector3 must be tightly packed.");
+		if (!simd::packed4<value_type>::value)
+		{
+			for (size_t j = 0; j < _count; j++)
+			{
+				const vector3<value_type>& v = _input[j];
+				_output[j] = vector3<value_type>
+					(
+						_matrix[0] * v.x + _matrix[1] * v.y + _matrix[2] * v.z,
+						_matrix[3] * v.x + _matrix[4] * v.y + _matrix[5] * v.z,
+						_matrix[6] * v.x + _matrix[7] * v.y + _matrix[8] * v.z
+						);
+			}
+			return;
+		}
+
+		typedef simd::pack<value_type> pack_type;
+		const size_t width = pack_type::width;
+		const size_t padded = (_count + width - 1) / width * width;
+		const size_t pitch = batch_size + width;
+		value_type lanes[3][pitch];
+		size_t j = 0;
+		for (; j + 4 <= _count; j += 4)
+		{
+			simd::aos_to_soa4<3>(reinterpret_cast<const value_type*>(_input + j), lanes[0] + j, pitch);
+		}
+		for (; j < padded; j++)
+		{
+			for (size_t k = 0; k < 3; k++)
+			{
+				lanes[k][j] = j < _count ? _input[j].data[k] : static_cast<value_type>(0);
+			}
+		}
+
+		const pack_type m11(_matrix[0]), m12(_matrix[1]), m13(_matrix[2]);
+		const pack_type m21(_matrix[3]), m22(_matrix[4]), m23(_matrix[5]);
+		const pack_type m31(_matrix[6]), m32(_matrix[7]), m33(_matrix[8]);
+		for (size_t i = 0; i < padded; i += width)
+		{
+			const pack_type vx = pack_type::load(lanes[0] + i), vy = pack_type::load(lanes[1] + i), vz = pack_type::load(lanes[2] + i);
+			simd::fmadd(m13, vz, simd::fmadd(m12, vy, m11 * vx)).store(lanes[0] + i);
+			simd::fmadd(m23, vz, simd::fmadd(m22, vy, m21 * vx)).store(lanes[1] + i);
+			simd::fmadd(m33, vz, simd::fmadd(m32, vy, m31 * vx)).store(lanes[2] + i);
+		}
+
+		for (j = 0; j + 4 <= _count; j += 4)
+		{
+			simd::soa_to_aos4<3>(lanes[0] + j, reinterpret_cast<value_type*>(_output + j), pitch);
+		}
+		for (; j < _count; j++)
+		{
+			for (size_t k = 0; k < 3; k++)
+			{
+				_output[j].data[k] = lanes[k][j];
+			}
+		}
+	}
+
+	static quaternion from_matrix(value_type _11, value_type _12, value_type _13, value_type _21, value_type _22, value_type _23, value_type _31, value_type _32, value_type _33)
+	{
+		const value_type one = static_cast<value_type>(1.0);
+		const value_type half = static_cast<value_type>(0.5);
+		const value_type trace = _11 + _22 + _33;
+		value_type result[4];
+		if (trace >= _11 && trace >= _22 && trace >= _33)
+		{
+			const value_type r = std::sqrt(one + trace), s = half / r;
+			result[0] = (_32 - _23) * s;
+			result[1] = (_13 - _31) * s;
+			result[2] = (_21 - _12) * s;
+			result[3] = r * half;
+		}
+		else if (_11 >= _22 && _11 >= _33)
+		{
+			const value_type r = std::sqrt(one + _11 - _22 - _33), s = half / r;
+			result[0] = r * half;
+			result[1] = (_12 + _21) * s;
+			result[2] = (_13 + _31) * s;
+			result[3] = (_32 - _23) * s;
+		}
+		else if (_22 >= _33)
+		{
+			const value_type r = std::sqrt(one - _11 + _22 - _33), s = half / r;
+			result[0] = (_12 + _21) * s;
+			result[1] = r * half;
+			result[2] = (_23 + _32) * s;
+			result[3] = (_13 - _31) * s;
+		}
+		else
+		{
+			const value_type r = std::sqrt(one - _11 - _22 + _33), s = half / r;
+			result[0] = (_13 + _31) * s;
+			result[1] = (_23 + _32) * s;
+			result[2] = r * half;
+			result[3] = (_21 - _12) * s;
+		}
+		const value_type sign = result[3] < static_cast<value_type>(0.0) ? -one : one;
+		return quaternion(result[0] * sign, result[1] * sign, result[2] * sign, result[3] * sign);
+	}
+
+	///	<summary>1組の補間を_functionのscalar版で求めます。</summary>
+	template<class function_type> static quaternion interpolate(const quaternion& _begin, const quaternion& _end, value_type _factor, function_type _function)
+	{
+		typedef simd::scalar<value_type> scalar_type;
+		const scalar_type begin[4] = { scalar_type(_begin.x), scalar_type(_begin.y), scalar_type(_begin.z), scalar_type(_begin.w) };
+		const scalar_type end[4] = { scalar_type(_end.x), scalar_type(_end.y), scalar_type(_end.z), scalar_type(_end.w) };
+		scalar_type result[4];
+		_function(begin, end, scalar_type(_factor), result);
+		return quaternion(result[0].value, result[1].value, result[2].value, result[3].value);
+	}
+
+	///	<summary>_count組の補間をbatch_size個ずつ求めます。ARCH_PARALLEL_THRESHOLD以上の組はスレッドに分割します。</summary>
+	template<class function_type> static void interpolate(const quaternion* _begin, const quaternion* _end, const value_type* _factors, quaternion* _result, size_t _count, function_type _function)
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_t _first, size_t _last)
+		{
+			for (size_t i = _first; i < _last; i += batch_size)
+			{
+				interpolate_block(_begin + i, _end + i, _factors + i, _result + i, min(batch_size, _last - i), _function);
+			}
+		});
+	}
+
+	///	<summary>batch_size個以下の組を成分ごとの配列に並べ替え、pack幅ずつ_functionで補間します。</summary>
+	template<class function_type> static void interpolate_block(const quaternion* _begin, const quaternion* _end, const value_type* _factors, quaternion* _result, size_t _count, function_type _function)
+	{
+		static_assert(sizeof(quaternion) == sizeof(value_type) * 4, "quaternion must be tightly packed.");
+		if (!simd::packed4<value_type>::value)
+		{
+			for (size_t j = 0; j < _count; j++)
+			{
+				_result[j] = interpolate(_begin[j], _end[j], _factors[j], _function);
+			}
+			return;
+		}
+
+		typedef simd::pack<value_type> pack_type;
+		const size_t width = pack_type::width;
+		const size_t padded = (_count + width - 1) / width * width;
+		const size_t pitch = batch_size + width;
+		value_type begin[4][pitch], end[4][pitch], factors[pitch];
+		size_t j = 0;
+		for (; j + 4 <= _count; j += 4)
+		{
+			simd::aos_to_soa4<4>(_begin[j].data, begin[0] + j, pitch);
+			simd::aos_to_soa4<4>(_end[j].data, end[0] + j, pitch);
+		}
+		for (; j < padded; j++)
+		{
+			// 端数は単位クォータニオンで埋め、正規化で0除算にならないようにする
+			for (size_t k = 0; k < 4; k++)
+			{
+				const value_type identity = static_cast<value_type>(k == 3 ? 1 : 0);
+				begin[k][j] = j < _count ? _begin[j].data[k] : identity;
+				end[k][j] = j < _count ? _end[j].data[k] : identity;
+			}
+		}
+		for (j = 0; j < padded; j++)
+		{
+			factors[j] = j < _count ? _factors[j] : static_cast<value_type>(0);
+		}
+
+		for (size_t i = 0; i < padded; i += width)
+		{
+			pack_type b[4], e[4], r[4];
+			for (size_t k = 0; k < 4; k++)
+			{
+				b[k] = pack_type::load(begin[k] + i);
+				e[k] = pack_type::load(end[k] + i);
+			}
+			_function(b, e, pack_type::load(factors + i), r);
+			for (size_t k = 0; k < 4; k++)
+			{
+				r[k].store(begin[k] + i);
+			}
+		}
+
+		for (j = 0; j + 4 <= _count; j += 4)
+		{
+			simd::soa_to_aos4<4>(begin[0] + j, _result[j].data, pitch);
+		}
+		for (; j < _count; j++)
+		{
+			for (size_t k = 0; k < 4; k++)
+			{
+				_result[j].data[k] = begin[k][j];
+			}
+		}
+	}
+
+	template<class pack_type> static pack_type dot(const pack_type* _a, const pack_type* _b)
+	{
+		return simd::fmadd(_a[3], _b[3], simd::fmadd(_a[2], _b[2], simd::fmadd(_a[1], _b[1], _a[0] * _b[0])));
+	}
+
+	///	<summary>成分ごとのpackで_begin * (1 - _factor) ± _end * _factorを求めて正規化します。符号は内積が負のとき-です。</summary>
+	template<class pack_type> static void nlerp(const pack_type* _begin, const pack_type* _end, const pack_type& _factor, pack_type* _result)
+	{
+		const pack_type zero(static_cast<value_type>(0.0));
+		const pack_type end_weight = simd::select(dot(_begin, _end) < zero, -_factor, _factor);
+		const pack_type begin_weight = pack_type(static_cast<value_type>(1.0)) - _factor;
+		for (size_t k = 0; k < 4; k++)
+		{
+			_result[k] = simd::fmadd(end_weight, _end[k], begin_weight * _begin[k]);
+		}
+		const pack_type scale = simd::rsqrt(dot(_result, _result));
+		for (size_t k = 0; k < 4; k++)
+		{
+			_result[k] = _result[k] * scale;
+		}
+	}
+
+	/*!
+	*	@brief 成分ごとのpackでslerpします。
+	*	θ = acos(|d|)として重みをsin(tθ) / sinθとcos(tθ) - cosθ sin(tθ) / sinθで求めます(後者はsin((1 - t)θ) / sinθと等しい)。
+	*	sinθがepsilon未満の組は線形補間の重みにします。
+	*/
+	template<class pack_type> static void slerp(const pack_type* _begin, const pack_type* _end, const pack_type& _factor, pack_type* _result)
+	{
+		const pack_type zero(static_cast<value_type>(0.0));
+		const pack_type d = dot(_begin, _end);
+		const pack_type theta = simd::acos(simd::min(simd::abs(d), pack_type(static_cast<value_type>(1.0))));
+		pack_type sin_theta, cos_theta, sin_t, cos_t;
+		simd::sincos(theta, sin_theta, cos_theta);
+		simd::sincos(theta * _factor, sin_t, cos_t);
+
+		const pack_type end_weight = simd::select(sin_theta < pack_type(std::numeric_limits<value_type>::epsilon()), _factor, sin_t / sin_theta);
+		const pack_type begin_weight = cos_t - cos_theta * end_weight;
+		const pack_type signed_end_weight = simd::select(d < zero, -end_weight, end_weight);
+		for (size_t k = 0; k < 4; k++)
+		{
+			_result[k] = simd::fmadd(signed_end_weight, _end[k], begin_weight * _begin[k]);
+		}
+	}
+
+	/*!
+	*	@brief 成分ごとのpackでfast_slerpします。
+	*	|d|の多項式kでt' = t + t(t - 0.5)(t - 1)kと補正し、t'でnlerpします。
+	*/
+	template<class pack_type> static void fast_slerp(const pack_type* _begin, const pack_type* _end, const pack_type& _factor, pack_type* _result)
+	{
+		static const value_type a[4] = { static_cast<value_type>(-1.43519), static_cast<value_type>(3.55645), static_cast<value_type>(-3.2452), static_cast<value_type>(1.0904) };
+		static const value_type b[3] = { static_cast<value_type>(0.215638), static_cast<value_type>(-1.06021), static_cast<value_type>(0.848013) };
+		const pack_type half(static_cast<value_type>(0.5));
+		const pack_type d = simd::abs(dot(_begin, _end));
+		const pack_type centered = _factor - half;
+		const pack_type k = simd::fmadd(simd::polynomial(d, a) * centered, centered, simd::polynomial(d, b));
+		const pack_type factor = simd::fmadd(_factor * centered * (_factor - pack_type(static_cast<value_type>(1.0))), k, _factor);
+		nlerp(_begin, _end, factor, _result);
+	}
+
+	///	<summary>半角のsin/cosから回転を表すクォータニオンを作ります。</summary>
+	static quaternion rotation(const vector3<value_type>& _sin, const vector3<value_type>& _cos)
+	{
+		return quaternion
+			(
+				_sin.x * _cos.y * _cos.z + _cos.x * _sin.y * _sin.z,
+				_cos.x * _sin.y * _cos.z - _sin.x * _cos.y * _sin.z,
+				_cos.x * _cos.y * _sin.z - _sin.x * _sin.y * _cos.z,
+				_cos.x * _cos.y * _cos.z + _sin.x * _sin.y * _sin.z
+				);
+	}
 
 public:
 	union
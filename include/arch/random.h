@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <random>
 #include <limits>
 #include <type_traits>
@@ -19,25 +21,79 @@
 namespace arch
 {
 
-inline std::mt19937_64& get_default_random_engine()
+/*!
+*	@brief 乱数関数で使用する乱数エンジンです。
+*/
+typedef std::mt19937_64 random_engine;
+
+/*!
+*	@brief _seedと_streamから乱数エンジンを作ります。
+*	タスクごとに異なる_streamを与えると、スレッドの割り当てに関係なく同じ系列が得られます。
+*/
+inline random_engine make_random_engine(uint64_t _seed, uint64_t _stream)
 {
-	static std::mt19937_64 default_random_engine;
+	std::seed_seq sequence{ static_cast<uint32_t>(_seed), static_cast<uint32_t>(_seed >> 32), static_cast<uint32_t>(_stream), static_cast<uint32_t>(_stream >> 32) };
+	return random_engine(sequence);
+}
+
+/*!
+*	@brief 現在のスレッドの乱数エンジンを取得します。
+*	最初に乱数を使ったスレッドはrandom_engineの既定のシードで、以降のスレッドは
+*	乱数を使い始めた順番をストリーム番号としたmake_random_engineで初期化されます。
+*	この順番はスレッドの実行順で変わるため、複数のスレッドで実行ごとに同じ系列が必要な場合は
+*	set_random_streamで呼び出し側が決めたストリーム番号を与えてください。
+*/
+inline random_engine& get_default_random_engine()
+{
+	static std::atomic<uint64_t> thread_count(0);
+	static thread_local random_engine default_random_engine = [&]()
+	{
+		uint64_t index = thread_count.fetch_add(1);
+		return index == 0 ? random_engine() : make_random_engine(random_engine::default_seed, index);
+	}();
 	return default_random_engine;
 }
 
+/*!
+*	@brief 現在のスレッドの乱数エンジンを、_seedと_streamから作ったmake_random_engineで初期化し直します。
+*	ワーカーの番号など、スレッドの実行順に依存しない_streamを各スレッドで与えると、実行ごとに同じ系列が得られます。
+*/
+inline void set_random_stream(uint64_t _stream, uint64_t _seed = random_engine::default_seed)
+{
+	get_default_random_engine() = make_random_engine(_seed, _stream);
+}
+
+/*!
+*	@brief _engineから[0, 1)の乱数を求めます。_engineにはrandom_engineのほか、philox4x32なども渡せます。
+*/
+template<class engine_type> inline double random(engine_type& _engine)
+{
+	return std::uniform_real_distribution<double>(0.0, 1.0)(_engine);
+}
+
 inline double random()
 {
-	return std::uniform_real_distribution<double>(0.0, 1.0)(get_default_random_engine());
+	return random(get_default_random_engine());
 }
 
-template<class value_type> inline value_type random()
+template<class value_type, class engine_type> inline value_type random(engine_type& _engine, value_type _minimum, value_type _maximum)
 {
-	return random(std::numeric_limits<value_type>::min(), std::numeric_limits<value_type>::max());
+	return typename std::conditional<std::is_integral<value_type>::value, std::uniform_int_distribution<value_type>, std::uniform_real_distribution<value_type>>::type(_minimum, _maximum)(_engine);
 }
 
 template<class value_type> inline value_type random(value_type _minimum, value_type _maximum)
 {
-	return std::conditional<std::is_integral<value_type>::value, std::uniform_int_distribution<value_type>, std::uniform_real_distribution<value_type>>::type(_minimum, _maximum)(get_default_random_engine());
+	return random(get_default_random_engine(), _minimum, _maximum);
+}
+
+template<class value_type, class engine_type> inline value_type random(engine_type& _engine)
+{
+	return random(_engine, std::numeric_limits<value_type>::min(), std::numeric_limits<value_type>::max());
+}
+
+template<class value_type> inline value_type random()
+{
+	return random<value_type>(get_default_random_engine());
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "functions.h"
+#include "philox.h"
+#include "random.h"
+#include "vector.h"
+
+namespace arch
+{
+
+/*!
+*	@brief random_fillが一度に生成するビット列の語数です。
+*/
+constexpr size_t random_fill_block_size = 1024;
+
+/*!
+*	@brief _engineの出力を32ビット単位で_count個並べます。
+*	64ビットのエンジンは1回の出力を下位32ビット、上位32ビットの順に分けます。
+*/
+template<class engine_type> inline void random_bits(engine_type& _engine, uint32_t* _output, size_t _count)
+{
+	static_assert(engine_type::min() == 0 && (engine_type::max() == 0xFFFFFFFFu || engine_type::max() == 0xFFFFFFFFFFFFFFFFu), "engine must produce 32 or 64 uniform bits.");
+	if (engine_type::max() == 0xFFFFFFFFu)
+	{
+		for (size_t i = 0; i < _count; i++)
+		{
+			_output[i] = static_cast<uint32_t>(_engine());
+		}
+		return;
+	}
+
+	size_t i = 0;
+	for (; i + 2 <= _count; i += 2)
+	{
+		uint64_t bits = static_cast<uint64_t>(_engine());
+		_output[i] = static_cast<uint32_t>(bits);
+		_output[i + 1] = static_cast<uint32_t>(bits >> 32);
+	}
+	if (i < _count)
+	{
+		_output[i] = static_cast<uint32_t>(_engine());
+	}
+}
+
+inline void random_bits(philox4x32& _engine, uint32_t* _output, size_t _count)
+{
+	_engine.generate(_output, _count);
+}
+
+/*!
+*	@brief _count個の一様乱数で_outputを埋めます。
+*	random_bitsで得た32ビット値bを順に使い、_minimum + (b >> 8) * ((_maximum - _minimum) / 2^24)を並べます。
+*	同じエンジンの状態からは、スレッドや命令セットによらず常に同じ列になります。
+*	例えばphilox4x32(42)で[-1, 1)を埋めると、先頭は0.225919724, -0.0628269911, -0.853536606, -0.318277001です。
+*	変換はブロック単位の単純なループで、コンパイラによりSIMD命令に展開されます。
+*/
+template<class engine_type> inline void random_fill(engine_type& _engine, float* _output, size_t _count, float _minimum, float _maximum)
+{
+	uint32_t bits[random_fill_block_size];
+	const float scale = (_maximum - _minimum) * (1.0f / 16777216.0f);
+	for (size_t i = 0; i < _count; i += random_fill_block_size)
+	{
+		const size_t size = min(random_fill_block_size, _count - i);
+		random_bits(_engine, bits, size);
+		float* output = _output + i;
+		for (size_t j = 0; j < size; j++)
+		{
+			output[j] = _minimum + static_cast<float>(static_cast<int32_t>(bits[j] >> 8)) * scale;
+		}
+	}
+}
+
+/*!
+*	@brief doubleは32ビット値を2個ずつ使い、((b0 << 21) | (b1 >> 11))の53ビットを[0, 1)に変換します。
+*/
+template<class engine_type> inline void random_fill(engine_type& _engine, double* _output, size_t _count, double _minimum, double _maximum)
+{
+	uint32_t bits[random_fill_block_size];
+	const double scale = (_maximum - _minimum) * (1.0 / 9007199254740992.0);
+	for (size_t i = 0; i < _count; i += random_fill_block_size / 2)
+	{
+		const size_t size = min(random_fill_block_size / 2, _count - i);
+		random_bits(_engine, bits, size * 2);
+		double* output = _output + i;
+		for (size_t j = 0; j < size; j++)
+		{
+			const uint64_t mantissa = (static_cast<uint64_t>(bits[j * 2]) << 21) | (bits[j * 2 + 1] >> 11);
+			output[j] = _minimum + static_cast<double>(static_cast<int64_t>(mantissa)) * scale;
+		}
+	}
+}
+
+/*!
+*	@brief float/double以外はディストリビューションを1つだけ作り、順に生成します。
+*/
+template<class value_type, class engine_type> inline void random_fill(engine_type& _engine, value_type* _output, size_t _count, value_type _minimum, value_type _maximum)
+{
+	typename std::conditional<std::is_integral<value_type>::value, std::uniform_int_distribution<value_type>, std::uniform_real_distribution<value_type>>::type distribution(_minimum, _maximum);
+	for (size_t i = 0; i < _count; i++)
+	{
+		_output[i] = distribution(_engine);
+	}
+}
+
+/*!
+*	@brief ベクトルの配列をx, y, z, wの順に並んだ要素の列として埋めます。
+*/
+template<class value_type, class engine_type> inline void random_fill(engine_type& _engine, vector2<value_type>* _output, size_t _count, value_type _minimum, value_type _maximum)
+{
+	static_assert(sizeof(vector2<value_type>) == sizeof(value_type) * 2, "vector2 must be tightly packed.");
+	random_fill(_engine, reinterpret_cast<value_type*>(_output), _count * 2, _minimum, _maximum);
+}
+
+template<class value_type, class engine_type> inline void random_fill(engine_type& _engine, vector3<value_type>* _output, size_t _count, value_type _minimum, value_type _maximum)
+{
+	static_assert(sizeof(vector3<value_type>) == sizeof(value_type) * 3, "vector3 must be tightly packed.");
+	random_fill(_engine, reinterpret_cast<value_type*>(_output), _count * 3, _minimum, _maximum);
+}
+
+template<class value_type, class engine_type> inline void random_fill(engine_type& _engine, vector4<value_type>* _output, size_t _count, value_type _minimum, value_type _maximum)
+{
+	static_assert(sizeof(vector4<value_type>) == sizeof(value_type) * 4, "vector4 must be tightly packed.");
+	random_fill(_engine, reinterpret_cast<value_type*>(_output), _count * 4, _minimum, _maximum);
+}
+
+/*!
+*	@brief 現在のスレッドの乱数エンジンで_outputを埋めます。
+*/
+template<class output_type, class value_type> inline void random_fill(output_type* _output, size_t _count, value_type _minimum, value_type _maximum)
+{
+	random_fill(get_default_random_engine(), _output, _count, _minimum, _maximum);
+}
+
+}
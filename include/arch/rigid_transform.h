@@ -0,0 +1,137 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include "matrix4x4.h"
+#include "quaternion.h"
+#include "vector.h"
+
+namespace arch
+{
+
+/*!
+*	@brief 回転・平行移動・一様な拡大縮小からなる変換を表します。点pを scale * (rotation p rotation^-1) + translation に移します。
+*	合成はクォータニオンの積と回転1回で済むためmatrix4x4の積(積64回)より安く、1つの変換が8要素なので階層構造もキャッシュに収まりやすくなります。
+*	rotationは単位クォータニオンを前提とします。
+*/
+template <typename type>
+class rigid_transform
+{
+public:
+	typedef type value_type;
+	typedef size_t size_type;
+
+public:
+	rigid_transform() = default;
+
+	rigid_transform(const quaternion<value_type>& _rotation, const vector3<value_type>& _translation, value_type _scale = static_cast<value_type>(1.0))
+		: rotation(_rotation), translation(_translation), scale(_scale)
+	{
+	}
+
+	static rigid_transform identity()
+	{
+		const value_type zero = static_cast<value_type>(0.0);
+		return rigid_transform(quaternion<value_type>(zero, zero, zero, static_cast<value_type>(1.0)), vector3<value_type>(zero, zero, zero));
+	}
+
+	/*!
+	*	@brief 回転・平行移動・一様な拡大縮小からなる4x4行列から作ります。
+	*	左上3x3の1列目の長さをscaleとし、scaleで割った回転行列からquaternion::from_matrixで回転を求めます。
+	*/
+	static rigid_transform from_matrix(const matrix4x4<value_type>& _matrix)
+	{
+		const value_type scale = std::sqrt(_matrix._11 * _matrix._11 + _matrix._21 * _matrix._21 + _matrix._31 * _matrix._31);
+		const value_type inverse_scale = static_cast<value_type>(1.0) / scale;
+		const quaternion<value_type> rotation = quaternion<value_type>::from_matrix(matrix3x3<value_type>
+			(
+				_matrix._11 * inverse_scale, _matrix._12 * inverse_scale, _matrix._13 * inverse_scale,
+				_matrix._21 * inverse_scale, _matrix._22 * inverse_scale, _matrix._23 * inverse_scale,
+				_matrix._31 * inverse_scale, _matrix._32 * inverse_scale, _matrix._33 * inverse_scale
+				));
+		return rigid_transform(rotation, vector3<value_type>(_matrix._14, _matrix._24, _matrix._34), scale);
+	}
+
+	///	<summary>同じ変換を表す4x4行列(列ベクトルに左から掛ける)に変換します。</summary>
+	matrix4x4<value_type> to_matrix4x4() const
+	{
+		matrix4x4<value_type> result = rotation.to_matrix4x4();
+		for (size_type y = 0; y < 3; y++)
+		{
+			for (size_type x = 0; x < 3; x++)
+			{
+				result.data[y][x] *= scale;
+			}
+			result.data[y][3] = translation.data[y];
+		}
+		return result;
+	}
+
+	/*!
+	*	@brief 逆変換を求めます。rotationの逆は共役で求め、scaleは0でない必要があります。
+	*/
+	rigid_transform inverse() const
+	{
+		const value_type inverse_scale = static_cast<value_type>(1.0) / scale;
+		const quaternion<value_type> inverse_rotation = rotation.conjugated();
+		return rigid_transform(inverse_rotation, inverse_rotation.rotate(translation) * -inverse_scale, inverse_scale);
+	}
+
+	///	<summary>点を変換します(平行移動を含みます)。</summary>
+	vector3<value_type> transform_point(const vector3<value_type>& _point) const
+	{
+		return rotation.rotate(_point * scale) + translation;
+	}
+
+	///	<summary>方向を変換します(平行移動を含みません)。</summary>
+	vector3<value_type> transform_direction(const vector3<value_type>& _direction) const
+	{
+		return rotation.rotate(_direction * scale);
+	}
+
+	/*!
+	*	@brief _count個の点をまとめて変換します。
+	*	4x4行列に一度だけ変換し、matrix4x4::transform_pointでSIMD化された一括変換を行います。_inputと_outputは同じ配列でも構いません。
+	*/
+	void transform_point(const vector3<value_type>* _input, vector3<value_type>* _output, size_type _count) const
+	{
+		to_matrix4x4().transform_point(_input, _output, _count);
+	}
+
+	void transform_direction(const vector3<value_type>* _input, vector3<value_type>* _output, size_type _count) const
+	{
+		to_matrix4x4().transform_direction(_input, _output, _count);
+	}
+
+public:
+	/*!
+	*	@brief 変換を合成します。結果は_transformを適用してから*thisを適用する変換です(行列の積と同じ順序)。
+	*/
+	rigid_transform operator*(const rigid_transform& _transform) const
+	{
+		return rigid_transform(rotation * _transform.rotation, rotation.rotate(_transform.translation * scale) + translation, scale * _transform.scale);
+	}
+
+	rigid_transform& operator*=(const rigid_transform& _transform)
+	{
+		*this = *this * _transform;
+		return *this;
+	}
+
+public:
+	quaternion<value_type> rotation;
+	vector3<value_type> translation;
+	value_type scale;
+};
+
+}
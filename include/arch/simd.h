@@ -0,0 +1,1857 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+/*!
+*	@brief コンパイラの命令セット指定からSIMD実装を選択します。
+*	ARCH_NO_SIMDを定義するとスカラー実装に戻ります。
+*/
+#if !defined(ARCH_NO_SIMD)
+#	if defined(__AVX512F__)
+#		define ARCH_SIMD_AVX512
+#	endif
+#	if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#		define ARCH_SIMD_FMA
+#	endif
+#	if defined(__AVX__)
+#		define ARCH_SIMD_AVX
+#	endif
+#	if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define ARCH_SIMD_SSE
+#	endif
+#endif
+
+#if defined(ARCH_SIMD_AVX512)
+#	define ARCH_SIMD_NAME "avx512"
+#elif defined(ARCH_SIMD_AVX)
+#	define ARCH_SIMD_NAME "avx"
+#elif defined(ARCH_SIMD_SSE)
+#	define ARCH_SIMD_NAME "sse"
+#else
+#	define ARCH_SIMD_NAME "scalar"
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#if defined(ARCH_SIMD_SSE)
+#include <immintrin.h>
+#endif
+
+namespace arch
+{
+
+namespace simd
+{
+
+#if defined(ARCH_SIMD_SSE)
+
+typedef __m128 float4_type;
+
+#if defined(ARCH_SIMD_AVX)
+typedef __m256d double4_type;
+#else
+struct double4_type
+{
+	__m128d xy;
+	__m128d zw;
+};
+#endif
+
+inline float4_type load4(const float* _data)
+{
+	return _mm_loadu_ps(_data);
+}
+
+inline void store4(float* _data, float4_type _value)
+{
+	_mm_storeu_ps(_data, _value);
+}
+
+inline float4_type set4(float _value)
+{
+	return _mm_set1_ps(_value);
+}
+
+inline float4_type add(float4_type _a, float4_type _b)
+{
+	return _mm_add_ps(_a, _b);
+}
+
+inline float4_type sub(float4_type _a, float4_type _b)
+{
+	return _mm_sub_ps(_a, _b);
+}
+
+inline float4_type mul(float4_type _a, float4_type _b)
+{
+	return _mm_mul_ps(_a, _b);
+}
+
+inline float4_type div(float4_type _a, float4_type _b)
+{
+	return _mm_div_ps(_a, _b);
+}
+
+inline float4_type min(float4_type _a, float4_type _b)
+{
+	return _mm_min_ps(_a, _b);
+}
+
+inline float4_type max(float4_type _a, float4_type _b)
+{
+	return _mm_max_ps(_a, _b);
+}
+
+inline float4_type abs(float4_type _value)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), _value);
+}
+
+inline float4_type negate(float4_type _value)
+{
+	return _mm_xor_ps(_mm_set1_ps(-0.0f), _value);
+}
+
+///< 1 / sqrt(_value)。近似命令の結果にニュートン法を1回適用し、相対誤差は3ulp程度です。
+inline float4_type rsqrt(float4_type _value)
+{
+	__m128 estimate = _mm_rsqrt_ps(_value);
+	__m128 half = _mm_mul_ps(_mm_set1_ps(0.5f), _value);
+	return _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(half, _mm_mul_ps(estimate, estimate))));
+}
+
+///< _a * _b + _c
+inline float4_type fmadd(float4_type _a, float4_type _b, float4_type _c)
+{
+#if defined(ARCH_SIMD_FMA)
+	return _mm_fmadd_ps(_a, _b, _c);
+#else
+	return _mm_add_ps(_mm_mul_ps(_a, _b), _c);
+#endif
+}
+
+///< index番目の要素を全要素に複製
+template<int index> inline float4_type splat(float4_type _value)
+{
+	return _mm_shuffle_ps(_value, _value, _MM_SHUFFLE(index, index, index, index));
+}
+
+///< 隣り合う2要素を入れ替えた(y, x, w, z)
+inline float4_type swap_pairs(float4_type _value)
+{
+	return _mm_shuffle_ps(_value, _value, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+///< 前半と後半の2要素を入れ替えた(z, w, x, y)
+inline float4_type swap_halves(float4_type _value)
+{
+	return _mm_shuffle_ps(_value, _value, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+///< 先頭2要素の書き込み
+inline void store2(float* _data, float4_type _value)
+{
+	_mm_storel_pi(reinterpret_cast<__m64*>(_data), _value);
+}
+
+///< 先頭3要素の書き込み
+inline void store3(float* _data, float4_type _value)
+{
+	_mm_storel_pi(reinterpret_cast<__m64*>(_data), _value);
+	_mm_store_ss(_data + 2, _mm_movehl_ps(_value, _value));
+}
+
+///< 全要素の総和
+inline float sum(float4_type _value)
+{
+	__m128 shuffled = _mm_shuffle_ps(_value, _value, _MM_SHUFFLE(2, 3, 0, 1));
+	__m128 sums = _mm_add_ps(_value, shuffled);
+	shuffled = _mm_movehl_ps(shuffled, sums);
+	return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+inline bool equal(float4_type _a, float4_type _b)
+{
+	return _mm_movemask_ps(_mm_cmpeq_ps(_a, _b)) == 0xF;
+}
+
+inline float sqrt(float _value)
+{
+	return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(_value)));
+}
+
+///< 4つの行を転置
+inline void transpose(float4_type& _r0, float4_type& _r1, float4_type& _r2, float4_type& _r3)
+{
+	_MM_TRANSPOSE4_PS(_r0, _r1, _r2, _r3);
+}
+
+/*!
+*	@brief 4x4行列の行を余因子行列の行に置き換え、行列式を全要素に複製して返します。
+*	2x2のブロックに分け、ブロックの行列式と余因子を1度ずつ求めて共有します。
+*/
+inline float4_type adjugate(float4_type& _r0, float4_type& _r1, float4_type& _r2, float4_type& _r3)
+{
+	// 2x2の行列[a b; c d]を(a, b, c, d)として扱います。
+	struct block
+	{
+		static __m128 multiply(__m128 _a, __m128 _b)
+		{
+			return _mm_add_ps(_mm_mul_ps(_a, _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(3, 0, 3, 0))), _mm_mul_ps(_mm_shuffle_ps(_a, _a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(1, 2, 1, 2))));
+		}
+
+		///< adj(_a) * _b
+		static __m128 adjugate_multiply(__m128 _a, __m128 _b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(_a, _a, _MM_SHUFFLE(0, 0, 3, 3)), _b), _mm_mul_ps(_mm_shuffle_ps(_a, _a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(1, 0, 3, 2))));
+		}
+
+		///< _a * adj(_b)
+		static __m128 multiply_adjugate(__m128 _a, __m128 _b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(_a, _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(0, 3, 0, 3))), _mm_mul_ps(_mm_shuffle_ps(_a, _a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(1, 2, 1, 2))));
+		}
+	};
+
+	const __m128 a = _mm_movelh_ps(_r0, _r1);
+	const __m128 b = _mm_movehl_ps(_r1, _r0);
+	const __m128 c = _mm_movelh_ps(_r2, _r3);
+	const __m128 d = _mm_movehl_ps(_r3, _r2);
+
+	// (|a|, |b|, |c|, |d|)
+	const __m128 determinants = _mm_sub_ps(
+		_mm_mul_ps(_mm_shuffle_ps(_r0, _r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(_r1, _r3, _MM_SHUFFLE(3, 1, 3, 1))),
+		_mm_mul_ps(_mm_shuffle_ps(_r0, _r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(_r1, _r3, _MM_SHUFFLE(2, 0, 2, 0))));
+	const __m128 determinant_a = splat<0>(determinants);
+	const __m128 determinant_b = splat<1>(determinants);
+	const __m128 determinant_c = splat<2>(determinants);
+	const __m128 determinant_d = splat<3>(determinants);
+
+	const __m128 dc = block::adjugate_multiply(d, c);
+	const __m128 ab = block::adjugate_multiply(a, b);
+	__m128 x = _mm_sub_ps(_mm_mul_ps(determinant_d, a), block::multiply(b, dc));
+	__m128 w = _mm_sub_ps(_mm_mul_ps(determinant_a, d), block::multiply(c, ab));
+	__m128 y = _mm_sub_ps(_mm_mul_ps(determinant_b, c), block::multiply_adjugate(d, ab));
+	__m128 z = _mm_sub_ps(_mm_mul_ps(determinant_c, b), block::multiply_adjugate(a, dc));
+
+	// |M| = |a||d| + |b||c| - tr(adj(a)b adj(d)c)
+	__m128 trace = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+	trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(2, 3, 0, 1)));
+	trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 0, 3, 2)));
+	const __m128 determinant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(determinant_a, determinant_d), _mm_mul_ps(determinant_b, determinant_c)), trace);
+
+	// 各ブロックの余因子を取りながら行に並べ直し、符号を付けます。
+	const __m128 sign = _mm_setr_ps(0.0f, -0.0f, -0.0f, 0.0f);
+	x = _mm_xor_ps(x, sign);
+	y = _mm_xor_ps(y, sign);
+	z = _mm_xor_ps(z, sign);
+	w = _mm_xor_ps(w, sign);
+	_r0 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3));
+	_r1 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2));
+	_r2 = _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3));
+	_r3 = _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2));
+	return determinant;
+}
+
+#if defined(ARCH_SIMD_AVX)
+
+inline double4_type load4(const double* _data)
+{
+	return _mm256_loadu_pd(_data);
+}
+
+inline void store4(double* _data, double4_type _value)
+{
+	_mm256_storeu_pd(_data, _value);
+}
+
+inline double4_type set4(double _value)
+{
+	return _mm256_set1_pd(_value);
+}
+
+inline double4_type add(double4_type _a, double4_type _b)
+{
+	return _mm256_add_pd(_a, _b);
+}
+
+inline double4_type sub(double4_type _a, double4_type _b)
+{
+	return _mm256_sub_pd(_a, _b);
+}
+
+inline double4_type mul(double4_type _a, double4_type _b)
+{
+	return _mm256_mul_pd(_a, _b);
+}
+
+inline double4_type div(double4_type _a, double4_type _b)
+{
+	return _mm256_div_pd(_a, _b);
+}
+
+inline double4_type min(double4_type _a, double4_type _b)
+{
+	return _mm256_min_pd(_a, _b);
+}
+
+inline double4_type max(double4_type _a, double4_type _b)
+{
+	return _mm256_max_pd(_a, _b);
+}
+
+inline double4_type abs(double4_type _value)
+{
+	return _mm256_andnot_pd(_mm256_set1_pd(-0.0), _value);
+}
+
+inline double4_type negate(double4_type _value)
+{
+	return _mm256_xor_pd(_mm256_set1_pd(-0.0), _value);
+}
+
+///< _a * _b + _c
+inline double4_type fmadd(double4_type _a, double4_type _b, double4_type _c)
+{
+#if defined(ARCH_SIMD_FMA)
+	return _mm256_fmadd_pd(_a, _b, _c);
+#else
+	return _mm256_add_pd(_mm256_mul_pd(_a, _b), _c);
+#endif
+}
+
+///< index番目の要素を全要素に複製
+template<int index> inline double4_type splat(double4_type _value)
+{
+	__m256d half = _mm256_permute2f128_pd(_value, _value, index < 2 ? 0x00 : 0x11);
+	return _mm256_permute_pd(half, (index & 1) ? 0xF : 0x0);
+}
+
+///< 隣り合う2要素を入れ替えた(y, x, w, z)
+inline double4_type swap_pairs(double4_type _value)
+{
+	return _mm256_permute_pd(_value, 0x5);
+}
+
+///< 前半と後半の2要素を入れ替えた(z, w, x, y)
+inline double4_type swap_halves(double4_type _value)
+{
+	return _mm256_permute2f128_pd(_value, _value, 0x01);
+}
+
+///< 先頭2要素の書き込み
+inline void store2(double* _data, double4_type _value)
+{
+	_mm_storeu_pd(_data, _mm256_castpd256_pd128(_value));
+}
+
+///< 先頭3要素の書き込み
+inline void store3(double* _data, double4_type _value)
+{
+	_mm_storeu_pd(_data, _mm256_castpd256_pd128(_value));
+	_mm_store_sd(_data + 2, _mm256_extractf128_pd(_value, 1));
+}
+
+///< 全要素の総和
+inline double sum(double4_type _value)
+{
+	__m128d low = _mm_add_pd(_mm256_castpd256_pd128(_value), _mm256_extractf128_pd(_value, 1));
+	return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+inline bool equal(double4_type _a, double4_type _b)
+{
+	return _mm256_movemask_pd(_mm256_cmp_pd(_a, _b, _CMP_EQ_OQ)) == 0xF;
+}
+
+///< 4つの行を転置
+inline void transpose(double4_type& _r0, double4_type& _r1, double4_type& _r2, double4_type& _r3)
+{
+	__m256d t0 = _mm256_unpacklo_pd(_r0, _r1);
+	__m256d t1 = _mm256_unpackhi_pd(_r0, _r1);
+	__m256d t2 = _mm256_unpacklo_pd(_r2, _r3);
+	__m256d t3 = _mm256_unpackhi_pd(_r2, _r3);
+	_r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+	_r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+	_r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+	_r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+
+#else
+
+inline double4_type load4(const double* _data)
+{
+	return { _mm_loadu_pd(_data), _mm_loadu_pd(_data + 2) };
+}
+
+inline void store4(double* _data, double4_type _value)
+{
+	_mm_storeu_pd(_data, _value.xy);
+	_mm_storeu_pd(_data + 2, _value.zw);
+}
+
+inline double4_type set4(double _value)
+{
+	return { _mm_set1_pd(_value), _mm_set1_pd(_value) };
+}
+
+inline double4_type add(double4_type _a, double4_type _b)
+{
+	return { _mm_add_pd(_a.xy, _b.xy), _mm_add_pd(_a.zw, _b.zw) };
+}
+
+inline double4_type sub(double4_type _a, double4_type _b)
+{
+	return { _mm_sub_pd(_a.xy, _b.xy), _mm_sub_pd(_a.zw, _b.zw) };
+}
+
+inline double4_type mul(double4_type _a, double4_type _b)
+{
+	return { _mm_mul_pd(_a.xy, _b.xy), _mm_mul_pd(_a.zw, _b.zw) };
+}
+
+inline double4_type div(double4_type _a, double4_type _b)
+{
+	return { _mm_div_pd(_a.xy, _b.xy), _mm_div_pd(_a.zw, _b.zw) };
+}
+
+inline double4_type min(double4_type _a, double4_type _b)
+{
+	return { _mm_min_pd(_a.xy, _b.xy), _mm_min_pd(_a.zw, _b.zw) };
+}
+
+inline double4_type max(double4_type _a, double4_type _b)
+{
+	return { _mm_max_pd(_a.xy, _b.xy), _mm_max_pd(_a.zw, _b.zw) };
+}
+
+inline double4_type abs(double4_type _value)
+{
+	const __m128d sign = _mm_set1_pd(-0.0);
+	return { _mm_andnot_pd(sign, _value.xy), _mm_andnot_pd(sign, _value.zw) };
+}
+
+inline double4_type negate(double4_type _value)
+{
+	const __m128d sign = _mm_set1_pd(-0.0);
+	return { _mm_xor_pd(sign, _value.xy), _mm_xor_pd(sign, _value.zw) };
+}
+
+///< _a * _b + _c
+inline double4_type fmadd(double4_type _a, double4_type _b, double4_type _c)
+{
+	return { _mm_add_pd(_mm_mul_pd(_a.xy, _b.xy), _c.xy), _mm_add_pd(_mm_mul_pd(_a.zw, _b.zw), _c.zw) };
+}
+
+///< index番目の要素を全要素に複製
+template<int index> inline double4_type splat(double4_type _value)
+{
+	__m128d half = index < 2 ? _value.xy : _value.zw;
+	half = _mm_shuffle_pd(half, half, (index & 1) ? 0x3 : 0x0);
+	return { half, half };
+}
+
+///< 隣り合う2要素を入れ替えた(y, x, w, z)
+inline double4_type swap_pairs(double4_type _value)
+{
+	return { _mm_shuffle_pd(_value.xy, _value.xy, 0x1), _mm_shuffle_pd(_value.zw, _value.zw, 0x1) };
+}
+
+///< 前半と後半の2要素を入れ替えた(z, w, x, y)
+inline double4_type swap_halves(double4_type _value)
+{
+	return { _value.zw, _value.xy };
+}
+
+///< 先頭2要素の書き込み
+inline void store2(double* _data, double4_type _value)
+{
+	_mm_storeu_pd(_data, _value.xy);
+}
+
+///< 先頭3要素の書き込み
+inline void store3(double* _data, double4_type _value)
+{
+	_mm_storeu_pd(_data, _value.xy);
+	_mm_store_sd(_data + 2, _value.zw);
+}
+
+///< 全要素の総和
+inline double sum(double4_type _value)
+{
+	__m128d low = _mm_add_pd(_value.xy, _value.zw);
+	return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+inline bool equal(double4_type _a, double4_type _b)
+{
+	return (_mm_movemask_pd(_mm_cmpeq_pd(_a.xy, _b.xy)) & _mm_movemask_pd(_mm_cmpeq_pd(_a.zw, _b.zw))) == 0x3;
+}
+
+///< 4つの行を転置
+inline void transpose(double4_type& _r0, double4_type& _r1, double4_type& _r2, double4_type& _r3)
+{
+	double4_type c0 = { _mm_unpacklo_pd(_r0.xy, _r1.xy), _mm_unpacklo_pd(_r2.xy, _r3.xy) };
+	double4_type c1 = { _mm_unpackhi_pd(_r0.xy, _r1.xy), _mm_unpackhi_pd(_r2.xy, _r3.xy) };
+	double4_type c2 = { _mm_unpacklo_pd(_r0.zw, _r1.zw), _mm_unpacklo_pd(_r2.zw, _r3.zw) };
+	double4_type c3 = { _mm_unpackhi_pd(_r0.zw, _r1.zw), _mm_unpackhi_pd(_r2.zw, _r3.zw) };
+	_r0 = c0;
+	_r1 = c1;
+	_r2 = c2;
+	_r3 = c3;
+}
+
+#endif
+
+inline double sqrt(double _value)
+{
+	__m128d value = _mm_set_sd(_value);
+	return _mm_cvtsd_f64(_mm_sqrt_sd(value, value));
+}
+
+#endif
+
+/*!
+*	@brief 4要素を1つのレジスタに収める型です。SIMD化されていない型ではvalueがfalseになります。
+*/
+template<class value_type> struct packed4 : std::false_type
+{
+};
+
+#if defined(ARCH_SIMD_SSE)
+
+template<> struct packed4<float> : std::true_type
+{
+	typedef float4_type type;
+};
+
+template<> struct packed4<double> : std::true_type
+{
+	typedef double4_type type;
+};
+
+#endif
+
+/*!
+*	@brief _size個の成分を持つ4つの要素(AoS)を成分ごとの配列(SoA)へ並べ替えます。
+*	_output[k * _pitch + j] = _input[j * size + k]です。float/doubleでは4成分ずつ4x4の転置で処理します。
+*/
+template<size_t size, class type> inline void aos_to_soa4(const type* _input, type* _output, size_t _pitch)
+{
+	for (size_t j = 0; j < 4; j++)
+	{
+		for (size_t k = 0; k < size; k++)
+		{
+			_output[k * _pitch + j] = _input[j * size + k];
+		}
+	}
+}
+
+///	<summary>aos_to_soa4の逆で、成分ごとの配列から4つの要素へ書き戻します。</summary>
+template<size_t size, class type> inline void soa_to_aos4(const type* _input, type* _output, size_t _pitch)
+{
+	for (size_t j = 0; j < 4; j++)
+	{
+		for (size_t k = 0; k < size; k++)
+		{
+			_output[j * size + k] = _input[k * _pitch + j];
+		}
+	}
+}
+
+#if defined(ARCH_SIMD_SSE)
+
+template<size_t size, class type> inline void aos_to_soa4_packed(const type* _input, type* _output, size_t _pitch)
+{
+	for (size_t k = 0; k + 4 <= size; k += 4)
+	{
+		typename packed4<type>::type r0 = load4(_input + k), r1 = load4(_input + size + k), r2 = load4(_input + size * 2 + k), r3 = load4(_input + size * 3 + k);
+		transpose(r0, r1, r2, r3);
+		store4(_output + k * _pitch, r0);
+		store4(_output + (k + 1) * _pitch, r1);
+		store4(_output + (k + 2) * _pitch, r2);
+		store4(_output + (k + 3) * _pitch, r3);
+	}
+	for (size_t k = size / 4 * 4; k < size; k++)
+	{
+		for (size_t j = 0; j < 4; j++)
+		{
+			_output[k * _pitch + j] = _input[j * size + k];
+		}
+	}
+}
+
+template<size_t size, class type> inline void soa_to_aos4_packed(const type* _input, type* _output, size_t _pitch)
+{
+	for (size_t k = 0; k + 4 <= size; k += 4)
+	{
+		typename packed4<type>::type r0 = load4(_input + k * _pitch), r1 = load4(_input + (k + 1) * _pitch), r2 = load4(_input + (k + 2) * _pitch), r3 = load4(_input + (k + 3) * _pitch);
+		transpose(r0, r1, r2, r3);
+		store4(_output + k, r0);
+		store4(_output + size + k, r1);
+		store4(_output + size * 2 + k, r2);
+		store4(_output + size * 3 + k, r3);
+	}
+	for (size_t k = size / 4 * 4; k < size; k++)
+	{
+		for (size_t j = 0; j < 4; j++)
+		{
+			_output[j * size + k] = _input[k * _pitch + j];
+		}
+	}
+}
+
+template<size_t size> inline void aos_to_soa4(const float* _input, float* _output, size_t _pitch)
+{
+	aos_to_soa4_packed<size>(_input, _output, _pitch);
+}
+
+template<size_t size> inline void aos_to_soa4(const double* _input, double* _output, size_t _pitch)
+{
+	aos_to_soa4_packed<size>(_input, _output, _pitch);
+}
+
+template<size_t size> inline void soa_to_aos4(const float* _input, float* _output, size_t _pitch)
+{
+	soa_to_aos4_packed<size>(_input, _output, _pitch);
+}
+
+template<size_t size> inline void soa_to_aos4(const double* _input, double* _output, size_t _pitch)
+{
+	soa_to_aos4_packed<size>(_input, _output, _pitch);
+}
+
+#endif
+
+#if defined(ARCH_SIMD_AVX512)
+
+struct float_mask
+{
+	__mmask16 value;
+};
+
+struct packed_float
+{
+	typedef float value_type;
+	typedef float_mask mask_type;
+	static const size_t width = 16;
+
+	packed_float() = default;
+
+	packed_float(__m512 _value)
+		: value(_value)
+	{
+	}
+
+	explicit packed_float(value_type _value)
+		: value(_mm512_set1_ps(_value))
+	{
+	}
+
+	static packed_float load(const value_type* _data)
+	{
+		return _mm512_loadu_ps(_data);
+	}
+
+	void store(value_type* _data) const
+	{
+		_mm512_storeu_ps(_data, value);
+	}
+
+	__m512 value;
+};
+
+inline packed_float operator+(const packed_float& _a, const packed_float& _b)
+{
+	return _mm512_add_ps(_a.value, _b.value);
+}
+
+inline packed_float operator-(const packed_float& _a, const packed_float& _b)
+{
+	return _mm512_sub_ps(_a.value, _b.value);
+}
+
+inline packed_float operator*(const packed_float& _a, const packed_float& _b)
+{
+	return _mm512_mul_ps(_a.value, _b.value);
+}
+
+inline packed_float operator/(const packed_float& _a, const packed_float& _b)
+{
+	return _mm512_div_ps(_a.value, _b.value);
+}
+
+inline packed_float operator-(const packed_float& _value)
+{
+	return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_value.value), _mm512_set1_epi32(static_cast<int>(0x80000000))));
+}
+
+inline float_mask operator<(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm512_cmp_ps_mask(_a.value, _b.value, _CMP_LT_OQ) };
+}
+
+inline float_mask operator<=(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm512_cmp_ps_mask(_a.value, _b.value, _CMP_LE_OQ) };
+}
+
+inline float_mask operator>(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm512_cmp_ps_mask(_a.value, _b.value, _CMP_GT_OQ) };
+}
+
+inline float_mask operator>=(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm512_cmp_ps_mask(_a.value, _b.value, _CMP_GE_OQ) };
+}
+
+inline float_mask operator==(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm512_cmp_ps_mask(_a.value, _b.value, _CMP_EQ_OQ) };
+}
+
+inline float_mask operator!=(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm512_cmp_ps_mask(_a.value, _b.value, _CMP_NEQ_UQ) };
+}
+
+inline float_mask operator&(const float_mask& _a, const float_mask& _b)
+{
+	return { static_cast<__mmask16>(_a.value & _b.value) };
+}
+
+inline float_mask operator|(const float_mask& _a, const float_mask& _b)
+{
+	return { static_cast<__mmask16>(_a.value | _b.value) };
+}
+
+inline float_mask operator!(const float_mask& _mask)
+{
+	return { static_cast<__mmask16>(~_mask.value) };
+}
+
+inline bool any(const float_mask& _mask)
+{
+	return _mask.value != 0;
+}
+
+inline bool all(const float_mask& _mask)
+{
+	return _mask.value == 0xFFFF;
+}
+
+///< _maskが真の要素は_a、偽の要素は_bを選びます。
+inline packed_float select(const float_mask& _mask, const packed_float& _a, const packed_float& _b)
+{
+	return _mm512_mask_blend_ps(_mask.value, _b.value, _a.value);
+}
+
+inline packed_float min(const packed_float& _a, const packed_float& _b)
+{
+	return _mm512_min_ps(_a.value, _b.value);
+}
+
+inline packed_float max(const packed_float& _a, const packed_float& _b)
+{
+	return _mm512_max_ps(_a.value, _b.value);
+}
+
+inline packed_float abs(const packed_float& _value)
+{
+	return _mm512_abs_ps(_value.value);
+}
+
+inline packed_float sqrt(const packed_float& _value)
+{
+	return _mm512_sqrt_ps(_value.value);
+}
+
+///< 1 / sqrt(_value)。近似命令の結果にニュートン法を1回適用し、相対誤差は3ulp程度です。
+inline packed_float rsqrt(const packed_float& _value)
+{
+	packed_float estimate = _mm512_rsqrt14_ps(_value.value);
+	return estimate * (packed_float(1.5f) - packed_float(0.5f) * _value * estimate * estimate);
+}
+
+///< _a * _b + _c
+inline packed_float fmadd(const packed_float& _a, const packed_float& _b, const packed_float& _c)
+{
+	return _mm512_fmadd_ps(_a.value, _b.value, _c.value);
+}
+
+///< _row(i)が返す4要素の行を転置し、_columns[c]のレーンiに_row(i)[c]を並べます。_rowはpackの幅の回数だけ呼ばれます。
+template<class function_type> inline void gather4(function_type _row, packed_float* _columns)
+{
+	// 128bitのブロックqに行4q..4q + 3が並ぶように読み、ブロックごとに4x4を転置する
+	const __m512 r0 = _mm512_insertf32x4(_mm512_insertf32x4(_mm512_insertf32x4(_mm512_castps128_ps512(_mm_loadu_ps(_row(0))), _mm_loadu_ps(_row(4)), 1), _mm_loadu_ps(_row(8)), 2), _mm_loadu_ps(_row(12)), 3);
+	const __m512 r1 = _mm512_insertf32x4(_mm512_insertf32x4(_mm512_insertf32x4(_mm512_castps128_ps512(_mm_loadu_ps(_row(1))), _mm_loadu_ps(_row(5)), 1), _mm_loadu_ps(_row(9)), 2), _mm_loadu_ps(_row(13)), 3);
+	const __m512 r2 = _mm512_insertf32x4(_mm512_insertf32x4(_mm512_insertf32x4(_mm512_castps128_ps512(_mm_loadu_ps(_row(2))), _mm_loadu_ps(_row(6)), 1), _mm_loadu_ps(_row(10)), 2), _mm_loadu_ps(_row(14)), 3);
+	const __m512 r3 = _mm512_insertf32x4(_mm512_insertf32x4(_mm512_insertf32x4(_mm512_castps128_ps512(_mm_loadu_ps(_row(3))), _mm_loadu_ps(_row(7)), 1), _mm_loadu_ps(_row(11)), 2), _mm_loadu_ps(_row(15)), 3);
+	const __m512 xy01 = _mm512_unpacklo_ps(r0, r1);
+	const __m512 zw01 = _mm512_unpackhi_ps(r0, r1);
+	const __m512 xy23 = _mm512_unpacklo_ps(r2, r3);
+	const __m512 zw23 = _mm512_unpackhi_ps(r2, r3);
+	_columns[0] = _mm512_shuffle_ps(xy01, xy23, _MM_SHUFFLE(1, 0, 1, 0));
+	_columns[1] = _mm512_shuffle_ps(xy01, xy23, _MM_SHUFFLE(3, 2, 3, 2));
+	_columns[2] = _mm512_shuffle_ps(zw01, zw23, _MM_SHUFFLE(1, 0, 1, 0));
+	_columns[3] = _mm512_shuffle_ps(zw01, zw23, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+struct double_mask
+{
+	__mmask8 value;
+};
+
+struct packed_double
+{
+	typedef double value_type;
+	typedef double_mask mask_type;
+	static const size_t width = 8;
+
+	packed_double() = default;
+
+	packed_double(__m512d _value)
+		: value(_value)
+	{
+	}
+
+	explicit packed_double(value_type _value)
+		: value(_mm512_set1_pd(_value))
+	{
+	}
+
+	static packed_double load(const value_type* _data)
+	{
+		return _mm512_loadu_pd(_data);
+	}
+
+	void store(value_type* _data) const
+	{
+		_mm512_storeu_pd(_data, value);
+	}
+
+	__m512d value;
+};
+
+inline packed_double operator+(const packed_double& _a, const packed_double& _b)
+{
+	return _mm512_add_pd(_a.value, _b.value);
+}
+
+inline packed_double operator-(const packed_double& _a, const packed_double& _b)
+{
+	return _mm512_sub_pd(_a.value, _b.value);
+}
+
+inline packed_double operator*(const packed_double& _a, const packed_double& _b)
+{
+	return _mm512_mul_pd(_a.value, _b.value);
+}
+
+inline packed_double operator/(const packed_double& _a, const packed_double& _b)
+{
+	return _mm512_div_pd(_a.value, _b.value);
+}
+
+inline packed_double operator-(const packed_double& _value)
+{
+	return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_value.value), _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ULL))));
+}
+
+inline double_mask operator<(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm512_cmp_pd_mask(_a.value, _b.value, _CMP_LT_OQ) };
+}
+
+inline double_mask operator<=(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm512_cmp_pd_mask(_a.value, _b.value, _CMP_LE_OQ) };
+}
+
+inline double_mask operator>(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm512_cmp_pd_mask(_a.value, _b.value, _CMP_GT_OQ) };
+}
+
+inline double_mask operator>=(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm512_cmp_pd_mask(_a.value, _b.value, _CMP_GE_OQ) };
+}
+
+inline double_mask operator==(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm512_cmp_pd_mask(_a.value, _b.value, _CMP_EQ_OQ) };
+}
+
+inline double_mask operator!=(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm512_cmp_pd_mask(_a.value, _b.value, _CMP_NEQ_UQ) };
+}
+
+inline double_mask operator&(const double_mask& _a, const double_mask& _b)
+{
+	return { static_cast<__mmask8>(_a.value & _b.value) };
+}
+
+inline double_mask operator|(const double_mask& _a, const double_mask& _b)
+{
+	return { static_cast<__mmask8>(_a.value | _b.value) };
+}
+
+inline double_mask operator!(const double_mask& _mask)
+{
+	return { static_cast<__mmask8>(~_mask.value) };
+}
+
+inline bool any(const double_mask& _mask)
+{
+	return _mask.value != 0;
+}
+
+inline bool all(const double_mask& _mask)
+{
+	return _mask.value == 0xFF;
+}
+
+///< _maskが真の要素は_a、偽の要素は_bを選びます。
+inline packed_double select(const double_mask& _mask, const packed_double& _a, const packed_double& _b)
+{
+	return _mm512_mask_blend_pd(_mask.value, _b.value, _a.value);
+}
+
+inline packed_double min(const packed_double& _a, const packed_double& _b)
+{
+	return _mm512_min_pd(_a.value, _b.value);
+}
+
+inline packed_double max(const packed_double& _a, const packed_double& _b)
+{
+	return _mm512_max_pd(_a.value, _b.value);
+}
+
+inline packed_double abs(const packed_double& _value)
+{
+	return _mm512_abs_pd(_value.value);
+}
+
+inline packed_double sqrt(const packed_double& _value)
+{
+	return _mm512_sqrt_pd(_value.value);
+}
+
+///< 1 / sqrt(_value)。14ビットの近似値にニュートン法を2回適用し、相対誤差は数ulpです。
+inline packed_double rsqrt(const packed_double& _value)
+{
+	packed_double estimate = _mm512_rsqrt14_pd(_value.value);
+	const packed_double half = packed_double(0.5) * _value;
+	estimate = estimate * (packed_double(1.5) - half * estimate * estimate);
+	return estimate * (packed_double(1.5) - half * estimate * estimate);
+}
+
+///< _a * _b + _c
+inline packed_double fmadd(const packed_double& _a, const packed_double& _b, const packed_double& _c)
+{
+	return _mm512_fmadd_pd(_a.value, _b.value, _c.value);
+}
+
+///< _row(i)が返す4要素の行を転置し、_columns[c]のレーンiに_row(i)[c]を並べます。_rowはpackの幅の回数だけ呼ばれます。
+template<class function_type> inline void gather4(function_type _row, packed_double* _columns)
+{
+	// 256bitの上下に行0..3と4..7を読み、256bitごとに4x4を転置する
+	const __m512d r0 = _mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_loadu_pd(_row(0))), _mm256_loadu_pd(_row(4)), 1);
+	const __m512d r1 = _mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_loadu_pd(_row(1))), _mm256_loadu_pd(_row(5)), 1);
+	const __m512d r2 = _mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_loadu_pd(_row(2))), _mm256_loadu_pd(_row(6)), 1);
+	const __m512d r3 = _mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_loadu_pd(_row(3))), _mm256_loadu_pd(_row(7)), 1);
+	const __m512d xz01 = _mm512_unpacklo_pd(r0, r1);
+	const __m512d yw01 = _mm512_unpackhi_pd(r0, r1);
+	const __m512d xz23 = _mm512_unpacklo_pd(r2, r3);
+	const __m512d yw23 = _mm512_unpackhi_pd(r2, r3);
+	const __m512i low = _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13);
+	const __m512i high = _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15);
+	_columns[0] = _mm512_permutex2var_pd(xz01, low, xz23);
+	_columns[1] = _mm512_permutex2var_pd(yw01, low, yw23);
+	_columns[2] = _mm512_permutex2var_pd(xz01, high, xz23);
+	_columns[3] = _mm512_permutex2var_pd(yw01, high, yw23);
+}
+
+#elif defined(ARCH_SIMD_AVX)
+
+struct float_mask
+{
+	__m256 value;
+};
+
+struct packed_float
+{
+	typedef float value_type;
+	typedef float_mask mask_type;
+	static const size_t width = 8;
+
+	packed_float() = default;
+
+	packed_float(__m256 _value)
+		: value(_value)
+	{
+	}
+
+	explicit packed_float(value_type _value)
+		: value(_mm256_set1_ps(_value))
+	{
+	}
+
+	static packed_float load(const value_type* _data)
+	{
+		return _mm256_loadu_ps(_data);
+	}
+
+	void store(value_type* _data) const
+	{
+		_mm256_storeu_ps(_data, value);
+	}
+
+	__m256 value;
+};
+
+inline packed_float operator+(const packed_float& _a, const packed_float& _b)
+{
+	return _mm256_add_ps(_a.value, _b.value);
+}
+
+inline packed_float operator-(const packed_float& _a, const packed_float& _b)
+{
+	return _mm256_sub_ps(_a.value, _b.value);
+}
+
+inline packed_float operator*(const packed_float& _a, const packed_float& _b)
+{
+	return _mm256_mul_ps(_a.value, _b.value);
+}
+
+inline packed_float operator/(const packed_float& _a, const packed_float& _b)
+{
+	return _mm256_div_ps(_a.value, _b.value);
+}
+
+inline packed_float operator-(const packed_float& _value)
+{
+	return _mm256_xor_ps(_mm256_set1_ps(-0.0f), _value.value);
+}
+
+inline float_mask operator<(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm256_cmp_ps(_a.value, _b.value, _CMP_LT_OQ) };
+}
+
+inline float_mask operator<=(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm256_cmp_ps(_a.value, _b.value, _CMP_LE_OQ) };
+}
+
+inline float_mask operator>(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm256_cmp_ps(_a.value, _b.value, _CMP_GT_OQ) };
+}
+
+inline float_mask operator>=(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm256_cmp_ps(_a.value, _b.value, _CMP_GE_OQ) };
+}
+
+inline float_mask operator==(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm256_cmp_ps(_a.value, _b.value, _CMP_EQ_OQ) };
+}
+
+inline float_mask operator!=(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm256_cmp_ps(_a.value, _b.value, _CMP_NEQ_UQ) };
+}
+
+inline float_mask operator&(const float_mask& _a, const float_mask& _b)
+{
+	return { _mm256_and_ps(_a.value, _b.value) };
+}
+
+inline float_mask operator|(const float_mask& _a, const float_mask& _b)
+{
+	return { _mm256_or_ps(_a.value, _b.value) };
+}
+
+inline float_mask operator!(const float_mask& _mask)
+{
+	return { _mm256_xor_ps(_mask.value, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) };
+}
+
+inline bool any(const float_mask& _mask)
+{
+	return _mm256_movemask_ps(_mask.value) != 0;
+}
+
+inline bool all(const float_mask& _mask)
+{
+	return _mm256_movemask_ps(_mask.value) == 0xFF;
+}
+
+///< _maskが真の要素は_a、偽の要素は_bを選びます。
+inline packed_float select(const float_mask& _mask, const packed_float& _a, const packed_float& _b)
+{
+	return _mm256_blendv_ps(_b.value, _a.value, _mask.value);
+}
+
+inline packed_float min(const packed_float& _a, const packed_float& _b)
+{
+	return _mm256_min_ps(_a.value, _b.value);
+}
+
+inline packed_float max(const packed_float& _a, const packed_float& _b)
+{
+	return _mm256_max_ps(_a.value, _b.value);
+}
+
+inline packed_float abs(const packed_float& _value)
+{
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _value.value);
+}
+
+inline packed_float sqrt(const packed_float& _value)
+{
+	return _mm256_sqrt_ps(_value.value);
+}
+
+///< 1 / sqrt(_value)。近似命令の結果にニュートン法を1回適用し、相対誤差は3ulp程度です。
+inline packed_float rsqrt(const packed_float& _value)
+{
+	packed_float estimate = _mm256_rsqrt_ps(_value.value);
+	return estimate * (packed_float(1.5f) - packed_float(0.5f) * _value * estimate * estimate);
+}
+
+///< _a * _b + _c
+inline packed_float fmadd(const packed_float& _a, const packed_float& _b, const packed_float& _c)
+{
+#if defined(ARCH_SIMD_FMA)
+	return _mm256_fmadd_ps(_a.value, _b.value, _c.value);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(_a.value, _b.value), _c.value);
+#endif
+}
+
+///< _row(i)が返す4要素の行を転置し、_columns[c]のレーンiに_row(i)[c]を並べます。_rowはpackの幅の回数だけ呼ばれます。
+template<class function_type> inline void gather4(function_type _row, packed_float* _columns)
+{
+	// 128bitの上下に行0..3と4..7を読み、128bitごとに4x4を転置する
+	const __m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(_row(0))), _mm_loadu_ps(_row(4)), 1);
+	const __m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(_row(1))), _mm_loadu_ps(_row(5)), 1);
+	const __m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(_row(2))), _mm_loadu_ps(_row(6)), 1);
+	const __m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(_row(3))), _mm_loadu_ps(_row(7)), 1);
+	const __m256 xy01 = _mm256_unpacklo_ps(r0, r1);
+	const __m256 zw01 = _mm256_unpackhi_ps(r0, r1);
+	const __m256 xy23 = _mm256_unpacklo_ps(r2, r3);
+	const __m256 zw23 = _mm256_unpackhi_ps(r2, r3);
+	_columns[0] = _mm256_shuffle_ps(xy01, xy23, _MM_SHUFFLE(1, 0, 1, 0));
+	_columns[1] = _mm256_shuffle_ps(xy01, xy23, _MM_SHUFFLE(3, 2, 3, 2));
+	_columns[2] = _mm256_shuffle_ps(zw01, zw23, _MM_SHUFFLE(1, 0, 1, 0));
+	_columns[3] = _mm256_shuffle_ps(zw01, zw23, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+struct double_mask
+{
+	__m256d value;
+};
+
+struct packed_double
+{
+	typedef double value_type;
+	typedef double_mask mask_type;
+	static const size_t width = 4;
+
+	packed_double() = default;
+
+	packed_double(__m256d _value)
+		: value(_value)
+	{
+	}
+
+	explicit packed_double(value_type _value)
+		: value(_mm256_set1_pd(_value))
+	{
+	}
+
+	static packed_double load(const value_type* _data)
+	{
+		return _mm256_loadu_pd(_data);
+	}
+
+	void store(value_type* _data) const
+	{
+		_mm256_storeu_pd(_data, value);
+	}
+
+	__m256d value;
+};
+
+inline packed_double operator+(const packed_double& _a, const packed_double& _b)
+{
+	return _mm256_add_pd(_a.value, _b.value);
+}
+
+inline packed_double operator-(const packed_double& _a, const packed_double& _b)
+{
+	return _mm256_sub_pd(_a.value, _b.value);
+}
+
+inline packed_double operator*(const packed_double& _a, const packed_double& _b)
+{
+	return _mm256_mul_pd(_a.value, _b.value);
+}
+
+inline packed_double operator/(const packed_double& _a, const packed_double& _b)
+{
+	return _mm256_div_pd(_a.value, _b.value);
+}
+
+inline packed_double operator-(const packed_double& _value)
+{
+	return _mm256_xor_pd(_mm256_set1_pd(-0.0), _value.value);
+}
+
+inline double_mask operator<(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm256_cmp_pd(_a.value, _b.value, _CMP_LT_OQ) };
+}
+
+inline double_mask operator<=(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm256_cmp_pd(_a.value, _b.value, _CMP_LE_OQ) };
+}
+
+inline double_mask operator>(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm256_cmp_pd(_a.value, _b.value, _CMP_GT_OQ) };
+}
+
+inline double_mask operator>=(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm256_cmp_pd(_a.value, _b.value, _CMP_GE_OQ) };
+}
+
+inline double_mask operator==(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm256_cmp_pd(_a.value, _b.value, _CMP_EQ_OQ) };
+}
+
+inline double_mask operator!=(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm256_cmp_pd(_a.value, _b.value, _CMP_NEQ_UQ) };
+}
+
+inline double_mask operator&(const double_mask& _a, const double_mask& _b)
+{
+	return { _mm256_and_pd(_a.value, _b.value) };
+}
+
+inline double_mask operator|(const double_mask& _a, const double_mask& _b)
+{
+	return { _mm256_or_pd(_a.value, _b.value) };
+}
+
+inline double_mask operator!(const double_mask& _mask)
+{
+	return { _mm256_xor_pd(_mask.value, _mm256_castsi256_pd(_mm256_set1_epi32(-1))) };
+}
+
+inline bool any(const double_mask& _mask)
+{
+	return _mm256_movemask_pd(_mask.value) != 0;
+}
+
+inline bool all(const double_mask& _mask)
+{
+	return _mm256_movemask_pd(_mask.value) == 0xF;
+}
+
+///< _maskが真の要素は_a、偽の要素は_bを選びます。
+inline packed_double select(const double_mask& _mask, const packed_double& _a, const packed_double& _b)
+{
+	return _mm256_blendv_pd(_b.value, _a.value, _mask.value);
+}
+
+inline packed_double min(const packed_double& _a, const packed_double& _b)
+{
+	return _mm256_min_pd(_a.value, _b.value);
+}
+
+inline packed_double max(const packed_double& _a, const packed_double& _b)
+{
+	return _mm256_max_pd(_a.value, _b.value);
+}
+
+inline packed_double abs(const packed_double& _value)
+{
+	return _mm256_andnot_pd(_mm256_set1_pd(-0.0), _value.value);
+}
+
+inline packed_double sqrt(const packed_double& _value)
+{
+	return _mm256_sqrt_pd(_value.value);
+}
+
+///< 1 / sqrt(_value)。倍精度の近似命令がないため除算で求めます。
+inline packed_double rsqrt(const packed_double& _value)
+{
+	return packed_double(1.0) / sqrt(_value);
+}
+
+///< _a * _b + _c
+inline packed_double fmadd(const packed_double& _a, const packed_double& _b, const packed_double& _c)
+{
+#if defined(ARCH_SIMD_FMA)
+	return _mm256_fmadd_pd(_a.value, _b.value, _c.value);
+#else
+	return _mm256_add_pd(_mm256_mul_pd(_a.value, _b.value), _c.value);
+#endif
+}
+
+///< _row(i)が返す4要素の行を転置し、_columns[c]のレーンiに_row(i)[c]を並べます。_rowはpackの幅の回数だけ呼ばれます。
+template<class function_type> inline void gather4(function_type _row, packed_double* _columns)
+{
+	// 128bitの上下に行0, 2と行1, 3のxyとzwを分けて読み、unpackでレーンを揃える
+	const __m256d xy02 = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(_row(0))), _mm_loadu_pd(_row(2)), 1);
+	const __m256d xy13 = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(_row(1))), _mm_loadu_pd(_row(3)), 1);
+	const __m256d zw02 = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(_row(0) + 2)), _mm_loadu_pd(_row(2) + 2), 1);
+	const __m256d zw13 = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(_row(1) + 2)), _mm_loadu_pd(_row(3) + 2), 1);
+	_columns[0] = _mm256_unpacklo_pd(xy02, xy13);
+	_columns[1] = _mm256_unpackhi_pd(xy02, xy13);
+	_columns[2] = _mm256_unpacklo_pd(zw02, zw13);
+	_columns[3] = _mm256_unpackhi_pd(zw02, zw13);
+}
+
+#elif defined(ARCH_SIMD_SSE)
+
+struct float_mask
+{
+	__m128 value;
+};
+
+struct packed_float
+{
+	typedef float value_type;
+	typedef float_mask mask_type;
+	static const size_t width = 4;
+
+	packed_float() = default;
+
+	packed_float(__m128 _value)
+		: value(_value)
+	{
+	}
+
+	explicit packed_float(value_type _value)
+		: value(_mm_set1_ps(_value))
+	{
+	}
+
+	static packed_float load(const value_type* _data)
+	{
+		return _mm_loadu_ps(_data);
+	}
+
+	void store(value_type* _data) const
+	{
+		_mm_storeu_ps(_data, value);
+	}
+
+	__m128 value;
+};
+
+inline packed_float operator+(const packed_float& _a, const packed_float& _b)
+{
+	return _mm_add_ps(_a.value, _b.value);
+}
+
+inline packed_float operator-(const packed_float& _a, const packed_float& _b)
+{
+	return _mm_sub_ps(_a.value, _b.value);
+}
+
+inline packed_float operator*(const packed_float& _a, const packed_float& _b)
+{
+	return _mm_mul_ps(_a.value, _b.value);
+}
+
+inline packed_float operator/(const packed_float& _a, const packed_float& _b)
+{
+	return _mm_div_ps(_a.value, _b.value);
+}
+
+inline packed_float operator-(const packed_float& _value)
+{
+	return _mm_xor_ps(_mm_set1_ps(-0.0f), _value.value);
+}
+
+inline float_mask operator<(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm_cmplt_ps(_a.value, _b.value) };
+}
+
+inline float_mask operator<=(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm_cmple_ps(_a.value, _b.value) };
+}
+
+inline float_mask operator>(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm_cmpgt_ps(_a.value, _b.value) };
+}
+
+inline float_mask operator>=(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm_cmpge_ps(_a.value, _b.value) };
+}
+
+inline float_mask operator==(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm_cmpeq_ps(_a.value, _b.value) };
+}
+
+inline float_mask operator!=(const packed_float& _a, const packed_float& _b)
+{
+	return { _mm_cmpneq_ps(_a.value, _b.value) };
+}
+
+inline float_mask operator&(const float_mask& _a, const float_mask& _b)
+{
+	return { _mm_and_ps(_a.value, _b.value) };
+}
+
+inline float_mask operator|(const float_mask& _a, const float_mask& _b)
+{
+	return { _mm_or_ps(_a.value, _b.value) };
+}
+
+inline float_mask operator!(const float_mask& _mask)
+{
+	return { _mm_xor_ps(_mask.value, _mm_castsi128_ps(_mm_set1_epi32(-1))) };
+}
+
+inline bool any(const float_mask& _mask)
+{
+	return _mm_movemask_ps(_mask.value) != 0;
+}
+
+inline bool all(const float_mask& _mask)
+{
+	return _mm_movemask_ps(_mask.value) == 0xF;
+}
+
+///< _maskが真の要素は_a、偽の要素は_bを選びます。
+inline packed_float select(const float_mask& _mask, const packed_float& _a, const packed_float& _b)
+{
+	return _mm_or_ps(_mm_and_ps(_mask.value, _a.value), _mm_andnot_ps(_mask.value, _b.value));
+}
+
+inline packed_float min(const packed_float& _a, const packed_float& _b)
+{
+	return _mm_min_ps(_a.value, _b.value);
+}
+
+inline packed_float max(const packed_float& _a, const packed_float& _b)
+{
+	return _mm_max_ps(_a.value, _b.value);
+}
+
+inline packed_float abs(const packed_float& _value)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), _value.value);
+}
+
+inline packed_float sqrt(const packed_float& _value)
+{
+	return _mm_sqrt_ps(_value.value);
+}
+
+///< 1 / sqrt(_value)。近似命令の結果にニュートン法を1回適用し、相対誤差は3ulp程度です。
+inline packed_float rsqrt(const packed_float& _value)
+{
+	packed_float estimate = _mm_rsqrt_ps(_value.value);
+	return estimate * (packed_float(1.5f) - packed_float(0.5f) * _value * estimate * estimate);
+}
+
+///< _a * _b + _c
+inline packed_float fmadd(const packed_float& _a, const packed_float& _b, const packed_float& _c)
+{
+#if defined(ARCH_SIMD_FMA)
+	return _mm_fmadd_ps(_a.value, _b.value, _c.value);
+#else
+	return _mm_add_ps(_mm_mul_ps(_a.value, _b.value), _c.value);
+#endif
+}
+
+///< _row(i)が返す4要素の行を転置し、_columns[c]のレーンiに_row(i)[c]を並べます。_rowはpackの幅の回数だけ呼ばれます。
+template<class function_type> inline void gather4(function_type _row, packed_float* _columns)
+{
+	float4_type r0 = _mm_loadu_ps(_row(0)), r1 = _mm_loadu_ps(_row(1)), r2 = _mm_loadu_ps(_row(2)), r3 = _mm_loadu_ps(_row(3));
+	transpose(r0, r1, r2, r3);
+	_columns[0] = r0;
+	_columns[1] = r1;
+	_columns[2] = r2;
+	_columns[3] = r3;
+}
+
+struct double_mask
+{
+	__m128d value;
+};
+
+struct packed_double
+{
+	typedef double value_type;
+	typedef double_mask mask_type;
+	static const size_t width = 2;
+
+	packed_double() = default;
+
+	packed_double(__m128d _value)
+		: value(_value)
+	{
+	}
+
+	explicit packed_double(value_type _value)
+		: value(_mm_set1_pd(_value))
+	{
+	}
+
+	static packed_double load(const value_type* _data)
+	{
+		return _mm_loadu_pd(_data);
+	}
+
+	void store(value_type* _data) const
+	{
+		_mm_storeu_pd(_data, value);
+	}
+
+	__m128d value;
+};
+
+inline packed_double operator+(const packed_double& _a, const packed_double& _b)
+{
+	return _mm_add_pd(_a.value, _b.value);
+}
+
+inline packed_double operator-(const packed_double& _a, const packed_double& _b)
+{
+	return _mm_sub_pd(_a.value, _b.value);
+}
+
+inline packed_double operator*(const packed_double& _a, const packed_double& _b)
+{
+	return _mm_mul_pd(_a.value, _b.value);
+}
+
+inline packed_double operator/(const packed_double& _a, const packed_double& _b)
+{
+	return _mm_div_pd(_a.value, _b.value);
+}
+
+inline packed_double operator-(const packed_double& _value)
+{
+	return _mm_xor_pd(_mm_set1_pd(-0.0), _value.value);
+}
+
+inline double_mask operator<(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm_cmplt_pd(_a.value, _b.value) };
+}
+
+inline double_mask operator<=(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm_cmple_pd(_a.value, _b.value) };
+}
+
+inline double_mask operator>(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm_cmpgt_pd(_a.value, _b.value) };
+}
+
+inline double_mask operator>=(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm_cmpge_pd(_a.value, _b.value) };
+}
+
+inline double_mask operator==(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm_cmpeq_pd(_a.value, _b.value) };
+}
+
+inline double_mask operator!=(const packed_double& _a, const packed_double& _b)
+{
+	return { _mm_cmpneq_pd(_a.value, _b.value) };
+}
+
+inline double_mask operator&(const double_mask& _a, const double_mask& _b)
+{
+	return { _mm_and_pd(_a.value, _b.value) };
+}
+
+inline double_mask operator|(const double_mask& _a, const double_mask& _b)
+{
+	return { _mm_or_pd(_a.value, _b.value) };
+}
+
+inline double_mask operator!(const double_mask& _mask)
+{
+	return { _mm_xor_pd(_mask.value, _mm_castsi128_pd(_mm_set1_epi32(-1))) };
+}
+
+inline bool any(const double_mask& _mask)
+{
+	return _mm_movemask_pd(_mask.value) != 0;
+}
+
+inline bool all(const double_mask& _mask)
+{
+	return _mm_movemask_pd(_mask.value) == 0x3;
+}
+
+///< _maskが真の要素は_a、偽の要素は_bを選びます。
+inline packed_double select(const double_mask& _mask, const packed_double& _a, const packed_double& _b)
+{
+	return _mm_or_pd(_mm_and_pd(_mask.value, _a.value), _mm_andnot_pd(_mask.value, _b.value));
+}
+
+inline packed_double min(const packed_double& _a, const packed_double& _b)
+{
+	return _mm_min_pd(_a.value, _b.value);
+}
+
+inline packed_double max(const packed_double& _a, const packed_double& _b)
+{
+	return _mm_max_pd(_a.value, _b.value);
+}
+
+inline packed_double abs(const packed_double& _value)
+{
+	return _mm_andnot_pd(_mm_set1_pd(-0.0), _value.value);
+}
+
+inline packed_double sqrt(const packed_double& _value)
+{
+	return _mm_sqrt_pd(_value.value);
+}
+
+///< 1 / sqrt(_value)。倍精度の近似命令がないため除算で求めます。
+inline packed_double rsqrt(const packed_double& _value)
+{
+	return packed_double(1.0) / sqrt(_value);
+}
+
+///< _a * _b + _c
+inline packed_double fmadd(const packed_double& _a, const packed_double& _b, const packed_double& _c)
+{
+#if defined(ARCH_SIMD_FMA)
+	return _mm_fmadd_pd(_a.value, _b.value, _c.value);
+#else
+	return _mm_add_pd(_mm_mul_pd(_a.value, _b.value), _c.value);
+#endif
+}
+
+///< _row(i)が返す4要素の行を転置し、_columns[c]のレーンiに_row(i)[c]を並べます。_rowはpackの幅の回数だけ呼ばれます。
+template<class function_type> inline void gather4(function_type _row, packed_double* _columns)
+{
+	const __m128d xy0 = _mm_loadu_pd(_row(0)), xy1 = _mm_loadu_pd(_row(1));
+	const __m128d zw0 = _mm_loadu_pd(_row(0) + 2), zw1 = _mm_loadu_pd(_row(1) + 2);
+	_columns[0] = _mm_unpacklo_pd(xy0, xy1);
+	_columns[1] = _mm_unpackhi_pd(xy0, xy1);
+	_columns[2] = _mm_unpacklo_pd(zw0, zw1);
+	_columns[3] = _mm_unpackhi_pd(zw0, zw1);
+}
+
+#endif
+
+/*!
+*	@brief 1要素だけを保持するpackです。
+*	SIMD化されていない型と、pack幅に満たない端数の要素の処理に使います。
+*/
+template<class type> struct scalar
+{
+	typedef type value_type;
+	typedef bool mask_type;
+	static const size_t width = 1;
+
+	scalar() = default;
+
+	explicit scalar(value_type _value)
+		: value(_value)
+	{
+	}
+
+	static scalar load(const value_type* _data)
+	{
+		return scalar(*_data);
+	}
+
+	void store(value_type* _data) const
+	{
+		*_data = value;
+	}
+
+	value_type value;
+};
+
+template<class type> inline scalar<type> operator+(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return scalar<type>(_a.value + _b.value);
+}
+
+template<class type> inline scalar<type> operator-(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return scalar<type>(_a.value - _b.value);
+}
+
+template<class type> inline scalar<type> operator*(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return scalar<type>(_a.value * _b.value);
+}
+
+template<class type> inline scalar<type> operator/(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return scalar<type>(_a.value / _b.value);
+}
+
+template<class type> inline scalar<type> operator-(const scalar<type>& _value)
+{
+	return scalar<type>(-_value.value);
+}
+
+template<class type> inline bool operator<(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return _a.value < _b.value;
+}
+
+template<class type> inline bool operator<=(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return _a.value <= _b.value;
+}
+
+template<class type> inline bool operator>(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return _a.value > _b.value;
+}
+
+template<class type> inline bool operator>=(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return _a.value >= _b.value;
+}
+
+template<class type> inline bool operator==(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return _a.value == _b.value;
+}
+
+template<class type> inline bool operator!=(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return _a.value != _b.value;
+}
+
+inline bool any(bool _mask)
+{
+	return _mask;
+}
+
+inline bool all(bool _mask)
+{
+	return _mask;
+}
+
+template<class type> inline scalar<type> select(bool _mask, const scalar<type>& _a, const scalar<type>& _b)
+{
+	return _mask ? _a : _b;
+}
+
+template<class type> inline scalar<type> min(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return scalar<type>(_a.value < _b.value ? _a.value : _b.value);
+}
+
+template<class type> inline scalar<type> max(const scalar<type>& _a, const scalar<type>& _b)
+{
+	return scalar<type>(_a.value > _b.value ? _a.value : _b.value);
+}
+
+template<class type> inline scalar<type> abs(const scalar<type>& _value)
+{
+	return scalar<type>(std::abs(_value.value));
+}
+
+template<class type> inline scalar<type> sqrt(const scalar<type>& _value)
+{
+	return scalar<type>(std::sqrt(_value.value));
+}
+
+template<class type> inline scalar<type> rsqrt(const scalar<type>& _value)
+{
+	return scalar<type>(static_cast<type>(1.0) / std::sqrt(_value.value));
+}
+
+template<class type> inline scalar<type> fmadd(const scalar<type>& _a, const scalar<type>& _b, const scalar<type>& _c)
+{
+	return scalar<type>(_a.value * _b.value + _c.value);
+}
+
+template<class value_type> struct native_pack
+{
+	typedef scalar<value_type> type;
+};
+
+#if defined(ARCH_SIMD_SSE)
+
+template<> struct native_pack<float>
+{
+	typedef packed_float type;
+};
+
+template<> struct native_pack<double>
+{
+	typedef packed_double type;
+};
+
+#endif
+
+///< 選択された命令セットで最も幅の広いpack
+template<class value_type> using pack = typename native_pack<value_type>::type;
+
+/*!
+*	@brief [0, _size)をpack単位で走査し、端数の要素はscalarで処理します。
+*	_functionは(pack, index)を受け取るジェネリックラムダで、第1引数は型の指定にだけ使います。
+*/
+template<class value_type, class function_type> inline void for_each(size_t _size, function_type _function)
+{
+	const size_t width = pack<value_type>::width;
+	const size_t packed_size = _size - _size % width;
+	size_t i = 0;
+	for (; i < packed_size; i += width)
+	{
+		_function(pack<value_type>(), i);
+	}
+	for (; i < _size; i++)
+	{
+		_function(scalar<value_type>(), i);
+	}
+}
+
+}
+
+}
@@ -0,0 +1,319 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <cassert>
+#include <vector>
+#include "aligned_allocator.h"
+#include "matrix4x4.h"
+#include "parallel.h"
+#include "simd.h"
+#include "soa_vector.h"
+#include "vector.h"
+
+namespace arch
+{
+
+/*!
+*	@brief 線形混合スキニング(LBS)に使うボーン行列の一覧を保持します。
+*	各ボーンはmatrix4x4の上3行(3x4、列ベクトルに左から掛ける)だけを行ごとに4要素ずつ詰めて64バイト境界の領域に置くため、
+*	1行を1回で読み込めて、256ボーンでもfloatなら12KBで1次キャッシュに収まります。
+*	4行目は(0, 0, 0, 1)とみなします。
+*/
+template <typename type>
+class bone_palette
+{
+public:
+	typedef type value_type;
+	typedef size_t size_type;
+	typedef type* pointer;
+	typedef const type* const_pointer;
+
+public:
+	bone_palette() = default;
+	~bone_palette() = default;
+
+	///	<summary>_size個の単位行列で初期化します。</summary>
+	explicit bone_palette(size_type _size)
+	{
+		resize(_size);
+	}
+
+	bone_palette(const matrix4x4<value_type>* _matrices, size_type _size)
+	{
+		assign(_matrices, _size);
+	}
+
+	explicit bone_palette(const std::vector<matrix4x4<value_type>>& _matrices)
+	{
+		assign(_matrices.data(), _matrices.size());
+	}
+
+	///	<summary>_matricesの上3行を読み込みます。毎フレームのボーン行列の更新に使います。</summary>
+	void assign(const matrix4x4<value_type>* _matrices, size_type _size)
+	{
+		m_bones.resize(_size * bone_stride);
+		for (size_type i = 0; i < _size; i++)
+		{
+			set(i, _matrices[i]);
+		}
+	}
+
+	///	<summary>要素数を変更します。増えたボーンは単位行列になります。</summary>
+	void resize(size_type _size)
+	{
+		const size_type old_size = size();
+		m_bones.resize(_size * bone_stride);
+		for (size_type i = old_size; i < _size; i++)
+		{
+			set(i, matrix4x4<value_type>::identity());
+		}
+	}
+
+	size_type size() const
+	{
+		return m_bones.size() / bone_stride;
+	}
+
+	void set(size_type _index, const matrix4x4<value_type>& _matrix)
+	{
+		pointer bone = m_bones.data() + _index * bone_stride;
+		for (size_type y = 0; y < 3; y++)
+		{
+			for (size_type x = 0; x < 4; x++)
+			{
+				bone[y * 4 + x] = _matrix.data[y][x];
+			}
+		}
+	}
+
+	///	<summary>_index番目のボーンを4行目を(0, 0, 0, 1)とした4x4行列で返します。</summary>
+	matrix4x4<value_type> get(size_type _index) const
+	{
+		return to_matrix4x4(m_bones.data() + _index * bone_stride);
+	}
+
+	///	<summary>ボーンごとに12要素(3行 x 4列)を並べた領域を返します。</summary>
+	const_pointer data() const
+	{
+		return m_bones.data();
+	}
+
+	/*!
+	*	@brief 最大4つのボーン行列を_weights[k]で重み付けして足し合わせます。
+	*	使わない影響は重みを0にしてください。重みの和は1でなくても構いません。
+	*/
+	matrix4x4<value_type> blend(const vector4<ushort>& _indices, const vector4<value_type>& _weights) const
+	{
+		value_type result[bone_stride];
+		blend(_indices, _weights, result);
+		return to_matrix4x4(result);
+	}
+
+	/*!
+	*	@brief 頂点ごとにblendした行列で、成分ごとの配列の位置と法線をスキニングします。
+	*	4頂点ずつ各ボーンの行を4要素のレジスタで重み付けして積和し、転置して頂点方向に並べた行列で4頂点をまとめて変換します。
+	*	法線は混合した行列の左上3x3をそのまま掛け、正規化はしません(一様でない拡大縮小を含む場合は逆転置行列のパレットを別に用意してください)。
+	*	結果はblendとtransform_point/transform_directionで1頂点ずつ求めた場合と丸め誤差の範囲で一致します。
+	*	_normalsは_positionsと同じ要素数が必要です。_indicesと_weightsは頂点数の要素が必要です。_skinned_positionsと_skinned_normalsは頂点数にリサイズされます。
+	*	ARCH_PARALLEL_THRESHOLD以上の頂点はスレッドに分割します。
+	*/
+	void skin(const vector4<ushort>* _indices, const vector4<value_type>* _weights,
+		const soa_vector3<value_type>& _positions, const soa_vector3<value_type>& _normals,
+		soa_vector3<value_type>& _skinned_positions, soa_vector3<value_type>& _skinned_normals) const
+	{
+		assert(_normals.size() == _positions.size());
+		_skinned_positions.resize(_positions.size());
+		_skinned_normals.resize(_positions.size());
+		const value_type* input[6] = { _positions.x(), _positions.y(), _positions.z(), _normals.x(), _normals.y(), _normals.z() };
+		value_type* output[6] = { _skinned_positions.x(), _skinned_positions.y(), _skinned_positions.z(), _skinned_normals.x(), _skinned_normals.y(), _skinned_normals.z() };
+		skin(_indices, _weights, input, output, _positions.size());
+	}
+
+	///	<summary>法線を持たない頂点の位置だけをスキニングします。</summary>
+	void skin(const vector4<ushort>* _indices, const vector4<value_type>* _weights,
+		const soa_vector3<value_type>& _positions, soa_vector3<value_type>& _skinned_positions) const
+	{
+		_skinned_positions.resize(_positions.size());
+		const value_type* input[6] = { _positions.x(), _positions.y(), _positions.z(), nullptr, nullptr, nullptr };
+		value_type* output[6] = { _skinned_positions.x(), _skinned_positions.y(), _skinned_positions.z(), nullptr, nullptr, nullptr };
+		skin(_indices, _weights, input, output, _positions.size());
+	}
+
+private:
+	///< 1つのボーンの要素数(3行 x 4列)
+	static const size_type bone_stride = 12;
+	///< スレッドに分割した範囲をさらに区切る頂点の数
+	static const size_type batch_size = 64;
+
+	static matrix4x4<value_type> to_matrix4x4(const value_type* _bone)
+	{
+		const value_type zero = static_cast<value_type>(0.0);
+		return matrix4x4<value_type>
+			(
+				_bone[0], _bone[1], _bone[2], _bone[3],
+				_bone[4], _bone[5], _bone[6], _bone[7],
+				_bone[8], _bone[9], _bone[10], _bone[11],
+				zero, zero, zero, static_cast<value_type>(1.0)
+				);
+	}
+
+	void blend(const vector4<ushort>& _indices, const vector4<value_type>& _weights, value_type (&_result)[bone_stride]) const
+	{
+		const value_type* first = m_bones.data() + _indices.x * bone_stride;
+		for (size_type e = 0; e < bone_stride; e++)
+		{
+			_result[e] = _weights.x * first[e];
+		}
+		for (size_type k = 1; k < 4; k++)
+		{
+			const value_type* bone = m_bones.data() + _indices.data[k] * bone_stride;
+			for (size_type e = 0; e < bone_stride; e++)
+			{
+				_result[e] += _weights.data[k] * bone[e];
+			}
+		}
+	}
+
+	///	<summary>_input/_outputは位置xyzと法線xyzのストリームで、法線はnullptrでも構いません。</summary>
+	void skin(const vector4<ushort>* _indices, const vector4<value_type>* _weights, const value_type* const (&_input)[6], value_type* const (&_output)[6], size_type _count) const
+	{
+		parallel_for(_count, ARCH_PARALLEL_THRESHOLD, [&](size_type _begin, size_type _end)
+		{
+			for (size_type i = _begin; i < _end; i += batch_size)
+			{
+				skin_block(_indices, _weights, _input, _output, i, min(batch_size, _end - i), simd::packed4<value_type>());
+			}
+		});
+	}
+
+#if defined(ARCH_SIMD_SSE)
+	///	<summary>batch_size個以下の頂点を4頂点ずつスキニングします。</summary>
+	void skin_block(const vector4<ushort>* _indices, const vector4<value_type>* _weights, const value_type* const (&_input)[6], value_type* const (&_output)[6], size_type _offset, size_type _count, std::true_type) const
+	{
+		typedef typename simd::packed4<value_type>::type packed;
+		const bool normals = _input[3] != nullptr;
+		const size_type streams = normals ? 6 : 3;
+		for (size_type j = 0; j < _count; j += 4)
+		{
+			packed matrix[3][4];
+			for (size_type v = 0; v < 4; v++)
+			{
+				if (j + v >= _count)
+				{
+					for (size_type r = 0; r < 3; r++)
+					{
+						matrix[r][v] = simd::set4(static_cast<value_type>(0.0));
+					}
+					continue;
+				}
+
+				const vector4<ushort>& index = _indices[_offset + j + v];
+				const vector4<value_type>& weight = _weights[_offset + j + v];
+				const value_type* first = m_bones.data() + index.x * bone_stride;
+				const packed w = simd::set4(weight.x);
+				for (size_type r = 0; r < 3; r++)
+				{
+					matrix[r][v] = simd::mul(w, simd::load4(first + r * 4));
+				}
+				for (size_type k = 1; k < 4; k++)
+				{
+					const value_type* bone = m_bones.data() + index.data[k] * bone_stride;
+					const packed w = simd::set4(weight.data[k]);
+					for (size_type r = 0; r < 3; r++)
+					{
+						matrix[r][v] = simd::fmadd(w, simd::load4(bone + r * 4), matrix[r][v]);
+					}
+				}
+			}
+			for (size_type r = 0; r < 3; r++)
+			{
+				simd::transpose(matrix[r][0], matrix[r][1], matrix[r][2], matrix[r][3]);
+			}
+
+			if (j + 4 <= _count)
+			{
+				transform(matrix, _input, _output, _offset + j, normals);
+				continue;
+			}
+
+			// 端数の頂点はストリームの外を読み書きしないように一時領域を経由する
+			value_type input[6][4], output[6][4];
+			const value_type* input_streams[6] = {};
+			value_type* output_streams[6] = {};
+			for (size_type s = 0; s < streams; s++)
+			{
+				for (size_type v = 0; v < 4; v++)
+				{
+					input[s][v] = j + v < _count ? _input[s][_offset + j + v] : static_cast<value_type>(0.0);
+				}
+				input_streams[s] = input[s];
+				output_streams[s] = output[s];
+			}
+			transform(matrix, input_streams, output_streams, 0, normals);
+			for (size_type s = 0; s < streams; s++)
+			{
+				for (size_type v = 0; j + v < _count; v++)
+				{
+					_output[s][_offset + j + v] = output[s][v];
+				}
+			}
+		}
+	}
+
+	///	<summary>頂点方向に並べた行列_matrixで、ストリームの_index番目から4頂点の位置と法線を変換します。</summary>
+	template<class packed> static void transform(const packed (&_matrix)[3][4], const value_type* const (&_input)[6], value_type* const (&_output)[6], size_type _index, bool _normals)
+	{
+		const packed x = simd::load4(_input[0] + _index), y = simd::load4(_input[1] + _index), z = simd::load4(_input[2] + _index);
+		for (size_type r = 0; r < 3; r++)
+		{
+			simd::store4(_output[r] + _index, simd::fmadd(_matrix[r][0], x, simd::fmadd(_matrix[r][1], y, simd::fmadd(_matrix[r][2], z, _matrix[r][3]))));
+		}
+		if (_normals)
+		{
+			const packed nx = simd::load4(_input[3] + _index), ny = simd::load4(_input[4] + _index), nz = simd::load4(_input[5] + _index);
+			for (size_type r = 0; r < 3; r++)
+			{
+				simd::store4(_output[r + 3] + _index, simd::fmadd(_matrix[r][0], nx, simd::fmadd(_matrix[r][1], ny, simd::mul(_matrix[r][2], nz))));
+			}
+		}
+	}
+#endif
+
+	void skin_block(const vector4<ushort>* _indices, const vector4<value_type>* _weights, const value_type* const (&_input)[6], value_type* const (&_output)[6], size_type _offset, size_type _count, std::false_type) const
+	{
+		for (size_type j = _offset; j < _offset + _count; j++)
+		{
+			value_type matrix[bone_stride];
+			blend(_indices[j], _weights[j], matrix);
+			const value_type x = _input[0][j], y = _input[1][j], z = _input[2][j];
+			for (size_type r = 0; r < 3; r++)
+			{
+				_output[r][j] = matrix[r * 4] * x + matrix[r * 4 + 1] * y + matrix[r * 4 + 2] * z + matrix[r * 4 + 3];
+			}
+			if (_input[3] != nullptr)
+			{
+				const value_type nx = _input[3][j], ny = _input[4][j], nz = _input[5][j];
+				for (size_type r = 0; r < 3; r++)
+				{
+					_output[r + 3][j] = matrix[r * 4] * nx + matrix[r * 4 + 1] * ny + matrix[r * 4 + 2] * nz;
+				}
+			}
+		}
+	}
+
+private:
+	std::vector<value_type, aligned_allocator<value_type>> m_bones;
+};
+
+}
@@ -0,0 +1,528 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <vector>
+#include "aligned_allocator.h"
+#include "simd.h"
+#include "vector.h"
+
+namespace arch
+{
+
+template <typename type, size_t dimension_size> class soa_vector;
+
+template <typename type> using soa_vector2 = soa_vector<type, 2>;
+template <typename type> using soa_vector3 = soa_vector<type, 3>;
+template <typename type> using soa_vector4 = soa_vector<type, 4>;
+
+typedef soa_vector2<float>	soa_float2;
+typedef soa_vector2<double>	soa_double2;
+typedef soa_vector3<float>	soa_float3;
+typedef soa_vector3<double>	soa_double3;
+typedef soa_vector4<float>	soa_float4;
+typedef soa_vector4<double>	soa_double4;
+
+template <typename type, size_t dimension_size> struct soa_element;
+
+template <typename type> struct soa_element<type, 2>
+{
+	typedef vector2<type> element_type;
+};
+
+template <typename type> struct soa_element<type, 3>
+{
+	typedef vector3<type> element_type;
+};
+
+template <typename type> struct soa_element<type, 4>
+{
+	typedef vector4<type> element_type;
+};
+
+/*!
+*	@brief ベクトルの配列を成分ごとの配列(Structure of Arrays)で保持します。
+*	各成分は64バイト境界に揃えた別々の領域に置かれ、一括演算はpack幅単位で処理されます。
+*	二項演算の引数は同じ要素数でなければなりません。デバッグビルドではassertで確認します。
+*/
+template <typename type, size_t dimension_size>
+class soa_vector
+{
+public:
+	typedef type value_type;
+	typedef size_t size_type;
+	typedef type* pointer;
+	typedef const type* const_pointer;
+	typedef type& reference;
+	typedef const type& const_reference;
+	typedef typename soa_element<type, dimension_size>::element_type element_type;
+	typedef std::vector<value_type, aligned_allocator<value_type>> stream_type;
+
+public:
+	soa_vector() = default;
+	~soa_vector() = default;
+
+	explicit soa_vector(size_type _size)
+	{
+		resize(_size);
+	}
+
+	soa_vector(const element_type* _data, size_type _size)
+	{
+		assign(_data, _size);
+	}
+
+	explicit soa_vector(const std::vector<element_type>& _data)
+	{
+		assign(_data.data(), _data.size());
+	}
+
+	///	<summary>AoSの配列から読み込みます。</summary>
+	void assign(const element_type* _data, size_type _size)
+	{
+		resize(_size);
+		for (size_type c = 0; c < dimension_size; c++)
+		{
+			pointer stream = m_streams[c].data();
+			for (size_type i = 0; i < _size; i++)
+			{
+				stream[i] = _data[i].data[c];
+			}
+		}
+	}
+
+	///	<summary>AoSの配列へ書き出します。_dataにはsize()個の領域が必要です。</summary>
+	void copy_to(element_type* _data) const
+	{
+		for (size_type c = 0; c < dimension_size; c++)
+		{
+			const_pointer stream = m_streams[c].data();
+			for (size_type i = 0; i < size(); i++)
+			{
+				_data[i].data[c] = stream[i];
+			}
+		}
+	}
+
+	std::vector<element_type> to_vector() const
+	{
+		std::vector<element_type> result(size());
+		copy_to(result.data());
+		return result;
+	}
+
+	size_type size() const
+	{
+		return m_streams[0].size();
+	}
+
+	bool empty() const
+	{
+		return m_streams[0].empty();
+	}
+
+	void resize(size_type _size)
+	{
+		for (auto& stream : m_streams)
+		{
+			stream.resize(_size);
+		}
+	}
+
+	void clear()
+	{
+		for (auto& stream : m_streams)
+		{
+			stream.clear();
+		}
+	}
+
+	///	<summary>成分の数を取得します。</summary>
+	constexpr size_type dimension() const
+	{
+		return dimension_size;
+	}
+
+	pointer stream(size_type _component)
+	{
+		return m_streams[_component].data();
+	}
+
+	const_pointer stream(size_type _component) const
+	{
+		return m_streams[_component].data();
+	}
+
+	pointer x()
+	{
+		return stream(0);
+	}
+
+	const_pointer x() const
+	{
+		return stream(0);
+	}
+
+	pointer y()
+	{
+		return stream(1);
+	}
+
+	const_pointer y() const
+	{
+		return stream(1);
+	}
+
+	pointer z()
+	{
+		static_assert(dimension_size >= 3, "This vector does not have z component.");
+		return stream(2);
+	}
+
+	const_pointer z() const
+	{
+		static_assert(dimension_size >= 3, "This vector does not have z component.");
+		return stream(2);
+	}
+
+	pointer w()
+	{
+		static_assert(dimension_size >= 4, "This vector does not have w component.");
+		return stream(3);
+	}
+
+	const_pointer w() const
+	{
+		static_assert(dimension_size >= 4, "This vector does not have w component.");
+		return stream(3);
+	}
+
+	element_type get(size_type _index) const
+	{
+		element_type result;
+		for (size_type c = 0; c < dimension_size; c++)
+		{
+			result.data[c] = m_streams[c][_index];
+		}
+		return result;
+	}
+
+	void set(size_type _index, const element_type& _vector)
+	{
+		for (size_type c = 0; c < dimension_size; c++)
+		{
+			m_streams[c][_index] = _vector.data[c];
+		}
+	}
+
+	soa_vector& absolute()
+	{
+		auto v = pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			typedef decltype(_pack) pack;
+			for (size_type c = 0; c < dimension_size; c++)
+			{
+				simd::abs(pack::load(v[c] + i)).store(v[c] + i);
+			}
+		});
+		return *this;
+	}
+
+	soa_vector& saturate()
+	{
+		auto v = pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			typedef decltype(_pack) pack;
+			const pack zero(static_cast<value_type>(0.0));
+			const pack one(static_cast<value_type>(1.0));
+			for (size_type c = 0; c < dimension_size; c++)
+			{
+				simd::min(simd::max(pack::load(v[c] + i), zero), one).store(v[c] + i);
+			}
+		});
+		return *this;
+	}
+
+	///	<summary>長さが0の要素は零ベクトルになります。</summary>
+	soa_vector& normalize()
+	{
+		auto v = pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			typedef decltype(_pack) pack;
+			const pack zero(static_cast<value_type>(0.0));
+			pack squared = squared_length(_pack, v, i);
+			pack scale = simd::rsqrt(squared);
+			auto mask = squared > zero;
+			for (size_type c = 0; c < dimension_size; c++)
+			{
+				simd::select(mask, pack::load(v[c] + i) * scale, zero).store(v[c] + i);
+			}
+		});
+		return *this;
+	}
+
+	void squared_length(pointer _result) const
+	{
+		auto v = pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			squared_length(_pack, v, i).store(_result + i);
+		});
+	}
+
+	void length(pointer _result) const
+	{
+		auto v = pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			simd::sqrt(squared_length(_pack, v, i)).store(_result + i);
+		});
+	}
+
+	void dot(const soa_vector& _vector, pointer _result) const
+	{
+		assert(_vector.size() == size());
+		auto a = pointers();
+		auto b = _vector.pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			typedef decltype(_pack) pack;
+			pack sum = pack::load(a[0] + i) * pack::load(b[0] + i);
+			for (size_type c = 1; c < dimension_size; c++)
+			{
+				sum = simd::fmadd(pack::load(a[c] + i), pack::load(b[c] + i), sum);
+			}
+			sum.store(_result + i);
+		});
+	}
+
+	void squared_distance(const soa_vector& _end, pointer _result) const
+	{
+		assert(_end.size() == size());
+		auto a = pointers();
+		auto b = _end.pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			squared_distance(_pack, a, b, i).store(_result + i);
+		});
+	}
+
+	void distance(const soa_vector& _end, pointer _result) const
+	{
+		assert(_end.size() == size());
+		auto a = pointers();
+		auto b = _end.pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			simd::sqrt(squared_distance(_pack, a, b, i)).store(_result + i);
+		});
+	}
+
+	///	<summary>2次元の外積(z成分)を_resultへ書き出します。</summary>
+	void cross(const soa_vector& _vector, pointer _result) const
+	{
+		static_assert(dimension_size == 2, "This cross product requires 2 dimensional vectors.");
+		assert(_vector.size() == size());
+		auto a = pointers();
+		auto b = _vector.pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			typedef decltype(_pack) pack;
+			(pack::load(a[0] + i) * pack::load(b[1] + i) - pack::load(a[1] + i) * pack::load(b[0] + i)).store(_result + i);
+		});
+	}
+
+	soa_vector cross(const soa_vector& _vector) const
+	{
+		soa_vector result;
+		cross(_vector, result);
+		return result;
+	}
+
+	///	<summary>3次元の外積を_resultへ書き出します。_resultは*thisと同じでも構いません。</summary>
+	void cross(const soa_vector& _vector, soa_vector& _result) const
+	{
+		static_assert(dimension_size == 3, "This cross product requires 3 dimensional vectors.");
+		assert(_vector.size() == size());
+		_result.resize(size());
+		auto a = pointers();
+		auto b = _vector.pointers();
+		auto r = _result.pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			typedef decltype(_pack) pack;
+			pack ax = pack::load(a[0] + i), ay = pack::load(a[1] + i), az = pack::load(a[2] + i);
+			pack bx = pack::load(b[0] + i), by = pack::load(b[1] + i), bz = pack::load(b[2] + i);
+			(ay * bz - az * by).store(r[0] + i);
+			(az * bx - ax * bz).store(r[1] + i);
+			(ax * by - ay * bx).store(r[2] + i);
+		});
+	}
+
+public:
+	soa_vector operator+(const soa_vector& _vector) const
+	{
+		return soa_vector(*this) += _vector;
+	}
+
+	soa_vector& operator+=(const soa_vector& _vector)
+	{
+		return apply(_vector, [](auto _a, auto _b) { return _a + _b; });
+	}
+
+	soa_vector operator-(const soa_vector& _vector) const
+	{
+		return soa_vector(*this) -= _vector;
+	}
+
+	soa_vector& operator-=(const soa_vector& _vector)
+	{
+		return apply(_vector, [](auto _a, auto _b) { return _a - _b; });
+	}
+
+	soa_vector operator*(const soa_vector& _vector) const
+	{
+		return soa_vector(*this) *= _vector;
+	}
+
+	soa_vector operator*(value_type _value) const
+	{
+		return soa_vector(*this) *= _value;
+	}
+
+	soa_vector& operator*=(const soa_vector& _vector)
+	{
+		return apply(_vector, [](auto _a, auto _b) { return _a * _b; });
+	}
+
+	soa_vector& operator*=(value_type _value)
+	{
+		return apply(_value, [](auto _a, auto _b) { return _a * _b; });
+	}
+
+	soa_vector operator/(const soa_vector& _vector) const
+	{
+		return soa_vector(*this) /= _vector;
+	}
+
+	soa_vector operator/(value_type _value) const
+	{
+		return soa_vector(*this) /= _value;
+	}
+
+	soa_vector& operator/=(const soa_vector& _vector)
+	{
+		return apply(_vector, [](auto _a, auto _b) { return _a / _b; });
+	}
+
+	soa_vector& operator/=(value_type _value)
+	{
+		return apply(_value, [](auto _a, auto _b) { return _a / _b; });
+	}
+
+	element_type operator[](size_type _index) const
+	{
+		return get(_index);
+	}
+
+private:
+	std::array<pointer, dimension_size> pointers()
+	{
+		std::array<pointer, dimension_size> result;
+		for (size_type c = 0; c < dimension_size; c++)
+		{
+			result[c] = m_streams[c].data();
+		}
+		return result;
+	}
+
+	std::array<const_pointer, dimension_size> pointers() const
+	{
+		std::array<const_pointer, dimension_size> result;
+		for (size_type c = 0; c < dimension_size; c++)
+		{
+			result[c] = m_streams[c].data();
+		}
+		return result;
+	}
+
+	template<class pack, class pointer_array> static pack squared_length(pack, const pointer_array& _v, size_type _index)
+	{
+		pack value = pack::load(_v[0] + _index);
+		pack sum = value * value;
+		for (size_type c = 1; c < dimension_size; c++)
+		{
+			value = pack::load(_v[c] + _index);
+			sum = simd::fmadd(value, value, sum);
+		}
+		return sum;
+	}
+
+	template<class pack> static pack squared_distance(pack, const std::array<const_pointer, dimension_size>& _a, const std::array<const_pointer, dimension_size>& _b, size_type _index)
+	{
+		pack d = pack::load(_b[0] + _index) - pack::load(_a[0] + _index);
+		pack sum = d * d;
+		for (size_type c = 1; c < dimension_size; c++)
+		{
+			d = pack::load(_b[c] + _index) - pack::load(_a[c] + _index);
+			sum = simd::fmadd(d, d, sum);
+		}
+		return sum;
+	}
+
+	template<class function_type> soa_vector& apply(const soa_vector& _vector, function_type _function)
+	{
+		assert(_vector.size() == size());
+		auto a = pointers();
+		auto b = _vector.pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			typedef decltype(_pack) pack;
+			for (size_type c = 0; c < dimension_size; c++)
+			{
+				_function(pack::load(a[c] + i), pack::load(b[c] + i)).store(a[c] + i);
+			}
+		});
+		return *this;
+	}
+
+	template<class function_type> soa_vector& apply(value_type _value, function_type _function)
+	{
+		auto a = pointers();
+		simd::for_each<value_type>(size(), [&](auto _pack, size_type i)
+		{
+			typedef decltype(_pack) pack;
+			const pack value(_value);
+			for (size_type c = 0; c < dimension_size; c++)
+			{
+				_function(pack::load(a[c] + i), value).store(a[c] + i);
+			}
+		});
+		return *this;
+	}
+
+private:
+	std::array<stream_type, dimension_size> m_streams;
+};
+
+template<typename value_type, size_t dimension_size> inline soa_vector<value_type, dimension_size> operator *(const value_type& _value, const soa_vector<value_type, dimension_size>& _vector)
+{
+	return _vector * _value;
+}
+
+}
@@ -0,0 +1,280 @@
+﻿//=================================================================================//
+//                                                                                 //
+//  ArchMath                                                                       //
+//                                                                                 //
+//  Copyright (C) 2011-2017 Terry                                                  //
+//                                                                                 //
+//  This file is a portion of the ArchMath. It is distributed under the MIT	       //
+//  License, available in the root of this distribution and at the following URL.  //
+//  http://opensource.org/licenses/mit-license.php                                 //
+//                                                                                 //
+//=================================================================================//
+
+#pragma once
+
+#include <cmath>
+#include "simd.h"
+#include "vector.h"
+
+namespace arch
+{
+
+namespace simd
+{
+
+/*!
+*	@brief sincosの範囲縮小と多項式の係数です。
+*	π/2をfloatは4つ、doubleは3つに分けたCody-Waite法で[-π/4, π/4]へ縮小し、sin/cosをそれぞれminimax多項式で近似します。
+*/
+template<class value_type, class dummy = void> struct sincos_coefficients;
+
+template<class dummy> struct sincos_coefficients<float, dummy>
+{
+	static constexpr float two_over_pi = 0.636619772367581343f;
+	static constexpr float pi_over_2[4] = { 1.5703125f, 4.8351287841796875e-4f, 3.1385570764541625977e-7f, 6.0771006282767103812e-11f };
+	static constexpr float sin[3] = { -1.9515295891e-4f, 8.3321608736e-3f, -1.6666654611e-1f };
+	static constexpr float cos[3] = { 2.443315711809948e-5f, -1.388731625493765e-3f, 4.166664568298827e-2f };
+	///< 加えて引くと整数に丸められる値(1.5 * 2^23)
+	static constexpr float rounder = 12582912.0f;
+	///< 多項式で求める引数の絶対値の上限。超えた要素は標準ライブラリで求めます。
+	static constexpr float limit = 8192.0f;
+};
+
+template<class dummy> struct sincos_coefficients<double, dummy>
+{
+	static constexpr double two_over_pi = 0.636619772367581343075535053490057448;
+	static constexpr double pi_over_2[3] = { 1.57079625129699707031e+0, 7.54978941586159635335e-8, 5.39030285815811905290e-15 };
+	static constexpr double sin[6] = { 1.58962301576546568060e-10, -2.50507477628578072866e-8, 2.75573136213857245213e-6, -1.98412698295895385996e-4, 8.33333333332211858878e-3, -1.66666666666666307295e-1 };
+	static constexpr double cos[6] = { -1.13585365213876817300e-11, 2.08757008419747316778e-9, -2.75573141792967388112e-7, 2.48015872888517045348e-5, -1.38888888888730564116e-3, 4.16666666666665929218e-2 };
+	///< 加えて引くと整数に丸められる値(1.5 * 2^52)
+	static constexpr double rounder = 6755399441055744.0;
+	///< 多項式で求める引数の絶対値の上限。超えた要素は標準ライブラリで求めます。
+	static constexpr double limit = 1073741824.0;
+};
+
+template<class dummy> constexpr float sincos_coefficients<float, dummy>::pi_over_2[4];
+template<class dummy> constexpr float sincos_coefficients<float, dummy>::sin[3];
+template<class dummy> constexpr float sincos_coefficients<float, dummy>::cos[3];
+template<class dummy> constexpr double sincos_coefficients<double, dummy>::pi_over_2[3];
+template<class dummy> constexpr double sincos_coefficients<double, dummy>::sin[6];
+template<class dummy> constexpr double sincos_coefficients<double, dummy>::cos[6];
+
+template<class pack_type, size_t size> inline pack_type polynomial(const pack_type& _x, const typename pack_type::value_type (&_coefficients)[size])
+{
+	pack_type result(_coefficients[0]);
+	for (size_t i = 1; i < size; i++)
+	{
+		result = fmadd(result, _x, pack_type(_coefficients[i]));
+	}
+	return result;
+}
+
+/*!
+*	@brief packの各要素のsinとcosを同時に求めます。
+*	最大誤差はfloatで2.5ulp、doubleで1.7ulpです(|_angle| <= limitの範囲でlong doubleのsinl/coslと比較)。
+*	limitを超える要素はstd::sin/std::cosで求め、無限大とNaNはNaNになります。
+*/
+template<class pack_type> inline void sincos(const pack_type& _angle, pack_type& _sin, pack_type& _cos)
+{
+	typedef typename pack_type::value_type value_type;
+	typedef sincos_coefficients<value_type> coefficients;
+
+	const pack_type rounder(coefficients::rounder);
+	const pack_type quadrant = (_angle * pack_type(coefficients::two_over_pi) + rounder) - rounder;
+	pack_type x = _angle;
+	for (value_type part : coefficients::pi_over_2)
+	{
+		x = fmadd(quadrant, pack_type(-part), x);
+	}
+
+	const pack_type z = x * x;
+	const pack_type sin = fmadd(x * z, polynomial(z, coefficients::sin), x);
+	const pack_type cos = fmadd(z * z, polynomial(z, coefficients::cos), fmadd(pack_type(static_cast<value_type>(-0.5)), z, pack_type(static_cast<value_type>(1.0))));
+
+	// quadrantを4で割った余り(0～3)で象限ごとに入れ替えと符号を決める
+	const pack_type quarter = (fmadd(quadrant, pack_type(static_cast<value_type>(0.25)), pack_type(static_cast<value_type>(-0.375))) + rounder) - rounder;
+	const pack_type remainder = fmadd(quarter, pack_type(static_cast<value_type>(-4.0)), quadrant);
+	const auto first = remainder == pack_type(static_cast<value_type>(1.0));
+	const auto second = remainder == pack_type(static_cast<value_type>(2.0));
+	const auto third = remainder == pack_type(static_cast<value_type>(3.0));
+	const auto swap = first | third;
+	_sin = select(swap, cos, sin);
+	_cos = select(swap, sin, cos);
+	_sin = select(second | third, -_sin, _sin);
+	_cos = select(first | second, -_cos, _cos);
+
+	if (any(abs(_angle) > pack_type(coefficients::limit)))
+	{
+		value_type angles[pack_type::width], sins[pack_type::width], coss[pack_type::width];
+		_angle.store(angles);
+		_sin.store(sins);
+		_cos.store(coss);
+		for (size_t i = 0; i < pack_type::width; i++)
+		{
+			if (std::abs(angles[i]) > coefficients::limit)
+			{
+				sins[i] = std::sin(angles[i]);
+				coss[i] = std::cos(angles[i]);
+			}
+		}
+		_sin = pack_type::load(sins);
+		_cos = pack_type::load(coss);
+	}
+}
+
+/*!
+*	@brief acosの多項式の係数です。
+*	asin(x) = x + x^3 P(x^2)を[0, 0.5]で近似し、|x| > 0.5はasin(x) = π/2 - 2asin(sqrt((1 - x) / 2))で範囲を縮小します。
+*/
+template<class value_type, class dummy = void> struct acos_coefficients;
+
+template<class dummy> struct acos_coefficients<float, dummy>
+{
+	static constexpr float pi = 3.14159265358979323846f;
+	static constexpr float asin[5] = { 3.8085024e-2f, 2.6554542e-2f, 4.5001380e-2f, 7.4988551e-2f, 1.6666672e-1f };
+};
+
+template<class dummy> struct acos_coefficients<double, dummy>
+{
+	static constexpr double pi = 3.14159265358979323846;
+	static constexpr double asin[12] = { 2.8163713713486989e-2, -1.0740631259977818e-2, 1.6029880120186135e-2, 7.8051151516168223e-3, 1.1874966794645540e-2, 1.3929737679537387e-2, 1.7355250893341149e-2, 2.2372048266018000e-2, 3.0381947339250416e-2, 4.4642857104130242e-2, 7.5000000000198771e-2, 1.6666666666666653e-1 };
+};
+
+template<class dummy> constexpr float acos_coefficients<float, dummy>::asin[5];
+template<class dummy> constexpr double acos_coefficients<double, dummy>::asin[12];
+
+/*!
+*	@brief packの各要素のacosを求めます。最大誤差はfloatで1.3ulp、doubleで1.4ulpです([-1, 1]でlong doubleのacoslと比較)。
+*	[-1, 1]の外の要素は結果が不定です。
+*/
+template<class pack_type> inline pack_type acos(const pack_type& _x)
+{
+	typedef typename pack_type::value_type value_type;
+	typedef acos_coefficients<value_type> coefficients;
+
+	const pack_type half(static_cast<value_type>(0.5));
+	const pack_type a = abs(_x);
+	const auto large = a > half;
+	const pack_type z = select(large, (pack_type(static_cast<value_type>(1.0)) - a) * half, a * a);
+	const pack_type s = select(large, sqrt(z), a);
+	const pack_type asin = fmadd(s * z, polynomial(z, coefficients::asin), s);
+
+	// acos(|x|)は|x| > 0.5で2asin(s)、それ以外でπ/2 - asin(|x|)。負の要素はacos(x) = π - acos(|x|)
+	const pack_type pi(coefficients::pi);
+	const pack_type result = select(large, asin + asin, fmadd(pi, half, -asin));
+	return select(_x < pack_type(static_cast<value_type>(0.0)), pi - result, result);
+}
+
+/*!
+*	@brief _count個の角度のsinとcosをpack幅ずつ求めます。端数の要素もpackにまとめて1回で求めます。
+*/
+template<class value_type> inline void sincos(const value_type* _angles, value_type* _sin, value_type* _cos, size_t _count)
+{
+	typedef pack<value_type> pack_type;
+	const size_t width = pack_type::width;
+	pack_type sin, cos;
+	size_t i = 0;
+	for (; i + width <= _count; i += width)
+	{
+		sincos(pack_type::load(_angles + i), sin, cos);
+		sin.store(_sin + i);
+		cos.store(_cos + i);
+	}
+
+	if (i < _count)
+	{
+		value_type angles[width] = {}, sins[width], coss[width];
+		for (size_t j = 0; i + j < _count; j++)
+		{
+			angles[j] = _angles[i + j];
+		}
+		sincos(pack_type::load(angles), sin, cos);
+		sin.store(sins);
+		cos.store(coss);
+		for (size_t j = 0; i + j < _count; j++)
+		{
+			_sin[i + j] = sins[j];
+			_cos[i + j] = coss[j];
+		}
+	}
+}
+
+}
+
+/*!
+*	@brief _angleのsinとcosを同時に求めます。float/doubleはsimd::sincosの多項式で求めます。
+*/
+inline void sincos(float _angle, float& _sin, float& _cos)
+{
+	simd::scalar<float> sin, cos;
+	simd::sincos(simd::scalar<float>(_angle), sin, cos);
+	_sin = sin.value;
+	_cos = cos.value;
+}
+
+inline void sincos(double _angle, double& _sin, double& _cos)
+{
+	simd::scalar<double> sin, cos;
+	simd::sincos(simd::scalar<double>(_angle), sin, cos);
+	_sin = sin.value;
+	_cos = cos.value;
+}
+
+template<class type> inline void sincos(type _angle, type& _sin, type& _cos)
+{
+	_sin = static_cast<type>(std::sin(_angle));
+	_cos = static_cast<type>(std::cos(_angle));
+}
+
+/*!
+*	@brief _count個の角度のsinとcosをpack幅ずつまとめて求めます。
+*/
+inline void sincos(const float* _angles, float* _sin, float* _cos, size_t _count)
+{
+	simd::sincos(_angles, _sin, _cos, _count);
+}
+
+inline void sincos(const double* _angles, double* _sin, double* _cos, size_t _count)
+{
+	simd::sincos(_angles, _sin, _cos, _count);
+}
+
+template<class type> inline void sincos(const type* _angles, type* _sin, type* _cos, size_t _count)
+{
+	for (size_t i = 0; i < _count; i++)
+	{
+		sincos(_angles[i], _sin[i], _cos[i]);
+	}
+}
+
+/*!
+*	@brief ベクトルの各要素のsinとcosを1つのpackで同時に求めます。
+*/
+template<class type> inline void sincos(const vector2<type>& _angles, vector2<type>& _sin, vector2<type>& _cos)
+{
+	const type angles[2] = { _angles.x, _angles.y };
+	type sin[2], cos[2];
+	sincos(angles, sin, cos, 2);
+	_sin = vector2<type>(sin[0], sin[1]);
+	_cos = vector2<type>(cos[0], cos[1]);
+}
+
+template<class type> inline void sincos(const vector3<type>& _angles, vector3<type>& _sin, vector3<type>& _cos)
+{
+	const type angles[3] = { _angles.x, _angles.y, _angles.z };
+	type sin[3], cos[3];
+	sincos(angles, sin, cos, 3);
+	_sin = vector3<type>(sin[0], sin[1], sin[2]);
+	_cos = vector3<type>(cos[0], cos[1], cos[2]);
+}
+
+template<class type> inline void sincos(const vector4<type>& _angles, vector4<type>& _sin, vector4<type>& _cos)
+{
+	const type angles[4] = { _angles.x, _angles.y, _angles.z, _angles.w };
+	type sin[4], cos[4];
+	sincos(angles, sin, cos, 4);
+	_sin = vector4<type>(sin[0], sin[1], sin[2], sin[3]);
+	_cos = vector4<type>(cos[0], cos[1], cos[2], cos[3]);
+}
+
+}
@@ -16,13 +16,14 @@
 #include "scalar.h"
 #include "random.h"
 #include "functions.h"
+#include "simd.h"
 
 namespace arch
 {
 
 template <typename type> class vector2;
 template <typename type> class vector3;
-template <typename type> class vector4;
+template <typename type, typename enable = void> class vector4;
 
 typedef vector2<char>	char2;
 typedef vector2<uchar>	uchar2;
@@ -70,6 +71,7 @@ public:
 
 public:
 	vector2() = default;
+	vector2(const vector2&) = default;
 	~vector2() = default;
 
 	constexpr vector2(value_type _x, value_type _y)
@@ -388,12 +390,22 @@ public:
 
 	static vector2 random()
 	{
-		return vector2<value_type>(arch::random<value_type>(), arch::random<value_type>());
+		return random(get_default_random_engine());
 	}
 
 	static vector2 random(value_type _minimum, value_type _maximum)
 	{
-		return vector2<value_type>(arch::random<value_type>(_minimum, _maximum), arch::random<value_type>(_minimum, _maximum));
+		return random(get_default_random_engine(), _minimum, _maximum);
+	}
+
+	template<class engine_type> static vector2 random(engine_type& _engine)
+	{
+		return vector2<value_type>{ arch::random<value_type>(_engine), arch::random<value_type>(_engine) };
+	}
+
+	template<class engine_type> static vector2 random(engine_type& _engine, value_type _minimum, value_type _maximum)
+	{
+		return vector2<value_type>{ arch::random<value_type>(_engine, _minimum, _maximum), arch::random<value_type>(_engine, _minimum, _maximum) };
 	}
 
 	union
@@ -426,6 +438,7 @@ public:
 
 public:
 	vector3() = default;
+	vector3(const vector3&) = default;
 	~vector3() = default;
 
 	constexpr vector3(value_type _x, value_type _y, value_type _z)
@@ -757,12 +770,22 @@ public:
 
 	static vector3 random()
 	{
-		return vector3<value_type>(arch::random<value_type>(), arch::random<value_type>(), arch::random<value_type>());
+		return random(get_default_random_engine());
 	}
 
 	static vector3 random(value_type _minimum, value_type _maximum)
 	{
-		return vector3<value_type>(arch::random<value_type>(_minimum, _maximum), arch::random<value_type>(_minimum, _maximum), arch::random<value_type>(_minimum, _maximum));
+		return random(get_default_random_engine(), _minimum, _maximum);
+	}
+
+	template<class engine_type> static vector3 random(engine_type& _engine)
+	{
+		return vector3<value_type>{ arch::random<value_type>(_engine), arch::random<value_type>(_engine), arch::random<value_type>(_engine) };
+	}
+
+	template<class engine_type> static vector3 random(engine_type& _engine, value_type _minimum, value_type _maximum)
+	{
+		return vector3<value_type>{ arch::random<value_type>(_engine, _minimum, _maximum), arch::random<value_type>(_engine, _minimum, _maximum), arch::random<value_type>(_engine, _minimum, _maximum) };
 	}
 
 public:
@@ -785,7 +808,386 @@ public:
 };
 
 
+#if defined(ARCH_SIMD_SSE)
+
+/*!
+*	@brief SIMDレジスタで演算するvector4<float>/vector4<double>の部分特殊化です。
+*	メモリ配置は汎用のvector4と同じで、実行時は演算のたびにsimd::packed4のレジスタへ読み込みます。
+*	定数式では汎用のvector4と同じ式で求めるため、同じようにconstexprで使えます。
+*	定数式かどうかを判定できないコンパイラ(ARCH_CONSTANT_EVALUATEDが未定義)では常に汎用のvector4と同じ式になります。
+*	そのようなコンパイラでもARCH_CONSTANT_EVALUATED()をfalseと定義すればSIMDで求めますが、定数式では使えなくなります。
+*/
 template <typename type>
+class vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>
+{
+public:
+	typedef type value_type;
+	typedef size_t size_type;
+	typedef type* pointer;
+	typedef const type* const_pointer;
+	typedef type& reference;
+	typedef const type& const_reference;
+	typedef typename simd::packed4<type>::type packed_type;
+
+public:
+	vector4() = default;
+	~vector4() = default;
+
+	constexpr vector4(value_type _x, value_type _y, value_type _z, value_type _w)
+		: x(_x), y(_y), z(_z), w(_w)
+	{
+	}
+
+	constexpr vector4(const vector2<value_type>& _xy, value_type _z, value_type _w)
+		: x(_xy.x), y(_xy.y), z(_z), w(_w)
+	{
+	}
+
+	constexpr vector4(value_type _x, const vector2<value_type>& _yz, value_type _w)
+		: x(_x), y(_yz.x), z(_yz.y), w(_w)
+	{
+	}
+
+	constexpr vector4(value_type _x, value_type _y, const vector2<value_type>& _zw)
+		: x(_x), y(_y), z(_zw.x), w(_zw.y)
+	{
+	}
+
+	constexpr vector4(const vector2<value_type>& _xy, const vector2<value_type>& _zw)
+		: x(_xy.x), y(_xy.y), z(_zw.x), w(_zw.y)
+	{
+	}
+
+	constexpr vector4(const vector3<value_type>& _xyz, value_type _w)
+		: x(_xyz.x), y(_xyz.y), z(_xyz.z), w(_w)
+	{
+	}
+
+	constexpr vector4(value_type _x, const vector3<value_type>& _yzw)
+		: x(_x), y(_yzw.x), z(_yzw.y), w(_yzw.z)
+	{
+	}
+
+	constexpr vector4(const value_type(&_data)[4])
+		: x(_data[0]), y(_data[1]), z(_data[2]), w(_data[3])
+	{
+	}
+
+	explicit vector4(packed_type _packed)
+	{
+		simd::store4(data, _packed);
+	}
+
+	packed_type packed() const
+	{
+		return simd::load4(data);
+	}
+
+	constexpr vector4& absolute()
+	{
+		*this = absoluted();
+		return *this;
+	}
+
+	constexpr vector4 absoluted() const
+	{
+		return vectorized() ? vector4(simd::abs(packed())) : vector4(abs(x), abs(y), abs(z), abs(w));
+	}
+
+	constexpr vector4& saturate()
+	{
+		*this = saturated();
+		return *this;
+	}
+
+	constexpr vector4 saturated() const
+	{
+		return vectorized() ? vector4(simd::min(simd::max(packed(), simd::set4(static_cast<value_type>(0.0))), simd::set4(static_cast<value_type>(1.0))))
+			: vector4(clamp(x, static_cast<value_type>(0.0), static_cast<value_type>(1.0)), clamp(y, static_cast<value_type>(0.0), static_cast<value_type>(1.0)), clamp(z, static_cast<value_type>(0.0), static_cast<value_type>(1.0)), clamp(w, static_cast<value_type>(0.0), static_cast<value_type>(1.0)));
+	}
+
+	constexpr value_type squared_length() const
+	{
+		return vectorized() ? simd::sum(simd::mul(packed(), packed())) : x * x + y * y + z * z + w * w;
+	}
+
+	constexpr value_type length() const
+	{
+		return sqrt(squared_length());
+	}
+
+	constexpr vector4& normalize()
+	{
+		*this = normalized();
+		return *this;
+	}
+
+	///	<summary>floatの実行時は逆平方根の近似値を1回補正して掛けるため、除算による結果とは数ulp異なることがあります。</summary>
+	constexpr vector4 normalized() const
+	{
+		if (vectorized())
+		{
+			const value_type squared = squared_length();
+			return squared > static_cast<value_type>(0.0) ? vector4(normalized(packed(), squared)) : zero();
+		}
+		const value_type len = length();
+		if (len > static_cast<value_type>(0.0))
+		{
+			return vector4(x / len, y / len, z / len, w / len);
+		}
+		return zero();
+	}
+
+	constexpr value_type dot(const vector4& _vector) const
+	{
+		return vectorized() ? simd::sum(simd::mul(packed(), _vector.packed())) : x * _vector.x + y * _vector.y + z * _vector.z + w * _vector.w;
+	}
+
+	constexpr value_type squared_distance(const vector4& _end) const
+	{
+		return (_end - *this).squared_length();
+	}
+
+	constexpr value_type distance(const vector4& _end) const
+	{
+		return (_end - *this).length();
+	}
+
+	constexpr bool all() const
+	{
+		return *this == zero();
+	}
+
+	constexpr bool any() const
+	{
+		return *this != zero();
+	}
+
+public:
+	constexpr vector4 operator+(const vector4& _vector) const
+	{
+		return vectorized() ? vector4(simd::add(packed(), _vector.packed())) : vector4(x + _vector.x, y + _vector.y, z + _vector.z, w + _vector.w);
+	}
+
+	constexpr vector4& operator+=(const vector4& _vector)
+	{
+		*this = *this + _vector;
+		return *this;
+	}
+
+	constexpr vector4 operator-(const vector4& _vector) const
+	{
+		return vectorized() ? vector4(simd::sub(packed(), _vector.packed())) : vector4(x - _vector.x, y - _vector.y, z - _vector.z, w - _vector.w);
+	}
+
+	constexpr vector4& operator-=(const vector4& _vector)
+	{
+		*this = *this - _vector;
+		return *this;
+	}
+
+	constexpr vector4 operator*(const vector4& _vector) const
+	{
+		return vectorized() ? vector4(simd::mul(packed(), _vector.packed())) : vector4(x * _vector.x, y * _vector.y, z * _vector.z, w * _vector.w);
+	}
+
+	constexpr vector4 operator*(value_type _value) const
+	{
+		return vectorized() ? vector4(simd::mul(packed(), simd::set4(_value))) : vector4(x * _value, y * _value, z * _value, w * _value);
+	}
+
+	constexpr vector4& operator*=(const vector4& _vector)
+	{
+		*this = *this * _vector;
+		return *this;
+	}
+
+	constexpr vector4& operator*=(value_type _value)
+	{
+		*this = *this * _value;
+		return *this;
+	}
+
+	constexpr vector4 operator/(const vector4& _vector) const
+	{
+		return vectorized() ? vector4(simd::div(packed(), _vector.packed())) : vector4(x / _vector.x, y / _vector.y, z / _vector.z, w / _vector.w);
+	}
+
+	constexpr vector4 operator/(value_type _value) const
+	{
+		return vectorized() ? vector4(simd::div(packed(), simd::set4(_value))) : vector4(x / _value, y / _value, z / _value, w / _value);
+	}
+
+	constexpr vector4& operator/=(const vector4& _vector)
+	{
+		*this = *this / _vector;
+		return *this;
+	}
+
+	constexpr vector4& operator/=(value_type _value)
+	{
+		*this = *this / _value;
+		return *this;
+	}
+
+	constexpr bool operator==(const vector4& _vector) const
+	{
+		return vectorized() ? simd::equal(packed(), _vector.packed()) : (x == _vector.x && y == _vector.y && z == _vector.z && w == _vector.w);
+	}
+
+	constexpr bool operator!=(const vector4& _vector) const
+	{
+		return !(*this == _vector);
+	}
+
+	constexpr bool operator>(const vector4& _vector) const
+	{
+		return squared_length() > _vector.squared_length();
+	}
+
+	constexpr bool operator>=(const vector4& _vector) const
+	{
+		return squared_length() >= _vector.squared_length();
+	}
+
+	constexpr bool operator<(const vector4& _vector) const
+	{
+		return squared_length() < _vector.squared_length();
+	}
+
+	constexpr bool operator<=(const vector4& _vector) const
+	{
+		return squared_length() <= _vector.squared_length();
+	}
+
+	constexpr vector4 operator+() const
+	{
+		return *this;
+	}
+
+	constexpr vector4 operator-() const
+	{
+		return vectorized() ? vector4(simd::negate(packed())) : vector4(-x, -y, -z, -w);
+	}
+
+	constexpr const value_type& operator[](uint index) const
+	{
+		return data[index];
+	}
+
+	constexpr value_type& operator[](uint index)
+	{
+		return data[index];
+	}
+
+	operator char4() const;
+	operator uchar4() const;
+	operator short4() const;
+	operator ushort4() const;
+	operator int4() const;
+	operator uint4() const;
+	operator long4() const;
+	operator ulong4() const;
+	operator float4() const;
+	operator double4() const;
+
+public:
+	static constexpr vector4 zero()
+	{
+		return vector4(static_cast<value_type>(0.0), static_cast<value_type>(0.0), static_cast<value_type>(0.0), static_cast<value_type>(0.0));
+	}
+
+	static constexpr vector4 one()
+	{
+		return vector4(static_cast<value_type>(1.0), static_cast<value_type>(1.0), static_cast<value_type>(1.0), static_cast<value_type>(1.0));
+	}
+
+	static constexpr vector4 unit_x()
+	{
+		return vector4(static_cast<value_type>(1.0), static_cast<value_type>(0.0), static_cast<value_type>(0.0), static_cast<value_type>(0.0));
+	}
+
+	static constexpr vector4 unit_y()
+	{
+		return vector4(static_cast<value_type>(0.0), static_cast<value_type>(1.0), static_cast<value_type>(0.0), static_cast<value_type>(0.0));
+	}
+
+	static constexpr vector4 unit_z()
+	{
+		return vector4(static_cast<value_type>(0.0), static_cast<value_type>(0.0), static_cast<value_type>(1.0), static_cast<value_type>(0.0));
+	}
+
+	static constexpr vector4 unit_w()
+	{
+		return vector4(static_cast<value_type>(0.0), static_cast<value_type>(0.0), static_cast<value_type>(0.0), static_cast<value_type>(1.0));
+	}
+
+	static vector4 random()
+	{
+		return random(get_default_random_engine());
+	}
+
+	static vector4 random(value_type _minimum, value_type _maximum)
+	{
+		return random(get_default_random_engine(), _minimum, _maximum);
+	}
+
+	template<class engine_type> static vector4 random(engine_type& _engine)
+	{
+		return vector4{ arch::random<value_type>(_engine), arch::random<value_type>(_engine), arch::random<value_type>(_engine), arch::random<value_type>(_engine) };
+	}
+
+	template<class engine_type> static vector4 random(engine_type& _engine, value_type _minimum, value_type _maximum)
+	{
+		return vector4{ arch::random<value_type>(_engine, _minimum, _maximum), arch::random<value_type>(_engine, _minimum, _maximum), arch::random<value_type>(_engine, _minimum, _maximum), arch::random<value_type>(_engine, _minimum, _maximum) };
+	}
+
+private:
+	///	<summary>実行時はSIMDレジスタで、定数式では汎用のvector4と同じ式で求めます。</summary>
+	static constexpr bool vectorized()
+	{
+#if defined(ARCH_CONSTANT_EVALUATED)
+		return !ARCH_CONSTANT_EVALUATED();
+#else
+		return false;
+#endif
+	}
+
+	static simd::float4_type normalized(simd::float4_type _vector, float _squared_length)
+	{
+		return simd::mul(_vector, simd::rsqrt(simd::set4(_squared_length)));
+	}
+
+	static simd::double4_type normalized(simd::double4_type _vector, double _squared_length)
+	{
+		return simd::div(_vector, simd::set4(simd::sqrt(_squared_length)));
+	}
+
+public:
+	union
+	{
+		struct
+		{
+			value_type x;
+			value_type y;
+			value_type z;
+			value_type w;
+		};
+		struct
+		{
+			value_type r;
+			value_type g;
+			value_type b;
+			value_type a;
+		};
+		value_type data[4];
+	};
+};
+
+#endif
+
+
+template <typename type, typename enable>
 class vector4
 {
 public:
@@ -798,6 +1200,7 @@ public:
 
 public:
 	vector4() = default;
+	vector4(const vector4&) = default;
 	~vector4() = default;
 
 	constexpr vector4(value_type _x, value_type _y, value_type _z, value_type _w)
@@ -1159,12 +1562,22 @@ public:
 
 	static vector4 random()
 	{
-		return vector4<value_type>(arch::random<value_type>(), arch::random<value_type>(), arch::random<value_type>(), arch::random<value_type>());
+		return random(get_default_random_engine());
 	}
 
 	static vector4 random(value_type _minimum, value_type _maximum)
 	{
-		return vector4<value_type>(arch::random<value_type>(_minimum, _maximum), arch::random<value_type>(_minimum, _maximum), arch::random<value_type>(_minimum, _maximum), arch::random<value_type>(_minimum, _maximum));
+		return random(get_default_random_engine(), _minimum, _maximum);
+	}
+
+	template<class engine_type> static vector4 random(engine_type& _engine)
+	{
+		return vector4<value_type>{ arch::random<value_type>(_engine), arch::random<value_type>(_engine), arch::random<value_type>(_engine), arch::random<value_type>(_engine) };
+	}
+
+	template<class engine_type> static vector4 random(engine_type& _engine, value_type _minimum, value_type _maximum)
+	{
+		return vector4<value_type>{ arch::random<value_type>(_engine, _minimum, _maximum), arch::random<value_type>(_engine, _minimum, _maximum), arch::random<value_type>(_engine, _minimum, _maximum), arch::random<value_type>(_engine, _minimum, _maximum) };
 	}
 
 public:
@@ -1188,6 +1601,60 @@ public:
 	};
 };
 
+#if defined(ARCH_SIMD_SSE)
+
+template <typename type> inline vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>::operator char4() const
+{
+	return char4(static_cast<char>(x), static_cast<char>(y), static_cast<char>(z), static_cast<char>(w));
+}
+
+template <typename type> inline vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>::operator uchar4() const
+{
+	return uchar4(static_cast<uchar>(x), static_cast<uchar>(y), static_cast<uchar>(z), static_cast<uchar>(w));
+}
+
+template <typename type> inline vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>::operator short4() const
+{
+	return short4(static_cast<short>(x), static_cast<short>(y), static_cast<short>(z), static_cast<short>(w));
+}
+
+template <typename type> inline vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>::operator ushort4() const
+{
+	return ushort4(static_cast<ushort>(x), static_cast<ushort>(y), static_cast<ushort>(z), static_cast<ushort>(w));
+}
+
+template <typename type> inline vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>::operator int4() const
+{
+	return int4(static_cast<int>(x), static_cast<int>(y), static_cast<int>(z), static_cast<int>(w));
+}
+
+template <typename type> inline vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>::operator uint4() const
+{
+	return uint4(static_cast<uint>(x), static_cast<uint>(y), static_cast<uint>(z), static_cast<uint>(w));
+}
+
+template <typename type> inline vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>::operator long4() const
+{
+	return long4(static_cast<long>(x), static_cast<long>(y), static_cast<long>(z), static_cast<long>(w));
+}
+
+template <typename type> inline vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>::operator ulong4() const
+{
+	return ulong4(static_cast<ulong>(x), static_cast<ulong>(y), static_cast<ulong>(z), static_cast<ulong>(w));
+}
+
+template <typename type> inline vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>::operator float4() const
+{
+	return float4(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z), static_cast<float>(w));
+}
+
+template <typename type> inline vector4<type, typename std::enable_if<simd::packed4<type>::value>::type>::operator double4() const
+{
+	return double4(static_cast<double>(x), static_cast<double>(y), static_cast<double>(z), static_cast<double>(w));
+}
+
+#endif
+
 template<typename value_type> inline constexpr vector2<value_type> operator *(const value_type& _value, const vector2<value_type>& _vector)
 {
 	return _vector * _value;